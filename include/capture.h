@@ -0,0 +1,61 @@
+#ifndef CAPTURE_H
+#define CAPTURE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+#define CAPTURE_BUF_SIZE (4u << 20)  // Bytes per staging buffer
+#define CAPTURE_NUM_BUFS 16          // Staging buffers (64 MB in total)
+#define CAPTURE_ALIGN 4096           // O_DIRECT alignment
+
+// pcap/pcapng writer: the receive thread copies records into large
+// preallocated buffers, a writer thread flushes full buffers to disk.
+// A capture has exactly one producer.
+typedef struct {
+    int fd;
+    bool direct;                     // O_DIRECT in effect
+    bool pcapng;
+    uint32_t snaplen;
+
+    uint8_t *mem;                    // CAPTURE_NUM_BUFS * CAPTURE_BUF_SIZE, aligned
+    uint32_t full_len[CAPTURE_NUM_BUFS];
+
+    // Buffer queues (indices), protected by lock; touched once per buffer
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    uint32_t free_q[CAPTURE_NUM_BUFS];
+    uint32_t free_head;
+    atomic_uint free_count;
+    uint32_t full_q[CAPTURE_NUM_BUFS];
+    uint32_t full_head;
+    uint32_t full_count;
+    bool stopping;
+    pthread_t writer;
+    atomic_bool failed;              // Set by the writer on the first write error
+    bool closed;                     // Writer stopped and joined, file closed
+
+    // Producer state
+    int cur;                         // Buffer being filled (-1 if none)
+    uint32_t used;
+
+    // Counters
+    uint64_t packets;                // Records written into buffers
+    uint64_t bytes;                  // Packet bytes captured (after snaplen)
+    uint64_t drops;                  // Packets dropped because no buffer was free
+    uint64_t file_bytes;             // Bytes flushed by the writer
+    uint64_t write_errors;
+    uint64_t skipped;                // Packets not captured after a write error
+    uint64_t start_ns;
+    uint64_t end_ns;
+} capture_t;
+
+// Function declarations
+capture_t* capture_open(const char *path, bool pcapng, uint32_t snaplen);
+void capture_packet(capture_t *cap, const uint8_t *data, uint32_t len);
+void capture_report(const capture_t *cap);
+void capture_close(capture_t *cap);
+void capture_destroy(capture_t *cap);
+
+#endif // CAPTURE_H
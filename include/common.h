@@ -6,17 +6,54 @@
 #include <time.h>
 #include <pthread.h>
 
+#define MAX_CPUS 64                  // CPUs accepted by --cpus
+#define MAX_SOURCES 8                // --source entries
+#define RX_MAX_BATCH 512             // Largest --batch
+#define RX_MAX_RING 32768            // Largest --ring-size (DPDK takes a uint16_t)
+#define RX_MAX_FRAMES (1u << 20)     // Largest --frames (4 GB of UMEM)
+#define RX_MAX_MBUFS (1u << 24)      // Largest --mbufs
+#define HH_MAX_TOPK 100000           // Largest --top-talkers
+#define HH_MAX_MEMORY_KB (1u << 20)  // Largest --hh-memory (1 GB)
+#define REASM_MAX_FLOWS (1u << 24)   // Largest --reasm-flows
+#define REASM_MAX_FLOW_KB (1u << 20) // Largest --reasm-flow-mem (1 GB)
+#define REASM_MAX_MEM_MB (1u << 16)  // Largest --reasm-mem (64 GB)
+#define RX_MAX_MBUF_CACHE 512        // RTE_MEMPOOL_CACHE_MAX_SIZE
+#define WORKER_MAX_RING (1u << 20)   // Largest --worker-ring
+#define TAP_MAX_SLOTS (1u << 20)     // Largest --tap-slots (2 GB of payload)
+
 // Packet reception mode
 typedef enum {
     MODE_SOCKET = 0,
     MODE_AF_XDP,
-    MODE_DPDK
+    MODE_DPDK,
+    MODE_PCAP
 } packet_mode_t;
 
+// Heavy hitter key
+typedef enum {
+    HH_KEY_SRC = 0,                  // Source address
+    HH_KEY_DST,                      // Destination address
+    HH_KEY_FLOW                      // Full 5-tuple
+} hh_key_mode_t;
+
+// Software RSS hash used to spread packets over pipeline workers
+typedef enum {
+    RSS_HASH_TOEPLITZ = 0,           // Symmetric Toeplitz (same result as NIC RSS with the symmetric key)
+    RSS_HASH_CRC32                   // CRC32C over the ordered tuple (SSE4.2 when available)
+} rss_hash_t;
+
+// One receive source (--source mode:device)
+typedef struct {
+    packet_mode_t mode;
+    char device[256];                // Interface, PCI address or pcap file
+} source_t;
+
 // Statistics structure
 typedef struct {
     uint64_t packets_received;      // Total packets received
     uint64_t bytes_received;         // Total bytes received
+    uint64_t packets_forwarded;      // Packets sent back out (forwarding mode)
+    uint64_t forward_dropped;        // Packets dropped because the TX side was full
     uint64_t start_time_ns;           // Start time (nanoseconds)
     uint64_t end_time_ns;             // End time (nanoseconds)
     
@@ -24,6 +61,8 @@ typedef struct {
     double pps;                      // Packets per second
     double bps;                      // Bits per second
     double avg_latency_ns;           // Average latency (nanoseconds)
+    const char *rx_loop;             // Receive loop variant that ran (NULL if not reported)
+    uint64_t cpu_time_ns;            // Process CPU time while receiving (all threads)
     
     pthread_mutex_t mutex;           // Mutex lock
 } stats_t;
@@ -39,15 +78,69 @@ typedef struct {
     uint32_t timeout_ms;             // Timeout (milliseconds)
     bool verbose;                    // Verbose output
     uint32_t duration_sec;           // Runtime duration (seconds, 0 means infinite)
+    char pcap_file[256];             // Capture file replayed in pcap mode
+    double replay_speed;             // Replay speed multiplier (0 = as fast as possible)
+    uint32_t replay_loops;           // Times to replay the file (0 = until stopped)
+
+    // Processing stages
+    uint32_t hh_topk;                // Heavy hitters to report (0 disables the sketch)
+    uint32_t hh_memory_kb;           // Count-Min sketch memory budget (KB)
+    hh_key_mode_t hh_key;            // Heavy hitter key
+    char dpi_patterns[256];          // Payload pattern file (empty disables matching)
+    bool reasm_enabled;              // TCP stream reassembly
+    uint32_t reasm_max_flows;        // Reassembly flow table size
+    uint32_t reasm_flow_kb;          // Max out-of-order bytes buffered per flow (KB)
+    uint32_t reasm_mem_mb;           // Segment pool size (MB)
+    uint32_t reasm_timeout_sec;      // Idle flow timeout (seconds)
+    char write_file[256];            // Capture output file (empty disables capture)
+    bool write_pcapng;               // pcapng instead of pcap
+    uint32_t snaplen;                // Bytes captured per packet
+    char tap_path[108];              // Shared-memory tap socket (empty disables the tap)
+    uint32_t tap_slots;              // Tap ring size in packets
+    bool probe_enabled;              // Track packet_sender sequence numbers and timestamps
+    bool forward;                    // Swap MACs and transmit every received packet
+    char out_interface[16];          // Forward out of this interface (default: the RX interface)
+    char out_address[16];            // Forward out of this PCI device (DPDK)
+    char json_file[256];             // Write the run summary as JSON (empty disables)
+    uint32_t workers;                // Pipeline worker threads (0 = process on the receive thread)
+    uint32_t worker_ring;            // Descriptors per worker ring
+    rss_hash_t rss_hash;             // Worker dispatch hash
+    uint16_t cpus[MAX_CPUS];         // --cpus: receive thread first, then workers
+    uint32_t num_cpus;               // 0 leaves placement to the scheduler
+    int numa_node;                   // NUMA node of the receive device (-1 if unknown)
+    bool hugepages;                  // Back large buffers with hugepages when available
+    bool generic_loop;               // Unspecialized receive loop (baseline for benchmarks)
+
+    // Receive tuning (0 = backend default; init stores the values in effect)
+    uint32_t batch_size;             // Packets per receive burst
+    uint32_t num_frames;             // AF_XDP UMEM frames
+    uint32_t ring_size;              // AF_XDP RX/Fill ring or DPDK RX descriptors
+    uint32_t num_mbufs;              // DPDK mempool size
+    uint32_t mbuf_cache;             // DPDK per-lcore mempool cache
+
+    // Several sources in one process (0 = the single --mode/--interface source)
+    source_t sources[MAX_SOURCES];
+    uint32_t num_sources;
 } config_t;
 
+struct probe;
+
 // Function declarations
 void stats_init(stats_t *stats);
 void stats_update(stats_t *stats, uint32_t packet_size);
+void stats_update_batch(stats_t *stats, uint32_t packets, uint64_t bytes);
+void stats_update_forward(stats_t *stats, uint32_t sent, uint32_t dropped);
+void stats_accumulate(stats_t *total, const stats_t *stats);
 void stats_summarize(stats_t *stats);
 void stats_cleanup(stats_t *stats);
+int stats_write_json(const char *path, const stats_t *stats, const config_t *config,
+                     const struct probe *probe, const stats_t *const *source_stats,
+                     const config_t *const *source_configs, uint32_t num_sources);
+const char* mode_name(packet_mode_t mode);
+const char* device_name(const config_t *config);
 
 uint64_t get_time_ns(void);
+uint64_t get_cpu_time_ns(void);
 void print_banner(void);
 int parse_args(int argc, char *argv[], config_t *config);
 
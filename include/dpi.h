@@ -0,0 +1,48 @@
+#ifndef DPI_H
+#define DPI_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "flow.h"
+
+// Compiled Aho-Corasick automaton (read-only once built, shareable between threads)
+typedef struct {
+    uint32_t num_patterns;
+    char **names;                    // Pattern text as written in the pattern file
+    uint32_t num_states;
+    uint32_t num_classes;            // Byte equivalence classes (class 0 = bytes in no pattern)
+    uint16_t byte_class[256];
+    uint32_t *delta;                 // Full DFA: entries are next_state * num_classes, DPI_MATCH_FLAG if it has output
+    int32_t *out_pattern;            // Pattern ending at each state (-1 if none)
+    uint32_t *out_link;              // Next state with output on the failure chain (UINT32_MAX if none)
+
+    // Prefilter over bytes that leave the root state
+    bool start_byte[256];
+    uint8_t shufti_lo[16];
+    uint8_t shufti_hi[16];
+    bool use_simd;
+} dpi_automaton_t;
+
+// Per-thread match counters
+typedef struct {
+    const dpi_automaton_t *ac;
+    uint64_t *hits;                  // Matches per pattern
+    uint64_t *packets;               // Packets containing each pattern
+    uint64_t *last_seen;             // Last packet sequence that matched each pattern
+    uint64_t packets_scanned;
+    uint64_t packets_matched;
+    uint64_t bytes_scanned;
+} dpi_t;
+
+// Function declarations
+dpi_automaton_t* dpi_automaton_load(const char *path);
+void dpi_automaton_destroy(dpi_automaton_t *ac);
+
+dpi_t* dpi_create(const dpi_automaton_t *ac);
+void dpi_scan(dpi_t *dpi, const uint8_t *data, uint32_t len);
+void dpi_scan_stream(dpi_t *dpi, uint32_t *state, const uint8_t *data, uint32_t len);
+int dpi_merge(dpi_t *dst, const dpi_t *src);
+void dpi_report(const dpi_t *dpi);
+void dpi_destroy(dpi_t *dpi);
+
+#endif // DPI_H
@@ -0,0 +1,57 @@
+#ifndef FLOW_H
+#define FLOW_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+// Flow key (IPv4 addresses are stored in the first 4 bytes of the address fields)
+typedef struct {
+    uint8_t src_addr[16];
+    uint8_t dst_addr[16];
+    uint16_t src_port;
+    uint16_t dst_port;
+    uint8_t proto;
+    uint8_t ip_version;              // 4 or 6
+    uint8_t pad[2];
+} flow_key_t;
+
+// Parsed packet headers
+typedef struct {
+    flow_key_t key;
+    uint16_t l3_offset;              // Offset of the IP header
+    uint16_t l4_offset;              // Offset of the TCP/UDP header
+    uint16_t payload_offset;         // Offset of the L4 payload
+    uint32_t payload_len;            // L4 payload length (clamped to captured data)
+    uint32_t tcp_seq;                // TCP sequence number (host order)
+    uint8_t tcp_flags;               // TCP flags
+    bool fragment;                   // Part of a fragmented IP datagram (any fragment)
+} pkt_info_t;
+
+// Skip the Ethernet header and up to two VLAN tags (802.1Q, 802.1ad QinQ).
+// Returns the L3 offset and sets *ethertype, or 0 if the headers are truncated.
+static inline uint32_t flow_l2_parse(const uint8_t *data, uint32_t len, uint16_t *ethertype) {
+    if (len < 14) return 0;
+    uint32_t off = 14;
+    uint16_t type = (uint16_t)((data[12] << 8) | data[13]);
+    for (int tags = 0; tags < 2 && (type == 0x8100 || type == 0x88A8); tags++) {
+        if (len < off + 4) return 0;
+        type = (uint16_t)((data[off + 2] << 8) | data[off + 3]);
+        off += 4;
+    }
+    *ethertype = type;
+    return off;
+}
+
+#define FLOW_TCP_FIN 0x01
+#define FLOW_TCP_SYN 0x02
+#define FLOW_TCP_RST 0x04
+
+// Function declarations
+int flow_parse(const uint8_t *data, uint32_t len, pkt_info_t *info);
+uint64_t flow_hash(const flow_key_t *key, uint64_t seed);
+bool flow_key_equal(const flow_key_t *a, const flow_key_t *b);
+void flow_addr_format(uint8_t ip_version, const uint8_t *addr, char *buf, size_t size);
+void flow_key_format(const flow_key_t *key, char *buf, size_t size);
+
+#endif // FLOW_H
@@ -0,0 +1,15 @@
+#ifndef FORWARD_H
+#define FORWARD_H
+
+#include <stdint.h>
+#include <string.h>
+
+// Reflect a frame back to its sender by exchanging the Ethernet addresses in place
+static inline void forward_swap_mac(uint8_t *frame) {
+    uint8_t tmp[6];
+    memcpy(tmp, frame, 6);
+    memcpy(frame, frame + 6, 6);
+    memcpy(frame + 6, tmp, 6);
+}
+
+#endif // FORWARD_H
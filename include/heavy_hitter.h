@@ -0,0 +1,41 @@
+#ifndef HEAVY_HITTER_H
+#define HEAVY_HITTER_H
+
+#include <stdint.h>
+#include "common.h"
+#include "flow.h"
+
+// Top-K candidate tracked alongside the Count-Min sketch
+typedef struct {
+    flow_key_t key;
+    uint64_t hash;
+    uint64_t estimate;               // Sketch estimate at last update (packets)
+    uint64_t bytes;                  // Bytes seen while the key was in the top-K
+} hh_entry_t;
+
+// Count-Min sketch with a min-heap of the K heaviest keys
+typedef struct {
+    hh_key_mode_t key_mode;
+    uint32_t depth;                  // Number of hash rows
+    uint32_t width;                  // Counters per row (power of two)
+    uint64_t *counters;              // depth * width counters
+
+    uint32_t k;                      // Heap capacity
+    uint32_t heap_size;
+    hh_entry_t *heap;                // Min-heap ordered by estimate
+    uint32_t index_mask;
+    uint32_t *index;                 // Open-addressing hash -> heap position + 1
+
+    uint64_t total_packets;          // Packets added to the sketch
+    uint64_t skipped_packets;        // Non-IP / unparsable packets
+} hh_sketch_t;
+
+// Function declarations
+hh_sketch_t* hh_sketch_create(hh_key_mode_t key_mode, uint32_t k, uint32_t memory_kb);
+void hh_sketch_update(hh_sketch_t *hh, const pkt_info_t *info, uint32_t packet_size);
+void hh_sketch_skip(hh_sketch_t *hh);
+int hh_sketch_merge(hh_sketch_t *dst, const hh_sketch_t *src);
+void hh_sketch_report(const hh_sketch_t *hh);
+void hh_sketch_destroy(hh_sketch_t *hh);
+
+#endif // HEAVY_HITTER_H
@@ -0,0 +1,40 @@
+#ifndef HUGEMEM_H
+#define HUGEMEM_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#define HUGEMEM_1G_MIN (512UL << 20) // Smallest request worth a 1 GB page
+#define HUGEMEM_2M_MIN (1UL << 20)   // Smallest request worth a 2 MB page
+
+// Page size backing a region, best first
+typedef enum {
+    HUGEMEM_PAGE_1G,
+    HUGEMEM_PAGE_2M,
+    HUGEMEM_PAGE_THP,                // Regular mapping with MADV_HUGEPAGE
+    HUGEMEM_PAGE_4K
+} hugemem_page_t;
+
+// Large, long-lived buffers (UMEM, receive slots, segment pools, flow tables,
+// capture staging) are mapped as whole regions: explicit 1 GB or 2 MB hugepages
+// when the kernel has them reserved, else transparent hugepages, else regular
+// pages. Regions are zeroed, page aligned and never grow, so nothing on the
+// packet path calls malloc.
+typedef struct hugemem_region {
+    struct hugemem_region *next;
+    void *addr;
+    size_t len;                      // Usable length (rounded to the page size)
+    size_t map_len;                  // Including the guard page of regular mappings
+    size_t requested;
+    hugemem_page_t page;
+    const char *name;
+} hugemem_region_t;
+
+// Function declarations
+void hugemem_configure(bool enabled);
+void* hugemem_alloc(size_t len, int node, const char *name);
+void hugemem_free(void *addr);
+void hugemem_report(void);
+
+#endif // HUGEMEM_H
@@ -2,6 +2,8 @@
 #define PACKET_RECEIVER_H
 
 #include "common.h"
+#include "stages.h"
+#include "pipeline.h"
 
 // Packet receiver interface
 typedef struct packet_receiver packet_receiver_t;
@@ -21,6 +23,8 @@ struct packet_receiver {
     stats_t stats;
     receiver_ops_t ops;
     void *private_data;  // Mode-specific private data
+    stages_t *stages;    // Processing stages (NULL if none enabled)
+    pipeline_t *pipeline; // Worker threads (NULL processes on the receive thread)
     bool running;
 };
 
@@ -0,0 +1,65 @@
+#ifndef PACKET_SENDER_H
+#define PACKET_SENDER_H
+
+#include "common.h"
+#include "traffic.h"
+
+// Sender configuration
+typedef struct {
+    packet_mode_t mode;              // Transmit mode (socket, af_xdp or dpdk)
+    char interface[16];              // Network interface name
+    char address[16];                // PCI address (DPDK)
+    uint32_t queue;                  // TX queue (AF_XDP)
+    bool src_mac_set;                // --src-mac given; otherwise use the interface address
+    traffic_config_t traffic;        // Frames to generate
+    uint64_t rate_pps;               // Target rate (0 = as fast as possible)
+    uint64_t count;                  // Packets to send (0 = until stopped)
+    uint32_t batch;                  // Packets per TX burst
+    uint32_t duration_sec;           // Runtime duration (seconds, 0 means infinite)
+    bool verbose;                    // Verbose output
+    char json_file[256];             // Write the run summary as JSON (empty disables)
+} sender_config_t;
+
+// Transmit statistics (written by the TX thread only)
+typedef struct {
+    uint64_t packets_sent;
+    uint64_t bytes_sent;             // Frame bytes without FCS
+    uint64_t tx_retries;             // Bursts the backend did not fully accept
+    uint64_t start_time_ns;
+    uint64_t end_time_ns;
+} sender_stats_t;
+
+typedef struct packet_sender packet_sender_t;
+
+// Sender operation function pointers
+typedef struct {
+    int (*init)(packet_sender_t *sender, const sender_config_t *config);
+    int (*start)(packet_sender_t *sender);
+    int (*stop)(packet_sender_t *sender);
+    void (*cleanup)(packet_sender_t *sender);
+} sender_ops_t;
+
+// Sender structure
+struct packet_sender {
+    packet_mode_t mode;
+    sender_config_t config;
+    sender_stats_t stats;
+    sender_ops_t ops;
+    traffic_gen_t gen;               // Frame generator shared by all backends
+    pacer_t pacer;                   // Token bucket for the target rate
+    void *private_data;              // Mode-specific private data
+    bool running;
+};
+
+// Packets the next burst may carry: bounded by the batch size, the remaining
+// count and the pacer (blocks until at least one packet is due)
+static inline uint32_t sender_next_burst(packet_sender_t *sender) {
+    uint32_t want = sender->config.batch;
+    if (sender->config.count) {
+        uint64_t left = sender->config.count - sender->stats.packets_sent;
+        if (left < want) want = (uint32_t)left;
+    }
+    return want ? pacer_acquire(&sender->pacer, want) : 0;
+}
+
+#endif // PACKET_SENDER_H
@@ -0,0 +1,80 @@
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include "common.h"
+#include "spsc_ring.h"
+#include "rss.h"
+
+struct stages;
+
+#define PIPE_BURST 32                // Descriptors moved per ring operation
+#define PIPE_STAGE RSS_MAX_BURST     // Packets hashed together before distribution
+#define PIPE_DEFAULT_RING 1024       // Descriptors per worker ring
+#define PIPE_MAX_WORKERS 64
+
+// Returns buffers to the backend (fill ring, mempool, slot pool); runs on the RX thread
+typedef void (*pipe_release_fn)(void *ctx, const pipe_desc_t *descs, uint32_t n);
+
+// One worker thread with its own stages instance
+typedef struct {
+    struct pipeline *pipe;
+    uint32_t id;
+    pthread_t thread;
+    bool started;
+    spsc_ring_t *ring;               // RX thread -> worker
+    spsc_ring_t *ret;                // worker -> RX thread (buffers to recycle)
+    struct stages *stages;           // NULL if no stages are enabled
+
+    // Written by the RX thread only
+    pipe_desc_t pending[PIPE_BURST]; // Batch being built for this worker
+    uint32_t npending;
+    uint64_t dispatched;
+    uint64_t ring_full;              // Enqueue attempts that found the ring full
+
+    // Written by the worker only
+    _Alignas(SPSC_CACHE_LINE) uint64_t packets;
+    uint64_t bytes;
+    uint64_t batches;
+    uint64_t busy_ns;                // Time spent processing batches
+    uint64_t ret_full;               // Return ring full (RX thread not recycling fast enough)
+} pipe_worker_t;
+
+typedef struct pipeline {
+    uint32_t num_workers;
+    uint32_t ring_size;
+    pipe_worker_t *workers;
+    struct stages *rx_stages;        // Stages that stay on the RX thread (capture)
+    _Atomic bool stop;
+
+    // Software RSS: packets are staged, hashed as a burst and spread by the RETA
+    rss_t rss;
+    pipe_desc_t staged[PIPE_STAGE];
+    uint32_t nstaged;
+
+    // Backend hooks, set by pipeline_attach from the receive loop
+    pipe_release_fn release;
+    void *release_ctx;
+    volatile bool *running;
+
+    // RX thread counters
+    uint64_t reclaimed;
+    uint64_t stall_ns;               // Time the RX thread waited on full worker rings
+} pipeline_t;
+
+// Function declarations
+pipeline_t* pipeline_create(const config_t *config, struct stages *stages);
+void pipeline_attach(pipeline_t *pipe, pipe_release_fn release, void *ctx, volatile bool *running);
+void pipeline_dispatch(pipeline_t *pipe, const uint8_t *data, uint32_t len, uint32_t wire_len,
+                       uint64_t cookie);
+void pipeline_flush(pipeline_t *pipe);
+uint32_t pipeline_reclaim(pipeline_t *pipe);
+uint64_t pipeline_outstanding(const pipeline_t *pipe);
+void pipeline_stop(pipeline_t *pipe);
+int pipeline_merge(pipeline_t *pipe, struct stages *dst);
+void pipeline_report(const pipeline_t *pipe, const stats_t *stats);
+void pipeline_destroy(pipeline_t *pipe);
+
+#endif // PIPELINE_H
@@ -0,0 +1,21 @@
+#ifndef PLACEMENT_H
+#define PLACEMENT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <pthread.h>
+#include "common.h"
+
+// CPU pinning and NUMA placement. Nodes come from sysfs and memory policy is set
+// with the mbind system call, so there is no libnuma dependency.
+
+// Function declarations
+int placement_parse_cpus(const char *spec, uint16_t *cpus, uint32_t max);
+int placement_device_node(const config_t *config);
+int placement_cpu_node(int cpu);
+int placement_node_first_cpu(int node);
+int placement_worker_cpu(const config_t *config, uint32_t worker);
+int placement_pin_thread(pthread_t thread, int cpu, const char *name, int device_node);
+int placement_bind_memory(void *addr, size_t len, int node);
+
+#endif // PLACEMENT_H
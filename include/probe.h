@@ -0,0 +1,65 @@
+#ifndef PROBE_H
+#define PROBE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "flow.h"
+
+#define PROBE_MAGIC 0x5051           // "PQ"
+#define PROBE_MAX_FLOWS 65536
+#define PROBE_LAT_SUB_BITS 4         // Latency histogram: 16 sub-buckets per power of two
+#define PROBE_LAT_BUCKETS (64 << PROBE_LAT_SUB_BITS)
+
+// Test header carried at the start of the UDP payload, all fields big-endian.
+// 16 bytes so that it fits a minimum 64-byte frame.
+typedef struct __attribute__((packed)) {
+    uint16_t magic;
+    uint16_t flow;                   // Flow index
+    uint32_t seq;                    // Per-flow sequence number
+    uint64_t tx_ns;                  // Sender CLOCK_MONOTONIC timestamp
+} probe_hdr_t;
+
+// Receive-side sequence tracking for one flow
+typedef struct {
+    bool seen;
+    uint32_t min_seq;
+    uint32_t max_seq;
+    uint64_t received;
+} probe_flow_t;
+
+// Loss / reorder / latency tracker
+typedef struct probe {
+    probe_flow_t *flows;             // PROBE_MAX_FLOWS entries
+    uint64_t packets;
+    uint64_t reordered;              // Arrived after a higher sequence number of the same flow
+    uint64_t lat_count;
+    uint64_t lat_sum_ns;
+    uint64_t lat_min_ns;
+    uint64_t lat_max_ns;
+    uint64_t lat_hist[PROBE_LAT_BUCKETS];
+} probe_t;
+
+// Summary derived from the tracker
+typedef struct {
+    uint64_t packets;
+    uint64_t expected;
+    uint64_t lost;
+    uint64_t reordered;
+    uint32_t flows;
+    double lat_avg_ns;
+    uint64_t lat_min_ns;
+    uint64_t lat_p50_ns;
+    uint64_t lat_p99_ns;
+    uint64_t lat_p999_ns;
+    uint64_t lat_max_ns;
+} probe_summary_t;
+
+// Function declarations
+probe_t* probe_create(void);
+void probe_process(probe_t *probe, const pkt_info_t *info, const uint8_t *data);
+int probe_merge(probe_t *dst, const probe_t *src);
+void probe_summarize(const probe_t *probe, probe_summary_t *summary);
+void probe_report(const probe_t *probe);
+void probe_destroy(probe_t *probe);
+
+#endif // PROBE_H
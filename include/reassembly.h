@@ -0,0 +1,87 @@
+#ifndef REASSEMBLY_H
+#define REASSEMBLY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "flow.h"
+
+#define REASM_SEG_DATA 2048          // Payload bytes per pooled segment
+
+// Buffered out-of-order segment (pooled, never malloc'ed per packet)
+typedef struct reasm_segment {
+    struct reasm_segment *next;
+    uint32_t seq;
+    uint32_t len;
+    uint8_t data[REASM_SEG_DATA];
+} reasm_segment_t;
+
+// One direction of a TCP connection
+typedef struct {
+    flow_key_t key;
+    uint64_t hash;
+    bool in_use;
+    bool have_seq;                   // next_seq is valid
+    bool fin_seen;
+    uint32_t next_seq;               // Next in-order byte expected
+    uint32_t fin_seq;
+    uint32_t ooo_bytes;              // Bytes buffered out of order
+    reasm_segment_t *ooo;            // Buffered segments sorted by sequence
+    uint64_t last_seen_ns;
+    uint32_t consumer_state;         // Owned by the deliver callback, 0 for a new flow and after a gap
+} reasm_flow_t;
+
+// In-order data callback. state points at the flow's consumer_state, letting a
+// consumer carry context (e.g. a matcher state) across deliveries.
+typedef void (*reasm_deliver_fn)(void *ctx, const flow_key_t *key, uint32_t *state,
+                                 const uint8_t *data, uint32_t len);
+
+typedef struct {
+    // Limits
+    uint32_t flow_limit;             // Max bytes buffered per flow
+    uint64_t timeout_ns;             // Idle flow timeout
+
+    // Flow table (open addressing)
+    reasm_flow_t *flows;
+    uint32_t flow_mask;
+    uint32_t max_flows;
+    uint32_t active_flows;
+    uint32_t sweep_cursor;
+
+    // Segment pool
+    reasm_segment_t *pool;
+    reasm_segment_t *free_list;
+    uint32_t pool_size;
+    uint32_t pool_used;
+
+    reasm_deliver_fn deliver;
+    void *deliver_ctx;
+
+    uint64_t now_ns;                 // Coarse monotonic clock, read once per packet
+    uint64_t last_sweep_ns;
+    uint32_t packets_since_tick;
+
+    // Counters
+    uint64_t segments;
+    uint64_t ooo_segments;
+    uint64_t bytes_reassembled;
+    uint64_t overlap_bytes;
+    uint64_t gaps;
+    uint64_t gap_bytes;
+    uint64_t fragments;              // IP fragments skipped (not reassembled at L3)
+    uint64_t flows_created;
+    uint64_t flows_closed;
+    uint64_t flows_expired;
+    uint64_t flows_rejected;         // Table full
+    uint32_t peak_flows;
+    uint32_t peak_pool_used;         // Segment high-water mark
+} reasm_t;
+
+// Function declarations
+reasm_t* reasm_create(uint32_t max_flows, uint32_t flow_limit_kb, uint32_t mem_limit_mb, uint32_t timeout_sec);
+void reasm_set_callback(reasm_t *reasm, reasm_deliver_fn fn, void *ctx);
+bool reasm_process(reasm_t *reasm, const pkt_info_t *info, const uint8_t *data);
+int reasm_merge(reasm_t *dst, const reasm_t *src);
+void reasm_report(const reasm_t *reasm);
+void reasm_destroy(reasm_t *reasm);
+
+#endif // REASSEMBLY_H
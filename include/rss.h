@@ -0,0 +1,33 @@
+#ifndef RSS_H
+#define RSS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "common.h"
+#include "spsc_ring.h"
+
+#define RSS_RETA_SIZE 128            // Indirection table entries, as on most NICs
+#define RSS_KEY_LEN 40               // Enough for an IPv6 5-tuple (36 bytes) + 32 bits
+#define RSS_MAX_BURST 64             // Packets per rss_hash_burst call
+
+// Software receive-side scaling: hash the 5-tuple (2-tuple for non-TCP/UDP and
+// fragments) and map it to a queue through a redirection table
+typedef struct {
+    rss_hash_t type;
+    bool use_sse42;                  // Hardware CRC32C instruction available
+    uint32_t num_queues;
+    uint16_t reta[RSS_RETA_SIZE];
+    uint32_t toeplitz[2][256];       // Contribution of a byte at an even / odd tuple offset
+    uint32_t crc_table[256];         // Software CRC32C fallback
+} rss_t;
+
+// Function declarations
+void rss_init(rss_t *rss, rss_hash_t type, uint32_t num_queues);
+void rss_hash_burst(const rss_t *rss, const pipe_desc_t *descs, uint32_t n, uint32_t *hashes);
+const char* rss_hash_name(const rss_t *rss);
+
+static inline uint32_t rss_queue(const rss_t *rss, uint32_t hash) {
+    return rss->reta[hash % RSS_RETA_SIZE];
+}
+
+#endif // RSS_H
@@ -0,0 +1,40 @@
+#ifndef RX_LOOP_H
+#define RX_LOOP_H
+
+#include <stdbool.h>
+#include "packet_receiver.h"
+
+// Specialized receive loops. Each backend writes its loop once as an
+// always-inline function whose feature switches are parameters; the macro
+// below instantiates it for every combination with constant arguments, so the
+// compiler drops the untaken branches. The variant is picked once at start.
+// --generic-loop keeps the original loop (runtime checks, per-packet stats).
+
+#define RX_ALWAYS_INLINE static inline __attribute__((always_inline))
+
+#define RX_VARIANTS 4
+
+// Variant index: bit 1 = verbose, bit 0 = processing stages
+static inline unsigned rx_loop_variant(const packet_receiver_t *receiver) {
+    return (receiver->config.verbose ? 2u : 0u) | (receiver->stages ? 1u : 0u);
+}
+
+static inline const char* rx_loop_name(unsigned variant) {
+    static const char *names[RX_VARIANTS] = {
+        "specialized (count only)", "specialized (stages)",
+        "specialized (verbose)", "specialized (verbose, stages)"
+    };
+    return names[variant];
+}
+
+// Defines prefix_variants[RX_VARIANTS], built from body(receiver, priv, verbose, stages)
+#define RX_LOOP_INSTANTIATE(prefix, body, priv_t)                                          \
+    static int prefix##_plain(packet_receiver_t *r, priv_t *p) { return body(r, p, false, false); } \
+    static int prefix##_stages(packet_receiver_t *r, priv_t *p) { return body(r, p, false, true); } \
+    static int prefix##_verbose(packet_receiver_t *r, priv_t *p) { return body(r, p, true, false); } \
+    static int prefix##_verbose_stages(packet_receiver_t *r, priv_t *p) { return body(r, p, true, true); } \
+    static int (*const prefix##_variants[RX_VARIANTS])(packet_receiver_t *, priv_t *) = {    \
+        prefix##_plain, prefix##_stages, prefix##_verbose, prefix##_verbose_stages         \
+    }
+
+#endif // RX_LOOP_H
@@ -0,0 +1,96 @@
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+
+#define SPSC_CACHE_LINE 64
+#define SPSC_MAX_SIZE (1u << 31)     // Largest power of two a uint32_t holds
+
+// Packet descriptor handed between pipeline stages: points into the backend's
+// receive buffer, never a copy. The cookie tells the backend how to recycle it
+// (UMEM address, mbuf pointer, socket slot).
+typedef struct {
+    const uint8_t *data;
+    uint32_t len;
+    uint32_t wire_len;               // Length on the wire (len may be truncated)
+    uint64_t cookie;
+} pipe_desc_t;
+
+// Lock-free single-producer / single-consumer descriptor ring.
+// Each side keeps a cached copy of the other side's index so the shared
+// cache line is only read when the ring looks full (or empty).
+typedef struct {
+    // Read-only after creation
+    _Alignas(SPSC_CACHE_LINE) pipe_desc_t *slots;
+    uint32_t mask;
+
+    // Producer side
+    _Alignas(SPSC_CACHE_LINE) _Atomic uint32_t head;
+    uint32_t cached_tail;
+
+    // Consumer side
+    _Alignas(SPSC_CACHE_LINE) _Atomic uint32_t tail;
+    uint32_t cached_head;
+} spsc_ring_t;
+
+// Size is rounded up to a power of two (at least 8, keeping the slot array a
+// whole number of cache lines); returns NULL above SPSC_MAX_SIZE
+static inline spsc_ring_t* spsc_ring_create(uint32_t size) {
+    if (size > SPSC_MAX_SIZE) return NULL;
+    uint32_t n = 8;
+    while (n < size) n <<= 1;
+
+    spsc_ring_t *ring = aligned_alloc(SPSC_CACHE_LINE, sizeof(spsc_ring_t));
+    if (!ring) return NULL;
+    memset(ring, 0, sizeof(*ring));
+    ring->slots = aligned_alloc(SPSC_CACHE_LINE, n * sizeof(pipe_desc_t));
+    if (!ring->slots) {
+        free(ring);
+        return NULL;
+    }
+    ring->mask = n - 1;
+    return ring;
+}
+
+static inline void spsc_ring_destroy(spsc_ring_t *ring) {
+    if (!ring) return;
+    free(ring->slots);
+    free(ring);
+}
+
+// Enqueue up to n descriptors; returns how many fit
+static inline uint32_t spsc_ring_enqueue(spsc_ring_t *ring, const pipe_desc_t *descs, uint32_t n) {
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    uint32_t free_slots = ring->mask + 1 - (head - ring->cached_tail);
+    if (free_slots < n) {
+        ring->cached_tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+        free_slots = ring->mask + 1 - (head - ring->cached_tail);
+        if (n > free_slots) n = free_slots;
+    }
+    for (uint32_t i = 0; i < n; i++) {
+        ring->slots[(head + i) & ring->mask] = descs[i];
+    }
+    atomic_store_explicit(&ring->head, head + n, memory_order_release);
+    return n;
+}
+
+// Dequeue up to n descriptors; returns how many were taken
+static inline uint32_t spsc_ring_dequeue(spsc_ring_t *ring, pipe_desc_t *descs, uint32_t n) {
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    uint32_t avail = ring->cached_head - tail;
+    if (avail < n) {
+        ring->cached_head = atomic_load_explicit(&ring->head, memory_order_acquire);
+        avail = ring->cached_head - tail;
+        if (n > avail) n = avail;
+    }
+    for (uint32_t i = 0; i < n; i++) {
+        descs[i] = ring->slots[(tail + i) & ring->mask];
+    }
+    atomic_store_explicit(&ring->tail, tail + n, memory_order_release);
+    return n;
+}
+
+#endif // SPSC_RING_H
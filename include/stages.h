@@ -0,0 +1,38 @@
+#ifndef STAGES_H
+#define STAGES_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "common.h"
+#include "heavy_hitter.h"
+#include "dpi.h"
+#include "reassembly.h"
+#include "capture.h"
+#include "probe.h"
+#include "tap.h"
+
+// Per-packet processing stages run inline by the receive loops, or by pipeline
+// workers (--workers). Each thread owns one instance; instances are merged at report time.
+typedef struct stages {
+    hh_sketch_t *hh;                 // Heavy hitter sketch (NULL if disabled)
+    dpi_automaton_t *dpi_ac;         // Compiled pattern set
+    bool dpi_ac_shared;              // dpi_ac belongs to the instance this was cloned from
+    dpi_t *dpi;                      // Payload matching counters (NULL if disabled)
+    reasm_t *reasm;                  // TCP reassembly (NULL if disabled)
+    capture_t *capture;              // pcap/pcapng writer (NULL if disabled)
+    tap_t *tap;                      // Shared-memory tap for other processes (NULL if disabled)
+    probe_t *probe;                  // Loss / latency tracker (NULL if disabled)
+} stages_t;
+
+// Function declarations
+bool stages_enabled(const config_t *config);
+stages_t* stages_create(const config_t *config);
+stages_t* stages_clone(const stages_t *parent, const config_t *config);
+void stages_process(stages_t *stages, const uint8_t *data, uint32_t len);
+int stages_merge(stages_t *dst, const stages_t *src);
+void stages_finish(stages_t *stages);
+void stages_report_outputs(const stages_t *stages);
+void stages_report(const stages_t *stages);
+void stages_destroy(stages_t *stages);
+
+#endif // STAGES_H
@@ -0,0 +1,89 @@
+#ifndef TAP_H
+#define TAP_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdatomic.h>
+
+// Shared-memory packet tap. The receiver copies each packet once into a
+// memfd-backed broadcast ring (hugepages when reserved) and hands the fd to
+// clients over a unix socket. Consumers mmap the ring and read the payload in
+// place; several can attach at once, and none of them can slow the receiver
+// down. A consumer that falls more than a ring behind loses the overwritten
+// packets, which it counts as drops.
+//
+// Every descriptor carries a sequence number used as a seqlock: 2*pos+1 while
+// the producer writes position pos, 2*pos+2 once it is published. A reader
+// checks it before and after using the payload.
+
+#define TAP_MAGIC 0x50445450u        // "PDTP"
+#define TAP_VERSION 1
+#define TAP_SLOT_SIZE 2048           // Payload bytes per slot; longer packets are truncated
+#define TAP_MAX_CONSUMERS 16
+#define TAP_DEFAULT_SLOTS 16384      // 32 MB of payload
+
+typedef enum {
+    TAP_CONSUMER_FREE = 0,
+    TAP_CONSUMER_ACTIVE,
+    TAP_CONSUMER_DETACHED            // Counters kept for the receiver's report
+} tap_consumer_state_t;
+
+typedef struct {
+    _Atomic uint64_t seq;
+    uint64_t ts_ns;                  // Receive time (CLOCK_MONOTONIC)
+    uint32_t len;                    // Wire length
+    uint32_t caplen;                 // Bytes in the slot
+    uint64_t reserved;
+} tap_desc_t;
+
+// Written by its consumer only; the receiver reads it for the report
+typedef struct {
+    _Alignas(64) _Atomic uint32_t state;
+    int32_t pid;
+    _Atomic uint64_t pos;            // Next position to read
+    _Atomic uint64_t packets;
+    _Atomic uint64_t drops;          // Overwritten before or while being read
+    _Atomic uint64_t max_lag;        // Largest distance behind the producer, in packets
+} tap_consumer_t;
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t num_slots;              // Power of two
+    uint32_t slot_size;
+    uint64_t desc_offset;            // From the start of the mapping
+    uint64_t data_offset;
+    uint64_t total_size;
+    _Alignas(64) _Atomic uint64_t head; // Next position the producer writes
+    _Atomic uint32_t closed;         // Producer has stopped
+    tap_consumer_t consumers[TAP_MAX_CONSUMERS];
+} tap_shm_t;
+
+// Producer side (packet_receiver --tap)
+typedef struct tap tap_t;
+
+tap_t* tap_open(const char *socket_path, uint32_t num_slots);
+void tap_publish(tap_t *tap, const uint8_t *data, uint32_t len);
+void tap_close(tap_t *tap);
+void tap_report(const tap_t *tap);
+void tap_destroy(tap_t *tap);
+
+// Client side (libpdtap.a)
+typedef struct {
+    const uint8_t *data;             // Points into the shared ring; valid until tap_client_done
+    uint32_t len;
+    uint32_t caplen;
+    uint64_t ts_ns;
+} tap_packet_t;
+
+typedef struct tap_client tap_client_t;
+
+tap_client_t* tap_client_open(const char *socket_path);
+int tap_client_next(tap_client_t *client, tap_packet_t *pkt);
+bool tap_client_done(tap_client_t *client);
+uint64_t tap_client_lag(const tap_client_t *client);
+const tap_consumer_t* tap_client_counters(const tap_client_t *client);
+void tap_client_close(tap_client_t *client);
+
+#endif // TAP_H
@@ -0,0 +1,63 @@
+#ifndef TRAFFIC_H
+#define TRAFFIC_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "probe.h"
+
+#define TRAFFIC_MAX_SIZES 8
+#define TRAFFIC_SCHEDULE_LEN 256         // Size schedule cycled by the generator
+#define TRAFFIC_MIN_FRAME 64             // Frame sizes include the 4-byte FCS (pktgen convention)
+#define TRAFFIC_MAX_FRAME 1518
+#define TRAFFIC_HDR_LEN 42               // Ethernet + IPv4 + UDP
+#define PACER_MAX_RATE 1000000000ULL     // pps; keeps the token arithmetic inside 64 bits
+
+// What the generator builds
+typedef struct {
+    uint8_t src_mac[6];
+    uint8_t dst_mac[6];
+    uint32_t src_ip;                     // Network byte order
+    uint32_t dst_ip;                     // Network byte order
+    uint16_t src_port;                   // First source port; flow i uses src_port + i
+    uint16_t dst_port;
+    uint32_t flows;                      // 1 .. PROBE_MAX_FLOWS
+    uint32_t num_sizes;
+    uint32_t sizes[TRAFFIC_MAX_SIZES];   // Frame size including FCS
+    uint32_t weights[TRAFFIC_MAX_SIZES];
+} traffic_config_t;
+
+// IPv4/UDP frame generator with embedded probe headers
+typedef struct {
+    traffic_config_t cfg;
+    uint8_t template[TRAFFIC_HDR_LEN];
+    uint32_t ip_sum_base;                // IPv4 header sum without tot_len
+    uint16_t schedule[TRAFFIC_SCHEDULE_LEN];
+    uint32_t sched_len;
+    uint32_t sched_pos;
+    uint32_t next_flow;
+    uint32_t *flow_seq;                  // Next sequence number per flow
+} traffic_gen_t;
+
+// Token bucket rate limiter. Tokens are kept in packet-nanoseconds so the
+// refill is exact integer arithmetic at any rate.
+typedef struct {
+    uint64_t rate_pps;                   // 0 = unlimited
+    uint64_t tokens;
+    uint64_t max_tokens;                 // Burst depth
+    uint64_t last_ns;
+} pacer_t;
+
+// Function declarations
+int traffic_parse_sizes(const char *spec, traffic_config_t *cfg);
+int traffic_parse_mac(const char *str, uint8_t mac[6]);
+int traffic_interface_mac(const char *ifname, uint8_t mac[6]);
+int traffic_gen_init(traffic_gen_t *gen, const traffic_config_t *cfg);
+uint32_t traffic_gen_next_len(const traffic_gen_t *gen);
+uint32_t traffic_gen_build(traffic_gen_t *gen, uint8_t *buf, uint64_t tx_ns);
+void traffic_gen_cleanup(traffic_gen_t *gen);
+
+void pacer_init(pacer_t *pacer, uint64_t rate_pps, uint32_t burst);
+uint32_t pacer_acquire(pacer_t *pacer, uint32_t want);
+void pacer_refund(pacer_t *pacer, uint32_t n);
+
+#endif // TRAFFIC_H
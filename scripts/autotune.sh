@@ -0,0 +1,281 @@
+#!/bin/bash
+# Receive tuning sweep: find the burst, ring and pool sizes that give the highest
+# receive rate under a steady offered load, within a loss and CPU budget.
+#
+# Starts from the receiver's defaults and sweeps one parameter at a time, keeping
+# the best value before moving to the next (batch, then ring size, then frames or
+# mbufs and mbuf cache). A configuration passes when probe loss is at or below
+# LOSS_PCT and the receiver's CPU time is at or below CPU_PCT of the sender's
+# window (0 = no CPU limit). Among passing configurations the highest rate wins;
+# rates within TIE_PCT of each other go to the one using less CPU. Each trial is
+# a fresh receiver process because the UMEM and mempool are sized at init.
+#
+# Environment overrides:
+#   MODE=af_xdp (socket, af_xdp, dpdk or pcap)  SIZE=64  FLOWS=64  TX_MODE=socket
+#   RATE=0 (offered pps, 0 = what the sender reaches unpaced)  TRIAL_SEC=5  ROUNDS=1
+#   LOSS_PCT=0.1  CPU_PCT=0  TIE_PCT=1
+#   BATCHES="8 16 32 64 128 256"  RINGS="512 1024 2048 4096"
+#   FRAMES="2048 4096 8192 16384"  MBUFS="4095 8191 16383 32767"  MBUF_CACHES="64 128 250 512"
+#   TX_IF/RX_IF (existing ports; default: a veth pair)  RX_ADDRESS (PCI address for DPDK)
+#   PCAP_FILE (pcap mode: the file to replay)  PCAP_LOOPS=20
+#   OUT_DIR=bench_results/autotune-<timestamp>
+set -u
+
+ROOT=$(cd "$(dirname "$0")/.." && pwd)
+. "$ROOT/scripts/lib.sh"
+RX_BIN=$ROOT/bin/packet_receiver
+TX_BIN=$ROOT/bin/packet_sender
+
+MODE=${MODE:-af_xdp}
+SIZE=${SIZE:-64}
+FLOWS=${FLOWS:-64}
+TX_MODE=${TX_MODE:-socket}
+RATE=${RATE:-0}
+TRIAL_SEC=${TRIAL_SEC:-5}
+ROUNDS=${ROUNDS:-1}
+LOSS_PCT=${LOSS_PCT:-0.1}
+CPU_PCT=${CPU_PCT:-0}
+TIE_PCT=${TIE_PCT:-1}
+BATCHES=${BATCHES:-"8 16 32 64 128 256"}
+RINGS=${RINGS:-"512 1024 2048 4096"}
+FRAMES=${FRAMES:-"2048 4096 8192 16384"}
+MBUFS=${MBUFS:-"4095 8191 16383 32767"}
+MBUF_CACHES=${MBUF_CACHES:-"64 128 250 512"}
+RX_ADDRESS=${RX_ADDRESS:-}
+PCAP_FILE=${PCAP_FILE:-}
+PCAP_LOOPS=${PCAP_LOOPS:-20}
+OUT_DIR=${OUT_DIR:-$ROOT/bench_results/autotune-$(date +%Y%m%d-%H%M%S)}
+
+if [ ! -x "$RX_BIN" ] || [ ! -x "$TX_BIN" ]; then
+    echo "Error: build first (make all, or make socket without libxdp/DPDK)" >&2
+    exit 1
+fi
+
+# Parameters swept per mode, in sweep order
+case $MODE in
+    socket) PARAMS="batch" ;;
+    af_xdp) PARAMS="batch ring frames" ;;
+    dpdk)   PARAMS="batch ring mbufs cache"
+            if [ -z "$RX_ADDRESS" ]; then
+                echo "Error: set RX_ADDRESS to the PCI address of a DPDK-bound port" >&2
+                exit 1
+            fi ;;
+    pcap)   PARAMS="batch"
+            if [ ! -s "$PCAP_FILE" ]; then
+                echo "Error: set PCAP_FILE to the capture to replay" >&2
+                exit 1
+            fi ;;
+    *) echo "Error: unknown mode $MODE" >&2; exit 1 ;;
+esac
+
+param_flag() {
+    case $1 in
+        batch) echo --batch ;;  ring) echo --ring-size ;;  frames) echo --frames ;;
+        mbufs) echo --mbufs ;;  cache) echo --mbuf-cache ;;
+    esac
+}
+
+param_json() {
+    case $1 in
+        batch) echo batch ;;  ring) echo ring_size ;;  frames) echo frames ;;
+        mbufs) echo mbufs ;;  cache) echo mbuf_cache ;;
+    esac
+}
+
+param_values() {
+    case $1 in
+        batch) echo "$BATCHES" ;;  ring) echo "$RINGS" ;;  frames) echo "$FRAMES" ;;
+        mbufs) echo "$MBUFS" ;;  cache) echo "$MBUF_CACHES" ;;
+    esac
+}
+
+# Largest value packet_receiver accepts (RX_MAX_* in include/common.h)
+param_max() {
+    case $1 in
+        batch) echo 512 ;;  ring) echo 32768 ;;  frames) echo 1048576 ;;
+        mbufs) echo 16777216 ;;  cache) echo 512 ;;
+    esac
+}
+
+# Keep the sweep within what the receiver accepts
+for p in $PARAMS; do
+    for v in $(param_values "$p"); do
+        if ! [ "$v" -ge 1 ] 2>/dev/null || [ "$v" -gt "$(param_max "$p")" ]; then
+            echo "Error: $(param_flag "$p") value $v is outside 1-$(param_max "$p")" >&2
+            exit 1
+        fi
+    done
+done
+
+if [ "$MODE" != pcap ]; then
+    if [ "$(id -u)" -ne 0 ]; then
+        echo "Error: the sweep needs root (veth setup, raw sockets, XDP)" >&2
+        exit 1
+    fi
+    if [ -z "${TX_IF:-}" ]; then
+        TX_IF=pdtune0
+        RX_IF=pdtune1
+        trap 'ip link del "$TX_IF" 2>/dev/null' EXIT
+        ip link del "$TX_IF" 2>/dev/null
+        if ! ip link add "$TX_IF" type veth peer name "$RX_IF"; then
+            echo "Error: failed to create veth pair $TX_IF/$RX_IF" >&2
+            exit 1
+        fi
+        for dev in "$TX_IF" "$RX_IF"; do
+            sysctl -qw "net.ipv6.conf.$dev.disable_ipv6=1" 2>/dev/null
+            ip link set "$dev" up
+        done
+        sleep 1
+    fi
+    RX_IF=${RX_IF:-$TX_IF}
+fi
+
+mkdir -p "$OUT_DIR/raw"
+TRIALS=$OUT_DIR/trials.csv
+SUMMARY=$OUT_DIR/summary.txt
+
+declare -A CUR      # Current best value per parameter
+declare -A SEEN     # Trial results by configuration: "pps loss cpu"
+
+# Tuning flags for the current values, with one parameter overridden
+tuning_args() {
+    local override=${1:-} value=${2:-} p
+    for p in $PARAMS; do
+        local v=${CUR[$p]:-}
+        [ "$p" = "$override" ] && v=$value
+        [ -n "$v" ] && printf '%s %s ' "$(param_flag "$p")" "$v"
+    done
+}
+
+# Run one trial with the given tuning flags; sets T_PPS T_LOSS T_CPU (T_JSON: receiver JSON)
+trial() {
+    local tuning=$1 rate=$2
+    local key="$tuning@$rate"
+    if [ -n "${SEEN[$key]:-}" ]; then
+        read -r T_PPS T_LOSS T_CPU <<< "${SEEN[$key]}"
+        return 0
+    fi
+
+    local tag
+    tag=$(echo "${tuning:-defaults}_$rate" | tr -d ' -')
+    local rx_json=$OUT_DIR/raw/${tag}_rx.json tx_json=$OUT_DIR/raw/${tag}_tx.json
+    local log=$OUT_DIR/raw/$tag.log secs
+    T_JSON=$rx_json
+    rm -f "$rx_json" "$tx_json"
+
+    # shellcheck disable=SC2086  # tuning is a flag list
+    if [ "$MODE" = pcap ]; then
+        "$RX_BIN" --mode pcap --file "$PCAP_FILE" --loop "$PCAP_LOOPS" --json "$rx_json" \
+            $tuning > "$log" 2>&1
+        [ -s "$rx_json" ] || { echo "    trial failed, see $log" >&2; return 1; }
+        secs=$(json_num "$rx_json" runtime_sec)
+        T_PPS=$(awk -v p="$(json_num "$rx_json" rx_packets)" -v s="$secs" 'BEGIN { printf "%.0f", (s > 0 ? p / s : 0) }')
+        T_LOSS=0
+    else
+        local rx_args=(--mode "$MODE" -i "$RX_IF")
+        [ "$MODE" = dpdk ] && rx_args+=(-a "$RX_ADDRESS")
+        # The receiver starts first and outlives the sender so in-flight packets are counted
+        "$RX_BIN" "${rx_args[@]}" --probe --duration $((TRIAL_SEC + 2)) --json "$rx_json" \
+            $tuning > "$log" 2>&1 &
+        local rx_pid=$!
+        sleep 1
+        "$TX_BIN" --mode "$TX_MODE" -i "$TX_IF" --size "$SIZE" --flows "$FLOWS" --rate "$rate" \
+            --duration "$TRIAL_SEC" --json "$tx_json" >> "$log" 2>&1
+        wait $rx_pid
+        if [ ! -s "$rx_json" ] || [ ! -s "$tx_json" ]; then
+            echo "    trial failed, see $log" >&2
+            return 1
+        fi
+        # Rate and CPU over the sender's window: the receiver idles before and after it
+        local sent recv
+        secs=$(json_num "$tx_json" runtime_sec)
+        sent=$(json_num "$tx_json" tx_packets)
+        recv=$(json_num "$rx_json" probe_packets)
+        T_PPS=$(awk -v p="${recv:-0}" -v s="$secs" 'BEGIN { printf "%.0f", (s > 0 ? p / s : 0) }')
+        T_LOSS=$(awk -v t="$sent" -v r="${recv:-0}" \
+            'BEGIN { l = t - r; if (l < 0) l = 0; printf "%.4f", (t > 0 ? l * 100 / t : 100) }')
+        T_TX_PPS=$(json_num "$tx_json" tx_pps)
+    fi
+    T_CPU=$(awk -v c="$(json_num "$rx_json" cpu_sec)" -v s="$secs" 'BEGIN { printf "%.1f", (s > 0 ? c * 100 / s : 0) }')
+    SEEN[$key]="$T_PPS $T_LOSS $T_CPU"
+
+    local status=fail
+    passed "$T_LOSS" "$T_CPU" && status=pass
+    echo "$MODE,$SIZE,$rate,\"$tuning\",$T_PPS,$T_LOSS,$T_CPU,$status" >> "$TRIALS"
+    printf "    %-48s %12s pps, loss %s%%, CPU %s%% (%s)\n" "${tuning:-defaults}" "$T_PPS" "$T_LOSS" "$T_CPU" "$status"
+    [ "$MODE" = pcap ] || sleep 1    # let queues drain between trials
+}
+
+passed() {
+    awk -v l="$1" -v c="$2" -v maxl="$LOSS_PCT" -v maxc="$CPU_PCT" \
+        'BEGIN { exit !(l <= maxl && (maxc <= 0 || c <= maxc)) }'
+}
+
+# Whether trial result (pps loss cpu) $1..$3 beats the current best $4..$6
+better() {
+    local ok_new=0 ok_old=0
+    passed "$2" "$3" && ok_new=1
+    passed "$5" "$6" && ok_old=1
+    [ $ok_new -ne $ok_old ] && return $((1 - ok_new))
+    awk -v p="$1" -v c="$3" -v bp="$4" -v bc="$6" -v tie="$TIE_PCT" \
+        'BEGIN { if (bp > 0 && (p - bp) * 100 / bp <= tie && (bp - p) * 100 / bp <= tie) exit !(c < bc); exit !(p > bp) }'
+}
+
+echo "mode,size,offered_pps,tuning,rx_pps,loss_pct,cpu_pct,status" > "$TRIALS"
+
+# Offered load: fixed, or what the sender reaches on its own
+if [ "$MODE" = pcap ]; then
+    RATE=0
+    echo "Autotune $MODE: replaying $PCAP_FILE x$PCAP_LOOPS -> $OUT_DIR"
+else
+    if [ "$RATE" = 0 ]; then
+        echo "Measuring the unpaced sender rate"
+        trial "" 0 || exit 1
+        RATE=$(printf "%.0f" "$T_TX_PPS")
+    fi
+    echo "Autotune $MODE: $TX_IF -> $RX_IF, $SIZE-byte frames at $RATE pps, ${TRIAL_SEC}s trials," \
+         "loss <= $LOSS_PCT%, CPU <= ${CPU_PCT}% (0 = unlimited) -> $OUT_DIR"
+fi
+
+# Baseline: the receiver's defaults, read back from its JSON
+echo "Defaults"
+trial "" "$RATE" || exit 1
+for p in $PARAMS; do
+    CUR[$p]=$(json_num "$T_JSON" "$(param_json "$p")")
+done
+read -r BASE_PPS BASE_LOSS BASE_CPU <<< "$T_PPS $T_LOSS $T_CPU"
+read -r BEST_PPS BEST_LOSS BEST_CPU <<< "$T_PPS $T_LOSS $T_CPU"
+DEFAULTS=$(tuning_args)
+SEEN["$DEFAULTS@$RATE"]="$T_PPS $T_LOSS $T_CPU"
+
+for round in $(seq 1 "$ROUNDS"); do
+    for p in $PARAMS; do
+        echo "Round $round: $(param_flag "$p")"
+        for v in $(param_values "$p"); do
+            trial "$(tuning_args "$p" "$v")" "$RATE" || continue
+            if better "$T_PPS" "$T_LOSS" "$T_CPU" "$BEST_PPS" "$BEST_LOSS" "$BEST_CPU"; then
+                CUR[$p]=$v
+                read -r BEST_PPS BEST_LOSS BEST_CPU <<< "$T_PPS $T_LOSS $T_CPU"
+            fi
+        done
+    done
+done
+
+CHOSEN=$(tuning_args)
+{
+    echo "Receive autotune $(date -Iseconds) on $(uname -r), $(nproc) CPUs"
+    if [ "$MODE" = pcap ]; then
+        echo "Mode $MODE, replay of $PCAP_FILE x$PCAP_LOOPS"
+    else
+        echo "Mode $MODE, $TX_IF -> $RX_IF, sender: $TX_MODE, $SIZE-byte frames, $FLOWS flows, offered $RATE pps"
+    fi
+    echo "Budget: loss <= $LOSS_PCT%, CPU <= ${CPU_PCT}% of one core (0 = unlimited), ${TRIAL_SEC}s trials"
+    echo
+    printf "Defaults: %-48s %12s pps, loss %s%%, CPU %s%%\n" "$DEFAULTS" "$BASE_PPS" "$BASE_LOSS" "$BASE_CPU"
+    printf "Chosen:   %-48s %12s pps, loss %s%%, CPU %s%%\n" "$CHOSEN" "$BEST_PPS" "$BEST_LOSS" "$BEST_CPU"
+    passed "$BEST_LOSS" "$BEST_CPU" || echo "No configuration met the budget; the chosen one has the highest rate"
+    echo
+    echo "Run with: $RX_BIN --mode $MODE ${CHOSEN}..."
+} > "$SUMMARY"
+echo
+cat "$SUMMARY"
@@ -0,0 +1,27 @@
+#!/bin/bash
+# Compare two bench_matrix.sh results.csv files and flag throughput regressions.
+# Usage: scripts/bench_compare.sh <baseline.csv> <candidate.csv> [max drop %, default 5]
+# Exits 1 if any run's rx_pps dropped by more than the threshold.
+if [ $# -lt 2 ]; then
+    echo "Usage: $0 <baseline.csv> <candidate.csv> [max drop %]" >&2
+    exit 2
+fi
+
+awk -F, -v limit="${3:-5}" '
+    FNR == 1 { next }
+    # Rows from before the loop column compare against the default (specialized) loop
+    { loop = $12 == "" ? "specialized" : $12 }
+    NR == FNR { if ($11 == "ok") base[$1 "," $2 "," $3 "," $4 "," loop] = $6; next }
+    $11 == "ok" && ($1 "," $2 "," $3 "," $4 "," loop) in base {
+        key = $1 "," $2 "," $3 "," $4 "," loop
+        old = base[key]
+        delta = old > 0 ? ($6 - old) * 100 / old : 0
+        flag = delta < -limit ? "REGRESSION" : ""
+        if (flag != "") bad++
+        printf "%-8s %6s t%-3s b%-5s %-11s %14.0f -> %14.0f pps %+8.2f%% %s\n", $1, $2, $3, $4, loop,
+               old, $6, delta, flag
+    }
+    END {
+        if (bad) { printf "%d regression(s) beyond %s%%\n", bad, limit; exit 1 }
+        print "No regressions beyond " limit "%"
+    }' "$1" "$2"
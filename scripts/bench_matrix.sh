@@ -0,0 +1,223 @@
+#!/bin/bash
+# Benchmark matrix on a throwaway veth pair: every available receive mode x
+# packet size x thread count x batch size, driven by packet_sender.
+# A thread count of 1 processes on the receive thread; N > 1 runs N pipeline workers.
+# Single-thread cells also run with --generic-loop, and the summary reports the
+# specialized receive loop's PPS gain over the generic one.
+#
+# Writes $OUT_DIR/results.json, results.csv and summary.txt; raw per-run JSON and
+# logs go to $OUT_DIR/raw. Compare two runs with scripts/bench_compare.sh.
+#
+# Environment overrides:
+#   MODES="socket af_xdp dpdk pcap"  SIZES="64 512 1500"  THREADS="1"  BATCHES="64"
+#   LOOPS="specialized generic"
+#   DURATION=5 (seconds per run)  RATE=0 (pps, 0 = max)  FLOWS=64  TX_MODE=socket
+#   VETH_TX=pdbench0  VETH_RX=pdbench1  PCAP_PACKETS=200000  PCAP_LOOPS=10
+#   OUT_DIR=bench_results/<timestamp>
+set -u
+
+ROOT=$(cd "$(dirname "$0")/.." && pwd)
+. "$ROOT/scripts/lib.sh"
+RX_BIN=$ROOT/bin/packet_receiver
+TX_BIN=$ROOT/bin/packet_sender
+
+MODES=${MODES:-"socket af_xdp dpdk pcap"}
+SIZES=${SIZES:-"64 512 1500"}
+THREADS=${THREADS:-"1"}
+BATCHES=${BATCHES:-"64"}
+LOOPS=${LOOPS:-"specialized generic"}
+DURATION=${DURATION:-5}
+RATE=${RATE:-0}
+FLOWS=${FLOWS:-64}
+TX_MODE=${TX_MODE:-socket}
+VETH_TX=${VETH_TX:-pdbench0}
+VETH_RX=${VETH_RX:-pdbench1}
+PCAP_PACKETS=${PCAP_PACKETS:-200000}
+PCAP_LOOPS=${PCAP_LOOPS:-10}
+OUT_DIR=${OUT_DIR:-$ROOT/bench_results/$(date +%Y%m%d-%H%M%S)}
+
+if [ "$(id -u)" -ne 0 ]; then
+    echo "Error: the benchmark needs root (veth setup, raw sockets, XDP)" >&2
+    exit 1
+fi
+if [ ! -x "$RX_BIN" ] || [ ! -x "$TX_BIN" ]; then
+    echo "Error: build first (make all, or make socket without libxdp/DPDK)" >&2
+    exit 1
+fi
+
+mkdir -p "$OUT_DIR/raw"
+CSV=$OUT_DIR/results.csv
+JSON=$OUT_DIR/results.json
+SUMMARY=$OUT_DIR/summary.txt
+
+cleanup() {
+    ip link del "$VETH_TX" 2>/dev/null
+}
+trap cleanup EXIT
+
+ip link del "$VETH_TX" 2>/dev/null
+if ! ip link add "$VETH_TX" type veth peer name "$VETH_RX"; then
+    echo "Error: failed to create veth pair $VETH_TX/$VETH_RX" >&2
+    exit 1
+fi
+for dev in "$VETH_TX" "$VETH_RX"; do
+    # Keep the host stack (IPv6 DAD, router solicitations) out of the counts
+    sysctl -qw "net.ipv6.conf.$dev.disable_ipv6=1" 2>/dev/null
+    ip link set "$dev" up
+done
+sleep 1
+
+rx_supports() {
+    "$RX_BIN" --help 2>/dev/null | grep -q -- "$1"
+}
+
+PCAP_UNAVAILABLE=
+DPDK_UNAVAILABLE="no DPDK PMD bound to the veth pair"
+
+# One pcap per size, recorded from packet_sender through the socket receiver
+make_pcap() {
+    local size=$1 file=$OUT_DIR/raw/traffic_$1.pcap
+    if [ ! -s "$file" ]; then
+        "$RX_BIN" --mode socket -i "$VETH_RX" --write "$file" --duration 4 \
+            > "$OUT_DIR/raw/pcap_$size.log" 2>&1 &
+        local rx_pid=$!
+        sleep 1
+        "$TX_BIN" -i "$VETH_TX" --size "$size" --flows "$FLOWS" --count "$PCAP_PACKETS" \
+            --rate 200k >> "$OUT_DIR/raw/pcap_$size.log" 2>&1
+        wait $rx_pid
+    fi
+    echo "$file"
+}
+
+echo "mode,size,threads,batch,tx_pps,rx_pps,rx_mbps,loss_pct,lat_p50_us,lat_p99_us,status,loop" > "$CSV"
+echo "[" > "$JSON"
+first_record=1
+
+record() {
+    local mode=$1 size=$2 threads=$3 batch=$4 loop=$5 status=$6 rx_json=$7 tx_json=$8
+    local tx_pps="" rx_pps="" rx_mbps="" loss="" p50="" p99=""
+
+    if [ "$status" = ok ]; then
+        local rx_packets rx_bytes probe_packets tx_packets secs
+        rx_packets=$(json_num "$rx_json" rx_packets)
+        rx_bytes=$(json_num "$rx_json" rx_bytes)
+        if [ "$mode" = pcap ]; then
+            secs=$(json_num "$rx_json" runtime_sec)
+            tx_pps=0
+        else
+            # Rates over the sender's window: the receiver idles before and after it
+            secs=$(json_num "$tx_json" runtime_sec)
+            tx_pps=$(json_num "$tx_json" tx_pps)
+            tx_packets=$(json_num "$tx_json" tx_packets)
+            probe_packets=$(json_num "$rx_json" probe_packets)
+            loss=$(awk -v t="$tx_packets" -v r="$probe_packets" \
+                'BEGIN { printf "%.4f", (t > 0 ? (t - r) * 100 / t : 0) }')
+            p50=$(awk -v v="$(json_num "$rx_json" lat_p50_ns)" 'BEGIN { printf "%.2f", v / 1000 }')
+            p99=$(awk -v v="$(json_num "$rx_json" lat_p99_ns)" 'BEGIN { printf "%.2f", v / 1000 }')
+        fi
+        rx_pps=$(awk -v p="$rx_packets" -v s="$secs" 'BEGIN { printf "%.2f", (s > 0 ? p / s : 0) }')
+        rx_mbps=$(awk -v b="$rx_bytes" -v s="$secs" 'BEGIN { printf "%.2f", (s > 0 ? b * 8 / s / 1e6 : 0) }')
+    fi
+
+    echo "$mode,$size,$threads,$batch,$tx_pps,$rx_pps,$rx_mbps,$loss,$p50,$p99,$status,$loop" >> "$CSV"
+
+    [ $first_record -eq 1 ] || echo "," >> "$JSON"
+    first_record=0
+    {
+        printf '  {"mode": "%s", "size": %s, "threads": %s, "batch": %s, "loop": "%s", "status": "%s"' \
+            "$mode" "$size" "$threads" "$batch" "$loop" "$status"
+        [ -s "$rx_json" ] && printf ', "rx": %s' "$(cat "$rx_json")"
+        [ -s "$tx_json" ] && printf ', "tx": %s' "$(cat "$tx_json")"
+        printf '}'
+    } >> "$JSON"
+}
+
+run_cell() {
+    local mode=$1 size=$2 threads=$3 batch=$4 loop=$5
+    local tag=${mode}_${size}_t${threads}_b${batch}
+    [ "$loop" = generic ] && tag=${tag}_generic
+    local rx_json=$OUT_DIR/raw/${tag}_rx.json tx_json=$OUT_DIR/raw/${tag}_tx.json
+    local log=$OUT_DIR/raw/$tag.log
+    local extra=()
+
+    if rx_supports --workers; then
+        [ "$threads" -gt 1 ] && extra+=(--workers "$threads")
+    elif [ "$threads" -ne 1 ]; then
+        echo "  $tag: skipped (receiver has no --workers)"
+        record "$mode" "$size" "$threads" "$batch" "$loop" skipped "" ""
+        return
+    fi
+    rx_supports "--batch" && extra+=(--batch "$batch")
+    [ "$loop" = generic ] && extra+=(--generic-loop)
+
+    echo "  $tag"
+    if [ "$mode" = pcap ]; then
+        local file
+        file=$(make_pcap "$size")
+        "$RX_BIN" --mode pcap --file "$file" --loop "$PCAP_LOOPS" --json "$rx_json" \
+            "${extra[@]}" > "$log" 2>&1
+    else
+        "$RX_BIN" --mode "$mode" -i "$VETH_RX" --probe --duration $((DURATION + 2)) \
+            --json "$rx_json" "${extra[@]}" > "$log" 2>&1 &
+        local rx_pid=$!
+        sleep 1
+        "$TX_BIN" --mode "$TX_MODE" -i "$VETH_TX" --size "$size" --flows "$FLOWS" \
+            --rate "$RATE" --batch "$batch" --duration "$DURATION" --json "$tx_json" >> "$log" 2>&1
+        wait $rx_pid
+    fi
+
+    if [ -s "$rx_json" ] && { [ "$mode" = pcap ] || [ -s "$tx_json" ]; }; then
+        record "$mode" "$size" "$threads" "$batch" "$loop" ok "$rx_json" "$tx_json"
+    else
+        echo "    failed, see $log"
+        record "$mode" "$size" "$threads" "$batch" "$loop" failed "" ""
+    fi
+}
+
+echo "Benchmark matrix -> $OUT_DIR"
+for mode in $MODES; do
+    if reason=$(mode_unavailable "$mode"); then
+        echo "Skipping $mode: $reason"
+        continue
+    fi
+    echo "Mode $mode"
+    for size in $SIZES; do
+        for threads in $THREADS; do
+            for batch in $BATCHES; do
+                for loop in $LOOPS; do
+                    # Workers have their own loop; older receivers lack --generic-loop
+                    if [ "$loop" = generic ] && { [ "$threads" -gt 1 ] || ! rx_supports --generic-loop; }; then
+                        continue
+                    fi
+                    run_cell "$mode" "$size" "$threads" "$batch" "$loop"
+                done
+            done
+        done
+    done
+done
+
+printf "\n]\n" >> "$JSON"
+
+{
+    echo "Packet Datapath benchmark $(date -Iseconds) on $(uname -r), $(nproc) CPUs"
+    echo "veth $VETH_TX -> $VETH_RX, sender: $TX_MODE, rate: $RATE, flows: $FLOWS, ${DURATION}s per run"
+    echo
+    awk -F, '{ printf "%-8s %6s %8s %6s %14s %14s %10s %10s %11s %11s %-8s %s\n",
+               $1, $2, $3, $4, $5, $6, $7, $8, $9, $10, $11, $12 }' "$CSV"
+    # Specialized vs generic receive loop for every cell that ran both
+    awk -F, '
+        FNR == 1 || $11 != "ok" { next }
+        { key = $1 "," $2 "," $3 "," $4; pps[key, $12] = $6; keys[key] = 1 }
+        END {
+            for (key in keys) {
+                if (!((key, "specialized") in pps) || !((key, "generic") in pps)) continue
+                if (!header++) printf "\nReceive loop: specialized vs generic\n"
+                split(key, k, ",")
+                s = pps[key, "specialized"]; g = pps[key, "generic"]
+                printf "%-8s %6s t%-3s b%-5s %14.0f vs %14.0f pps %+8.2f%%\n",
+                       k[1], k[2], k[3], k[4], s, g, (g > 0 ? (s - g) * 100 / g : 0)
+            }
+        }' "$CSV"
+} > "$SUMMARY"
+echo
+cat "$SUMMARY"
@@ -0,0 +1,26 @@
+#!/bin/bash
+# Helpers shared by the benchmark scripts; sourced, not run.
+#
+# mode_unavailable reads RX_BIN, plus two optional reasons set by the caller:
+#   PCAP_UNAVAILABLE  why pcap replay cannot be used (empty: it can)
+#   DPDK_UNAVAILABLE  why DPDK receive cannot be used (empty: it can)
+
+# Numeric field from a flat JSON object
+json_num() {
+    sed -n "s/.*\"$2\": *\([-0-9.e+]*\).*/\1/p" "$1" 2>/dev/null | head -n 1
+}
+
+# Returns non-zero (and a reason on stdout) if a mode cannot run here
+mode_unavailable() {
+    case $1 in
+        socket) return 1 ;;
+        af_xdp) ldd "$RX_BIN" | grep -q libxdp && return 1
+                echo "binary built without libxdp" ;;
+        pcap) [ -z "${PCAP_UNAVAILABLE:-}" ] && return 1
+              echo "$PCAP_UNAVAILABLE" ;;
+        dpdk) [ -z "${DPDK_UNAVAILABLE:-}" ] && return 1
+              echo "$DPDK_UNAVAILABLE" ;;
+        *) echo "unknown mode" ;;
+    esac
+    return 0
+}
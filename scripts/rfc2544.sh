@@ -0,0 +1,173 @@
+#!/bin/bash
+# RFC 2544-style throughput test: for each receive mode and frame size, binary-search
+# the highest offered rate that packet_sender can pace with loss at or below LOSS_PCT,
+# and report the latency measured at that rate.
+#
+# Loss is counted from probe sequence numbers (sent - received by the probe stage),
+# so packets dropped anywhere between the sender and the receive loop count.
+#
+# Environment overrides:
+#   MODES="socket af_xdp"  SIZES="64 128 256 512 1024 1280 1518"
+#   TRIAL_SEC=10 (RFC 2544 uses 60)  LOSS_PCT=0  RESOLUTION=1 (% of the start rate)
+#   MAX_RATE=0 (pps upper bound, 0 = measure with an unpaced trial)  FLOWS=64
+#   TX_MODE=socket  TX_IF/RX_IF (existing ports, e.g. a loopback cable; default: a veth pair)
+#   RX_ADDRESS (PCI address for DPDK receive)  OUT_DIR=bench_results/rfc2544-<timestamp>
+set -u
+
+ROOT=$(cd "$(dirname "$0")/.." && pwd)
+. "$ROOT/scripts/lib.sh"
+RX_BIN=$ROOT/bin/packet_receiver
+TX_BIN=$ROOT/bin/packet_sender
+
+MODES=${MODES:-"socket af_xdp"}
+SIZES=${SIZES:-"64 128 256 512 1024 1280 1518"}
+TRIAL_SEC=${TRIAL_SEC:-10}
+LOSS_PCT=${LOSS_PCT:-0}
+RESOLUTION=${RESOLUTION:-1}
+MAX_RATE=${MAX_RATE:-0}
+FLOWS=${FLOWS:-64}
+TX_MODE=${TX_MODE:-socket}
+RX_ADDRESS=${RX_ADDRESS:-}
+OUT_DIR=${OUT_DIR:-$ROOT/bench_results/rfc2544-$(date +%Y%m%d-%H%M%S)}
+
+if [ "$(id -u)" -ne 0 ]; then
+    echo "Error: the test needs root (veth setup, raw sockets, XDP)" >&2
+    exit 1
+fi
+if [ ! -x "$RX_BIN" ] || [ ! -x "$TX_BIN" ]; then
+    echo "Error: build first (make all, or make socket without libxdp/DPDK)" >&2
+    exit 1
+fi
+
+if [ -z "${TX_IF:-}" ]; then
+    TX_IF=pdrfc0
+    RX_IF=pdrfc1
+    trap 'ip link del "$TX_IF" 2>/dev/null' EXIT
+    ip link del "$TX_IF" 2>/dev/null
+    if ! ip link add "$TX_IF" type veth peer name "$RX_IF"; then
+        echo "Error: failed to create veth pair $TX_IF/$RX_IF" >&2
+        exit 1
+    fi
+    for dev in "$TX_IF" "$RX_IF"; do
+        sysctl -qw "net.ipv6.conf.$dev.disable_ipv6=1" 2>/dev/null
+        ip link set "$dev" up
+    done
+    sleep 1
+fi
+RX_IF=${RX_IF:-$TX_IF}
+
+mkdir -p "$OUT_DIR/raw"
+CSV=$OUT_DIR/results.csv
+TRIALS=$OUT_DIR/trials.csv
+SUMMARY=$OUT_DIR/summary.txt
+
+PCAP_UNAVAILABLE="replay has no offered rate"
+DPDK_UNAVAILABLE=
+[ -n "$RX_ADDRESS" ] || DPDK_UNAVAILABLE="set RX_ADDRESS to the PCI address of a DPDK-bound port"
+
+# Run one trial; sets T_TX_PPS T_SENT T_RECV T_LOSS T_REORDER T_P50 T_P99 T_MAX (latencies in us)
+trial() {
+    local mode=$1 size=$2 rate=$3
+    local tag=${mode}_${size}_${rate}
+    local rx_json=$OUT_DIR/raw/${tag}_rx.json tx_json=$OUT_DIR/raw/${tag}_tx.json
+    local log=$OUT_DIR/raw/$tag.log
+    local rx_args=(--mode "$mode" -i "$RX_IF")
+
+    [ "$mode" = dpdk ] && rx_args+=(-a "$RX_ADDRESS")
+    rm -f "$rx_json" "$tx_json"
+
+    # The receiver starts first and outlives the sender so in-flight packets are counted
+    "$RX_BIN" "${rx_args[@]}" --probe --duration $((TRIAL_SEC + 2)) --json "$rx_json" > "$log" 2>&1 &
+    local rx_pid=$!
+    sleep 1
+    "$TX_BIN" --mode "$TX_MODE" -i "$TX_IF" --size "$size" --flows "$FLOWS" --rate "$rate" \
+        --duration "$TRIAL_SEC" --json "$tx_json" >> "$log" 2>&1
+    wait $rx_pid
+
+    if [ ! -s "$rx_json" ] || [ ! -s "$tx_json" ]; then
+        echo "    trial failed, see $log" >&2
+        return 1
+    fi
+    T_TX_PPS=$(json_num "$tx_json" tx_pps)
+    T_SENT=$(json_num "$tx_json" tx_packets)
+    T_RECV=$(json_num "$rx_json" probe_packets)
+    T_REORDER=$(json_num "$rx_json" probe_reordered)
+    T_LOSS=$(awk -v t="$T_SENT" -v r="${T_RECV:-0}" \
+        'BEGIN { l = t - r; if (l < 0) l = 0; printf "%.4f", (t > 0 ? l * 100 / t : 100) }')
+    T_P50=$(awk -v v="$(json_num "$rx_json" lat_p50_ns)" 'BEGIN { printf "%.2f", v / 1000 }')
+    T_P99=$(awk -v v="$(json_num "$rx_json" lat_p99_ns)" 'BEGIN { printf "%.2f", v / 1000 }')
+    T_MAX=$(awk -v v="$(json_num "$rx_json" lat_max_ns)" 'BEGIN { printf "%.2f", v / 1000 }')
+    echo "$mode,$size,$rate,$T_TX_PPS,$T_SENT,$T_RECV,$T_LOSS,$T_REORDER,$T_P50,$T_P99,$T_MAX" >> "$TRIALS"
+    printf "    %12s pps offered, %12.0f sent: loss %s%%, reordered %s\n" \
+        "$rate" "$T_TX_PPS" "$T_LOSS" "$T_REORDER"
+    sleep 1    # let queues drain between trials
+}
+
+passed() {
+    awk -v l="$T_LOSS" -v max="$LOSS_PCT" 'BEGIN { exit !(l <= max) }'
+}
+
+search() {
+    local mode=$1 size=$2
+    local hi lo=0 best=0 best_lat="" trials=0 step
+
+    # Upper bound: the rate the sender reaches unpaced, unless given
+    if [ "$MAX_RATE" -gt 0 ]; then
+        hi=$MAX_RATE
+    else
+        trial "$mode" "$size" 0 || return 1
+        trials=$((trials + 1))
+        hi=$(printf "%.0f" "$T_TX_PPS")
+    fi
+    step=$(( hi * RESOLUTION / 100 ))
+    [ "$step" -lt 1 ] && step=1
+
+    # Try the top of the range first: a fast receiver passes at line rate in one trial
+    local rate=$hi
+    while :; do
+        trial "$mode" "$size" "$rate" || return 1
+        trials=$((trials + 1))
+        if passed; then
+            lo=$rate
+            best=$rate
+            best_lat="$T_P50,$T_P99,$T_MAX,$T_REORDER"
+        else
+            hi=$rate
+        fi
+        [ $((hi - lo)) -le "$step" ] && break
+        rate=$(( (lo + hi) / 2 ))
+    done
+
+    local mbps
+    mbps=$(awk -v p="$best" -v s="$size" 'BEGIN { printf "%.2f", p * s * 8 / 1e6 }')
+    [ -n "$best_lat" ] || best_lat=",,,"
+    echo "$mode,$size,$best,$mbps,$best_lat,$trials" >> "$CSV"
+    echo "  => $mode $size B: $best pps ($mbps Mbit/s) at <= $LOSS_PCT% loss"
+}
+
+echo "mode,size,offered_pps,tx_pps,sent,received,loss_pct,reordered,lat_p50_us,lat_p99_us,lat_max_us" > "$TRIALS"
+echo "mode,size,throughput_pps,throughput_mbps,lat_p50_us,lat_p99_us,lat_max_us,reordered,trials" > "$CSV"
+
+echo "RFC 2544 throughput: $TX_IF -> $RX_IF, ${TRIAL_SEC}s trials, loss <= $LOSS_PCT% -> $OUT_DIR"
+for mode in $MODES; do
+    if reason=$(mode_unavailable "$mode"); then
+        echo "Skipping $mode: $reason"
+        continue
+    fi
+    for size in $SIZES; do
+        echo "$mode, $size-byte frames"
+        search "$mode" "$size" || echo "$mode,$size,,,,,,,failed" >> "$CSV"
+    done
+done
+
+{
+    echo "RFC 2544 throughput $(date -Iseconds) on $(uname -r), $(nproc) CPUs"
+    echo "$TX_IF -> $RX_IF, sender: $TX_MODE, flows: $FLOWS, ${TRIAL_SEC}s trials," \
+         "loss <= $LOSS_PCT%, resolution $RESOLUTION%"
+    echo "Throughput counts frames incl. FCS; latency is measured at the throughput rate"
+    echo
+    awk -F, '{ printf "%-8s %6s %14s %16s %11s %11s %11s %10s %7s\n",
+               $1, $2, $3, $4, $5, $6, $7, $8, $9 }' "$CSV"
+} > "$SUMMARY"
+echo
+cat "$SUMMARY"
@@ -0,0 +1,29 @@
+#!/bin/bash
+# Send probe traffic with packet_sender and measure it with packet_receiver.
+# Everything can be overridden from the environment, e.g.
+#   TX_IF=veth0 RX_IF=veth1 RATE=1M SIZE=64:7,576:4,1500:1 ./scripts/run_traffic_test.sh
+TX_IF=${TX_IF:-ens192}
+RX_IF=${RX_IF:-$TX_IF}
+TX_MODE=${TX_MODE:-socket}
+RX_MODE=${RX_MODE:-socket}
+DEST_IP=${DEST_IP:-192.168.1.200}
+DEST_MAC=${DEST_MAC:-ff:ff:ff:ff:ff:ff}
+COUNT=${COUNT:-0}
+SIZE=${SIZE:-64}
+RATE=${RATE:-100k}
+FLOWS=${FLOWS:-1}
+DURATION=${DURATION:-10}
+
+BIN_DIR="$(dirname "$0")/../bin"
+
+# Receiver runs a little longer than the sender so in-flight packets are counted
+"$BIN_DIR/packet_receiver" --mode "$RX_MODE" --interface "$RX_IF" --probe \
+    --duration $((DURATION + 2)) &
+RX_PID=$!
+sleep 1
+
+"$BIN_DIR/packet_sender" --mode "$TX_MODE" --interface "$TX_IF" --dst-ip "$DEST_IP" \
+    --dst-mac "$DEST_MAC" --size "$SIZE" --rate "$RATE" --flows "$FLOWS" \
+    --count "$COUNT" --duration "$DURATION"
+
+wait $RX_PID
@@ -4,6 +4,7 @@
 #include <string.h>
 #include <unistd.h>
 #include <poll.h>
+#include <sys/socket.h>
 #include <sys/mman.h>
 // #include <bpf/xsk.h>
 #include <xdp/xsk.h>
@@ -13,14 +14,20 @@
 #include <net/if.h>
 #include "../../include/common.h"
 #include "../../include/packet_receiver.h"
-
-#define NUM_FRAMES 4096
+#include "../../include/forward.h"
+#include "../../include/hugemem.h"
+#include "../../include/rx_loop.h"
+
+// Defaults for --frames, --ring-size and --batch
+#define DEFAULT_NUM_FRAMES 4096
+#define DEFAULT_RING_SIZE XSK_RING_CONS__DEFAULT_NUM_DESCS
+#define DEFAULT_BATCH_SIZE 64
 #define FRAME_SIZE XSK_UMEM__DEFAULT_FRAME_SIZE
-#define BATCH_SIZE 64
 
 #define XDP_PROG_NAME "obj/af_xdp/xdp_kern.o"
 
 #define TEST_QUEUE_INDEX 1 // TODO: support multiple socket and queues
+#define OUT_QUEUE_INDEX 0  // TX-only forwarding socket on the second interface
 
 struct xsk_umem_info {
     struct xsk_ring_prod fq; // Fill Ring
@@ -39,12 +46,25 @@ typedef struct {
     struct xsk_umem_info *umem_info;
     struct xsk_socket_info *xsk_info;
     void *bufs;
+    uint32_t num_frames;
+    uint32_t ring_size;  // RX and TX rings
+    uint32_t fill_size;  // Fill and Completion rings: room for every frame
+    uint32_t batch;      // Descriptors peeked per pass
     
     uint32_t f_idx; // Fill Ring index
     
     struct xdp_program *prog; // XDP program
     struct bpf_object *obj;
     unsigned int attach_mode; // XDP attach mode
+
+    // Forwarding: frames go out on fwd_tx and come back through fwd_cq
+    struct xsk_socket_info *out_info; // Second interface, sharing the UMEM
+    struct xsk_ring_prod out_fq;
+    struct xsk_ring_cons out_cq;
+    struct xsk_socket *fwd_xsk;
+    struct xsk_ring_prod *fwd_tx;
+    struct xsk_ring_cons *fwd_cq;
+    uint32_t tx_outstanding;
 } af_xdp_private_t;
 
 static int load_xdp_program(af_xdp_private_t *priv, const config_t *config) {
@@ -97,6 +117,27 @@ static int af_xdp_init(packet_receiver_t *receiver, const config_t *config) {
 
     int ret;
 
+    priv->num_frames = config->num_frames ? config->num_frames : DEFAULT_NUM_FRAMES;
+    priv->ring_size = config->ring_size ? config->ring_size : DEFAULT_RING_SIZE;
+    priv->batch = config->batch_size ? config->batch_size : DEFAULT_BATCH_SIZE;
+    if (priv->ring_size & (priv->ring_size - 1)) {
+        fprintf(stderr, "Error: AF_XDP ring size must be a power of two: %u\n", priv->ring_size);
+        return -1;
+    }
+    if (priv->num_frames > RX_MAX_FRAMES) {
+        fprintf(stderr, "Error: AF_XDP frame count %u exceeds %u\n", priv->num_frames, RX_MAX_FRAMES);
+        return -1;
+    }
+    // Every frame starts on the Fill Ring, so more frames absorb longer bursts
+    // (num_frames is capped above, so the doubling cannot overflow)
+    priv->fill_size = 64;
+    while (priv->fill_size < priv->num_frames) {
+        priv->fill_size *= 2;
+    }
+    receiver->config.num_frames = priv->num_frames;
+    receiver->config.ring_size = priv->ring_size;
+    receiver->config.batch_size = priv->batch;
+
     // load xdp program
     ret = load_xdp_program(priv, config);
     if (ret) {
@@ -104,8 +145,9 @@ static int af_xdp_init(packet_receiver_t *receiver, const config_t *config) {
     }
     
     // allocate memory
-    ret = posix_memalign(&priv->bufs, getpagesize(), NUM_FRAMES * FRAME_SIZE);
-    if (ret) {
+    // Hugepage-backed UMEM on the NIC's node: fewer TLB misses across the frame pool
+    priv->bufs = hugemem_alloc((size_t)priv->num_frames * FRAME_SIZE, config->numa_node, "AF_XDP UMEM");
+    if (!priv->bufs) {
         fprintf(stderr, "Error: Failed to allocate bufs\n");
         exit(1);
     }
@@ -118,13 +160,13 @@ static int af_xdp_init(packet_receiver_t *receiver, const config_t *config) {
 
     // create UMEM
     struct xsk_umem_config umem_cfg = {
-        .fill_size = XSK_RING_PROD__DEFAULT_NUM_DESCS,
-        .comp_size = XSK_RING_CONS__DEFAULT_NUM_DESCS,
+        .fill_size = priv->fill_size,
+        .comp_size = priv->fill_size,
         .frame_size = FRAME_SIZE,
         .frame_headroom = XSK_UMEM__DEFAULT_FRAME_HEADROOM,
         .flags = 0
     };
-    ret = xsk_umem__create(&priv->umem_info->umem, priv->bufs, NUM_FRAMES * FRAME_SIZE,
+    ret = xsk_umem__create(&priv->umem_info->umem, priv->bufs, (uint64_t)priv->num_frames * FRAME_SIZE,
                            &priv->umem_info->fq, &priv->umem_info->cq, &umem_cfg);
     if (ret) {
         fprintf(stderr, "xsk_umem__create: %s (errno: %d)\n", strerror(-ret), -ret);
@@ -132,11 +174,11 @@ static int af_xdp_init(packet_receiver_t *receiver, const config_t *config) {
     };
 
     // fill memory blocks to Fill Ring
-    ret = xsk_ring_prod__reserve(&priv->umem_info->fq, XSK_RING_PROD__DEFAULT_NUM_DESCS, &priv->f_idx);
-    for (int i = 0; i < XSK_RING_PROD__DEFAULT_NUM_DESCS; i++) {
-        *xsk_ring_prod__fill_addr(&priv->umem_info->fq, priv-> f_idx++) = i * FRAME_SIZE;
+    ret = xsk_ring_prod__reserve(&priv->umem_info->fq, priv->num_frames, &priv->f_idx);
+    for (uint32_t i = 0; i < priv->num_frames; i++) {
+        *xsk_ring_prod__fill_addr(&priv->umem_info->fq, priv-> f_idx++) = (uint64_t)i * FRAME_SIZE;
     }
-    xsk_ring_prod__submit(&priv->umem_info->fq, XSK_RING_PROD__DEFAULT_NUM_DESCS);
+    xsk_ring_prod__submit(&priv->umem_info->fq, priv->num_frames);
 
     // create AF_XDP Socket (XSK)
     priv->xsk_info = calloc(1, sizeof(*priv->xsk_info));
@@ -146,8 +188,8 @@ static int af_xdp_init(packet_receiver_t *receiver, const config_t *config) {
     }
     
     struct xsk_socket_config socket_cfg = {
-        .rx_size = XSK_RING_CONS__DEFAULT_NUM_DESCS,
-        .tx_size = XSK_RING_PROD__DEFAULT_NUM_DESCS,
+        .rx_size = priv->ring_size,
+        .tx_size = priv->ring_size,
         .libbpf_flags = XSK_LIBBPF_FLAGS__INHIBIT_PROG_LOAD, // Load the XDP program manually
         .xdp_flags = XDP_FLAGS_DRV_MODE, // Zero-copy mode -> XDP native mode
         .bind_flags = XDP_USE_NEED_WAKEUP,
@@ -172,10 +214,206 @@ static int af_xdp_init(packet_receiver_t *receiver, const config_t *config) {
         exit(1);
     }
     
-    printf("AF_XDP mode initialized successfully, interface: %s\n", config->interface);
+    if (config->forward) {
+        if (config->out_interface[0]) {
+            priv->out_info = calloc(1, sizeof(*priv->out_info));
+            if (!priv->out_info) {
+                fprintf(stderr, "Error: Failed to allocate xsk_info\n");
+                exit(1);
+            }
+            ret = xsk_socket__create_shared(&priv->out_info->xsk, config->out_interface, OUT_QUEUE_INDEX,
+                                            priv->umem_info->umem, NULL, &priv->out_info->tx,
+                                            &priv->out_fq, &priv->out_cq, &socket_cfg);
+            if (ret) {
+                fprintf(stderr, "xsk_socket__create_shared: %s (errno: %d)\n", strerror(-ret), -ret);
+                exit(1);
+            }
+            priv->fwd_xsk = priv->out_info->xsk;
+            priv->fwd_tx = &priv->out_info->tx;
+            priv->fwd_cq = &priv->out_cq;
+        } else {
+            priv->fwd_xsk = priv->xsk_info->xsk;
+            priv->fwd_tx = &priv->xsk_info->tx;
+            priv->fwd_cq = &priv->umem_info->cq;
+        }
+        printf("Forwarding to %s (zero-copy, shared UMEM)\n",
+               config->out_interface[0] ? config->out_interface : config->interface);
+    }
+
+    printf("AF_XDP mode initialized successfully, interface: %s (%u frames, ring %u, batch %u)\n",
+           config->interface, priv->num_frames, priv->ring_size, priv->batch);
+    return 0;
+}
+
+static inline void kick_tx(af_xdp_private_t *priv) {
+    if (xsk_ring_prod__needs_wakeup(priv->fwd_tx)) {
+        sendto(xsk_socket__fd(priv->fwd_xsk), NULL, 0, MSG_DONTWAIT, NULL, 0);
+    }
+}
+
+// Hand transmitted frames back to the Fill Ring
+static void recycle_completions(af_xdp_private_t *priv) {
+    uint32_t c_idx;
+    unsigned int done = xsk_ring_cons__peek(priv->fwd_cq, priv->num_frames, &c_idx);
+    if (!done) return;
+
+    xsk_ring_prod__reserve(&priv->umem_info->fq, done, &priv->f_idx);
+    for (unsigned int i = 0; i < done; i++) {
+        *xsk_ring_prod__fill_addr(&priv->umem_info->fq, priv->f_idx++) =
+            *xsk_ring_cons__comp_addr(priv->fwd_cq, c_idx + i);
+    }
+    xsk_ring_prod__submit(&priv->umem_info->fq, done);
+    xsk_ring_cons__release(priv->fwd_cq, done);
+    priv->tx_outstanding -= done;
+}
+
+// Reflector loop: each RX descriptor is moved to the TX ring as is, so the
+// packet never leaves its UMEM frame
+static int af_xdp_forward(packet_receiver_t *receiver, af_xdp_private_t *priv) {
+    while (receiver->running) {
+        recycle_completions(priv);
+
+        uint32_t r_idx;
+        unsigned int rcvd = xsk_ring_cons__peek(&priv->xsk_info->rx, priv->batch, &r_idx);
+        if (!rcvd) {
+            if (priv->tx_outstanding) {
+                kick_tx(priv);
+            } else {
+                struct pollfd pfd = { .fd = xsk_socket__fd(priv->xsk_info->xsk), .events = POLLIN };
+                poll(&pfd, 1, 1000);
+            }
+            continue;
+        }
+
+        uint32_t t_idx;
+        bool tx_ok = xsk_ring_prod__reserve(priv->fwd_tx, rcvd, &t_idx) == rcvd;
+        uint64_t bytes = 0;
+
+        for (unsigned int i = 0; i < rcvd; i++) {
+            const struct xdp_desc *desc = xsk_ring_cons__rx_desc(&priv->xsk_info->rx, r_idx + i);
+            unsigned char *pkt = xsk_umem__get_data(priv->bufs, desc->addr);
+
+            bytes += desc->len;
+            if (receiver->stages) {
+                stages_process(receiver->stages, pkt, desc->len);
+            }
+
+            if (tx_ok) {
+                forward_swap_mac(pkt);
+                struct xdp_desc *tx = xsk_ring_prod__tx_desc(priv->fwd_tx, t_idx + i);
+                tx->addr = desc->addr;
+                tx->len = desc->len;
+            }
+        }
+        stats_update_batch(&receiver->stats, rcvd, bytes);
+
+        if (tx_ok) {
+            xsk_ring_prod__submit(priv->fwd_tx, rcvd);
+            priv->tx_outstanding += rcvd;
+            kick_tx(priv);
+            stats_update_forward(&receiver->stats, rcvd, 0);
+        } else {
+            // TX ring full: drop the batch and give the frames straight back to the Fill Ring
+            xsk_ring_prod__reserve(&priv->umem_info->fq, rcvd, &priv->f_idx);
+            for (unsigned int i = 0; i < rcvd; i++) {
+                *xsk_ring_prod__fill_addr(&priv->umem_info->fq, priv->f_idx++) =
+                    xsk_ring_cons__rx_desc(&priv->xsk_info->rx, r_idx + i)->addr;
+            }
+            xsk_ring_prod__submit(&priv->umem_info->fq, rcvd);
+            stats_update_forward(&receiver->stats, 0, rcvd);
+        }
+        xsk_ring_cons__release(&priv->xsk_info->rx, rcvd);
+    }
+    return 0;
+}
+
+// Frames come back from the workers and go straight to the Fill Ring
+static void af_xdp_release(void *ctx, const pipe_desc_t *descs, uint32_t n) {
+    af_xdp_private_t *priv = (af_xdp_private_t *)ctx;
+
+    xsk_ring_prod__reserve(&priv->umem_info->fq, n, &priv->f_idx);
+    for (uint32_t i = 0; i < n; i++) {
+        *xsk_ring_prod__fill_addr(&priv->umem_info->fq, priv->f_idx++) = descs[i].cookie;
+    }
+    xsk_ring_prod__submit(&priv->umem_info->fq, n);
+}
+
+// Pipeline loop: RX descriptors are passed to workers as UMEM pointers and the
+// frames stay out of the Fill Ring until the worker is done with them
+static int af_xdp_pipeline(packet_receiver_t *receiver, af_xdp_private_t *priv) {
+    pipeline_t *pipe = receiver->pipeline;
+    pipeline_attach(pipe, af_xdp_release, priv, &receiver->running);
+
+    while (receiver->running) {
+        uint32_t r_idx;
+        unsigned int rcvd = xsk_ring_cons__peek(&priv->xsk_info->rx, priv->batch, &r_idx);
+
+        if (!rcvd) {
+            // Don't sleep while workers hold frames: the Fill Ring needs them back
+            if (pipeline_outstanding(pipe)) {
+                pipeline_flush(pipe);
+            } else {
+                struct pollfd pfd = { .fd = xsk_socket__fd(priv->xsk_info->xsk), .events = POLLIN };
+                poll(&pfd, 1, 1000);
+            }
+            continue;
+        }
+
+        uint64_t bytes = 0;
+        for (unsigned int i = 0; i < rcvd; i++) {
+            const struct xdp_desc *desc = xsk_ring_cons__rx_desc(&priv->xsk_info->rx, r_idx + i);
+            unsigned char *pkt = xsk_umem__get_data(priv->bufs, desc->addr);
+            bytes += desc->len;
+            pipeline_dispatch(pipe, pkt, desc->len, desc->len, desc->addr);
+        }
+        stats_update_batch(&receiver->stats, rcvd, bytes);
+        xsk_ring_cons__release(&priv->xsk_info->rx, rcvd);
+        pipeline_flush(pipe);
+    }
     return 0;
 }
 
+// Specialized loop body: the feature switches are constants per instance and
+// stats are updated once per batch
+RX_ALWAYS_INLINE int af_xdp_rx_loop(packet_receiver_t *receiver, af_xdp_private_t *priv,
+                                    const bool verbose, const bool stages) {
+    struct xsk_ring_cons *rx = &priv->xsk_info->rx;
+    struct xsk_ring_prod *fq = &priv->umem_info->fq;
+    const uint32_t batch = priv->batch;
+
+    while (receiver->running) {
+        uint32_t r_idx;
+        unsigned int rcvd = xsk_ring_cons__peek(rx, batch, &r_idx);
+
+        if (!rcvd) {
+            struct pollfd pfd = { .fd = xsk_socket__fd(priv->xsk_info->xsk), .events = POLLIN };
+            poll(&pfd, 1, 1000);
+            continue;
+        }
+
+        // Reserve the Fill Ring slots up front so each frame is recycled in the same pass
+        xsk_ring_prod__reserve(fq, rcvd, &priv->f_idx);
+        uint64_t bytes = 0;
+        for (unsigned int i = 0; i < rcvd; i++) {
+            const struct xdp_desc *desc = xsk_ring_cons__rx_desc(rx, r_idx + i);
+            bytes += desc->len;
+            if (stages) {
+                stages_process(receiver->stages, xsk_umem__get_data(priv->bufs, desc->addr), desc->len);
+            }
+            if (verbose) {
+                printf("Packet received: %d bytes (zero-copy)\n", desc->len);
+            }
+            *xsk_ring_prod__fill_addr(fq, priv->f_idx++) = desc->addr;
+        }
+        xsk_ring_cons__release(rx, rcvd);
+        xsk_ring_prod__submit(fq, rcvd);
+        stats_update_batch(&receiver->stats, rcvd, bytes);
+    }
+    return 0;
+}
+
+RX_LOOP_INSTANTIATE(af_xdp_rx, af_xdp_rx_loop, af_xdp_private_t);
+
 static int af_xdp_start(packet_receiver_t *receiver) {
     af_xdp_private_t *priv = (af_xdp_private_t *)receiver->private_data;
     
@@ -183,10 +421,23 @@ static int af_xdp_start(packet_receiver_t *receiver) {
     
     receiver->running = true;
     printf("Starting packet reception (AF_XDP zero-copy mode)...\n");
+
+    if (receiver->config.forward) {
+        return af_xdp_forward(receiver, priv);
+    }
+    if (receiver->pipeline) {
+        return af_xdp_pipeline(receiver, priv);
+    }
+    if (!receiver->config.generic_loop) {
+        unsigned variant = rx_loop_variant(receiver);
+        receiver->stats.rx_loop = rx_loop_name(variant);
+        return af_xdp_rx_variants[variant](receiver, priv);
+    }
+    receiver->stats.rx_loop = "generic";
     
     while (receiver->running) {
         uint32_t r_idx; // Receive Ring index
-        unsigned int rcvd = xsk_ring_cons__peek(&priv->xsk_info->rx, BATCH_SIZE, &r_idx);
+        unsigned int rcvd = xsk_ring_cons__peek(&priv->xsk_info->rx, priv->batch, &r_idx);
 
         if (!rcvd) {
             // If no packets, enter poll to save CPU
@@ -202,9 +453,10 @@ static int af_xdp_start(packet_receiver_t *receiver) {
 
             // receive packet pointer
             unsigned char *pkt = xsk_umem__get_data(priv->bufs, addr);
-            // process packet here
-
             stats_update(&receiver->stats, len);
+            if (receiver->stages) {
+                stages_process(receiver->stages, pkt, len);
+            }
 
             if (receiver->config.verbose) {
                 printf("Packet received: %d bytes (zero-copy)\n", len);
@@ -236,6 +488,11 @@ static void af_xdp_cleanup(packet_receiver_t *receiver) {
 
     
     if (priv) {
+        if (priv->out_info) {
+            xsk_socket__delete(priv->out_info->xsk);
+            free(priv->out_info);
+            priv->out_info = NULL;
+        }
         if (priv->umem_info) {
             xsk_umem__delete(priv->umem_info->umem);
             free(priv->umem_info);
@@ -247,7 +504,7 @@ static void af_xdp_cleanup(packet_receiver_t *receiver) {
             priv->xsk_info = NULL;
         }
         if (priv->bufs) {
-            free(priv->bufs);
+            hugemem_free(priv->bufs);
             priv->bufs = NULL;
         }
         detach_xdp_program(priv, &receiver->config);
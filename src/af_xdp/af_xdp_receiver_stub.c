@@ -1,10 +1,15 @@
-// Stub implementation for AF_XDP receiver when not available
+// Stub implementation for AF_XDP receiver and sender when not available
 #include "../../include/packet_receiver.h"
+#include "../../include/packet_sender.h"
 
 packet_receiver_t* af_xdp_receiver_create(void) {
     return NULL;  // AF_XDP not available
 }
 
+packet_sender_t* af_xdp_sender_create(void) {
+    return NULL;  // AF_XDP not available
+}
+
 
 
 
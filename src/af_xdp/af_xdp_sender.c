@@ -0,0 +1,206 @@
+#define _DEFAULT_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/socket.h>
+#include <xdp/xsk.h>
+#include <xdp/libxdp.h>
+#include <linux/if_link.h>
+#include <net/if.h>
+#include "../../include/common.h"
+#include "../../include/packet_sender.h"
+#include "../../include/hugemem.h"
+
+#define NUM_FRAMES 4096
+#define FRAME_SIZE XSK_UMEM__DEFAULT_FRAME_SIZE
+#define TX_RING_SIZE XSK_RING_PROD__DEFAULT_NUM_DESCS
+
+typedef struct {
+    struct xsk_umem *umem;
+    struct xsk_ring_prod fq;         // Unused for TX, required by the UMEM
+    struct xsk_ring_cons cq;         // Completion Ring
+    struct xsk_socket *xsk;
+    struct xsk_ring_prod tx;         // TX Ring
+    void *bufs;
+
+    uint64_t free_frames[NUM_FRAMES]; // Frames not owned by the kernel
+    uint32_t num_free;
+} af_xdp_sender_private_t;
+
+static int af_xdp_sender_init(packet_sender_t *sender, const sender_config_t *config) {
+    af_xdp_sender_private_t *priv = (af_xdp_sender_private_t *)sender->private_data;
+
+    if (!priv) {
+        priv = calloc(1, sizeof(af_xdp_sender_private_t));
+        if (!priv) return -1;
+        sender->private_data = priv;
+    }
+
+    priv->bufs = hugemem_alloc(NUM_FRAMES * FRAME_SIZE, -1, "AF_XDP UMEM");
+    if (!priv->bufs) {
+        fprintf(stderr, "Error: Failed to allocate bufs\n");
+        return -1;
+    }
+
+    struct xsk_umem_config umem_cfg = {
+        .fill_size = XSK_RING_PROD__DEFAULT_NUM_DESCS,
+        .comp_size = XSK_RING_CONS__DEFAULT_NUM_DESCS,
+        .frame_size = FRAME_SIZE,
+        .frame_headroom = XSK_UMEM__DEFAULT_FRAME_HEADROOM,
+        .flags = 0
+    };
+    int ret = xsk_umem__create(&priv->umem, priv->bufs, NUM_FRAMES * FRAME_SIZE,
+                           &priv->fq, &priv->cq, &umem_cfg);
+    if (ret) {
+        fprintf(stderr, "xsk_umem__create: %s (errno: %d)\n", strerror(-ret), -ret);
+        return -1;
+    }
+
+    // TX only: no RX ring and no XDP program to attach
+    struct xsk_socket_config socket_cfg = {
+        .rx_size = XSK_RING_CONS__DEFAULT_NUM_DESCS,
+        .tx_size = TX_RING_SIZE,
+        .libbpf_flags = XSK_LIBBPF_FLAGS__INHIBIT_PROG_LOAD,
+        .xdp_flags = XDP_FLAGS_DRV_MODE,
+        .bind_flags = XDP_USE_NEED_WAKEUP,
+    };
+    ret = xsk_socket__create(&priv->xsk, config->interface, config->queue, priv->umem,
+                             NULL, &priv->tx, &socket_cfg);
+    if (ret) {
+        fprintf(stderr, "xsk_socket__create: %s (errno: %d)\n", strerror(-ret), -ret);
+        return -1;
+    }
+
+    for (uint32_t i = 0; i < NUM_FRAMES; i++) {
+        priv->free_frames[i] = (uint64_t)i * FRAME_SIZE;
+    }
+    priv->num_free = NUM_FRAMES;
+
+    // A burst larger than the TX ring could never be reserved in one go
+    if (sender->config.batch > TX_RING_SIZE) {
+        sender->config.batch = TX_RING_SIZE;
+    }
+
+    if (!config->src_mac_set &&
+        traffic_interface_mac(config->interface, sender->config.traffic.src_mac) != 0) {
+        fprintf(stderr, "Warning: Could not read the MAC address of %s\n", config->interface);
+    }
+
+    printf("AF_XDP sender initialized successfully, interface: %s, queue: %u\n",
+           config->interface, config->queue);
+    return 0;
+}
+
+// Take back frames the kernel has finished transmitting
+static void reclaim_completions(af_xdp_sender_private_t *priv) {
+    uint32_t idx;
+    uint32_t done = xsk_ring_cons__peek(&priv->cq, NUM_FRAMES, &idx);
+    for (uint32_t i = 0; i < done; i++) {
+        priv->free_frames[priv->num_free++] = *xsk_ring_cons__comp_addr(&priv->cq, idx + i);
+    }
+    if (done) {
+        xsk_ring_cons__release(&priv->cq, done);
+    }
+}
+
+static inline void kick_tx(af_xdp_sender_private_t *priv) {
+    if (xsk_ring_prod__needs_wakeup(&priv->tx)) {
+        sendto(xsk_socket__fd(priv->xsk), NULL, 0, MSG_DONTWAIT, NULL, 0);
+    }
+}
+
+static int af_xdp_sender_start(packet_sender_t *sender) {
+    af_xdp_sender_private_t *priv = (af_xdp_sender_private_t *)sender->private_data;
+    if (!priv || !priv->xsk) return -1;
+
+    sender->running = true;
+    printf("Starting packet transmission (AF_XDP TX ring)...\n");
+
+    while (sender->running) {
+        reclaim_completions(priv);
+        if (priv->num_free == 0) {
+            kick_tx(priv);
+            continue;
+        }
+
+        uint32_t n = sender_next_burst(sender);
+        if (n == 0) break;
+        if (n > priv->num_free) {
+            pacer_refund(&sender->pacer, n - priv->num_free);
+            n = priv->num_free;
+        }
+
+        uint32_t idx;
+        if (xsk_ring_prod__reserve(&priv->tx, n, &idx) != n) {
+            pacer_refund(&sender->pacer, n);
+            sender->stats.tx_retries++;
+            kick_tx(priv);
+            continue;
+        }
+
+        uint64_t now = get_time_ns();
+        for (uint32_t i = 0; i < n; i++) {
+            uint64_t addr = priv->free_frames[--priv->num_free];
+            struct xdp_desc *desc = xsk_ring_prod__tx_desc(&priv->tx, idx + i);
+            desc->addr = addr;
+            desc->len = traffic_gen_build(&sender->gen, xsk_umem__get_data(priv->bufs, addr), now);
+            sender->stats.bytes_sent += desc->len;
+        }
+        xsk_ring_prod__submit(&priv->tx, n);
+        sender->stats.packets_sent += n;
+        kick_tx(priv);
+
+        if (sender->config.verbose) {
+            printf("Burst sent: %u packets\n", n);
+        }
+    }
+
+    // Let queued frames drain before the socket is torn down
+    uint64_t deadline = get_time_ns() + 100000000ULL;
+    while (priv->num_free < NUM_FRAMES && get_time_ns() < deadline) {
+        kick_tx(priv);
+        reclaim_completions(priv);
+    }
+    return 0;
+}
+
+static int af_xdp_sender_stop(packet_sender_t *sender) {
+    if (sender) {
+        sender->running = false;
+    }
+    return 0;
+}
+
+static void af_xdp_sender_cleanup(packet_sender_t *sender) {
+    af_xdp_sender_private_t *priv = (af_xdp_sender_private_t *)sender->private_data;
+
+    if (priv) {
+        if (priv->xsk) {
+            xsk_socket__delete(priv->xsk);
+            priv->xsk = NULL;
+        }
+        if (priv->umem) {
+            xsk_umem__delete(priv->umem);
+            priv->umem = NULL;
+        }
+        hugemem_free(priv->bufs);
+        free(priv);
+        sender->private_data = NULL;
+    }
+}
+
+// Create AF_XDP sender
+packet_sender_t* af_xdp_sender_create(void) {
+    packet_sender_t *sender = calloc(1, sizeof(packet_sender_t));
+    if (!sender) return NULL;
+
+    sender->mode = MODE_AF_XDP;
+    sender->ops.init = af_xdp_sender_init;
+    sender->ops.start = af_xdp_sender_start;
+    sender->ops.stop = af_xdp_sender_stop;
+    sender->ops.cleanup = af_xdp_sender_cleanup;
+
+    return sender;
+}
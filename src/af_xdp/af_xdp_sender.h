@@ -0,0 +1,8 @@
+#ifndef AF_XDP_SENDER_H
+#define AF_XDP_SENDER_H
+
+#include "../../include/packet_sender.h"
+
+packet_sender_t* af_xdp_sender_create(void);
+
+#endif // AF_XDP_SENDER_H
@@ -0,0 +1,771 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include "../../include/common.h"
+#include "../../include/flow.h"
+#include "../../include/rss.h"
+#include "../../include/heavy_hitter.h"
+#include "../../include/reassembly.h"
+#include "../../include/placement.h"
+#include "../../include/hugemem.h"
+#include "../../include/traffic.h"
+
+// In-process microbenchmarks of the receive path's building blocks. Needs no
+// NIC and no root: packets come from the traffic generator and the AF_XDP
+// rings are emulated in memory. Every benchmark is calibrated to --time per
+// repetition, warmed up with one discarded repetition, then run --reps times;
+// the median is reported.
+
+#define BENCH_BURST 32               // Packets per burst, the socket/DPDK default
+#define BENCH_PACKETS 4096           // Distinct frames cycled through (power of two)
+#define BENCH_MAX_RESULTS 64
+#define BENCH_MAX_REPS 101
+#define BENCH_MAX_THREADS 16
+
+// Emulated AF_XDP rings: same layout and index arithmetic as libxdp's
+// xsk_ring_prod / xsk_ring_cons, with the kernel side played by the benchmark
+#define XSK_FRAMES 4096
+#define XSK_RX_RING 2048
+#define XSK_FRAME_SIZE 4096
+
+typedef void (*bench_fn)(void *ctx, uint64_t ops);
+
+typedef struct {
+    char name[48];
+    double ns_per_op;                // Median over the repetitions
+    double min_ns_per_op;
+} bench_result_t;
+
+typedef struct {
+    uint32_t reps;
+    uint64_t rep_ns;
+    uint32_t threads;
+    const char *filter;
+    const char *csv_file;
+    const char *compare_file;
+    double max_slowdown;             // Percent
+    bench_result_t results[BENCH_MAX_RESULTS];
+    uint32_t num_results;
+} bench_opts_t;
+
+static bench_opts_t g_opts;
+static volatile uint64_t g_sink;     // Keeps results observable to the compiler
+
+// ---------------------------------------------------------------------------
+// Runner
+
+static uint64_t time_run(bench_fn fn, void *ctx, uint64_t ops) {
+    uint64_t start = get_time_ns();
+    fn(ctx, ops);
+    return get_time_ns() - start;
+}
+
+static int cmp_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return x < y ? -1 : x > y;
+}
+
+static void bench_run(const char *name, bench_fn fn, void *ctx) {
+    if (g_opts.filter && !strstr(name, g_opts.filter)) return;
+
+    // Calibrate: grow the op count until one run takes a tenth of a repetition
+    uint64_t ops = 1024;
+    uint64_t elapsed;
+    for (;;) {
+        elapsed = time_run(fn, ctx, ops);
+        if (elapsed >= g_opts.rep_ns / 10 || ops >= (1ULL << 40)) break;
+        ops *= 2;
+    }
+    if (elapsed > 0) {
+        ops = (uint64_t)((double)ops * g_opts.rep_ns / elapsed);
+    }
+    if (ops < BENCH_BURST) ops = BENCH_BURST;
+
+    // Warm-up repetition: caches, branch predictors and the CPU clock settle
+    time_run(fn, ctx, ops);
+
+    double samples[BENCH_MAX_REPS];
+    for (uint32_t r = 0; r < g_opts.reps; r++) {
+        samples[r] = (double)time_run(fn, ctx, ops) / ops;
+    }
+    qsort(samples, g_opts.reps, sizeof(double), cmp_double);
+
+    double median = samples[g_opts.reps / 2];
+    printf("%-32s %10.2f ns/op  (min %8.2f)  %14.0f ops/s\n", name, median, samples[0],
+           median > 0 ? 1e9 / median : 0.0);
+    fflush(stdout);
+
+    if (g_opts.num_results < BENCH_MAX_RESULTS) {
+        bench_result_t *res = &g_opts.results[g_opts.num_results++];
+        snprintf(res->name, sizeof(res->name), "%s", name);
+        res->ns_per_op = median;
+        res->min_ns_per_op = samples[0];
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Test packets
+
+// Frames cycled through by the benchmarks, parsed once up front
+typedef struct {
+    uint8_t *buf;
+    pipe_desc_t *descs;
+    pkt_info_t *infos;
+    uint32_t mask;                   // Packet count - 1
+} packet_set_t;
+
+static void packet_set_free(packet_set_t *set) {
+    free(set->buf);
+    free(set->descs);
+    free(set->infos);
+    memset(set, 0, sizeof(*set));
+}
+
+static int packet_set_alloc(packet_set_t *set, uint32_t count, uint32_t frame_size) {
+    memset(set, 0, sizeof(*set));
+    set->buf = calloc(count, frame_size);
+    set->descs = calloc(count, sizeof(pipe_desc_t));
+    set->infos = calloc(count, sizeof(pkt_info_t));
+    if (!set->buf || !set->descs || !set->infos) {
+        packet_set_free(set);
+        return -1;
+    }
+    set->mask = count - 1;
+    return 0;
+}
+
+// 64-byte IPv4/UDP frames from the traffic generator, spread over `flows` flows
+static int packets_udp(packet_set_t *set, uint32_t flows) {
+    traffic_config_t cfg;
+    memset(&cfg, 0, sizeof(cfg));
+    cfg.src_ip = htonl(0x0a000001);
+    cfg.dst_ip = htonl(0x0a000002);
+    cfg.src_port = 1024;
+    cfg.dst_port = 9;
+    cfg.flows = flows;
+    cfg.num_sizes = 1;
+    cfg.sizes[0] = TRAFFIC_MIN_FRAME;
+    cfg.weights[0] = 1;
+
+    traffic_gen_t gen;
+    if (traffic_gen_init(&gen, &cfg) != 0) return -1;
+    if (packet_set_alloc(set, BENCH_PACKETS, TRAFFIC_MAX_FRAME) != 0) {
+        traffic_gen_cleanup(&gen);
+        return -1;
+    }
+    for (uint32_t i = 0; i < BENCH_PACKETS; i++) {
+        uint8_t *pkt = set->buf + (size_t)i * TRAFFIC_MAX_FRAME;
+        set->descs[i].data = pkt;
+        set->descs[i].len = traffic_gen_build(&gen, pkt, 0);
+        set->descs[i].wire_len = set->descs[i].len;
+        flow_parse(pkt, set->descs[i].len, &set->infos[i]);
+    }
+    traffic_gen_cleanup(&gen);
+    return 0;
+}
+
+// Bare TCP ACKs (no payload), one connection per packet modulo `flows`; at
+// least one packet per flow so every flow is visited on each pass
+static int packets_tcp(packet_set_t *set, uint32_t flows) {
+    uint32_t count = BENCH_PACKETS;
+    while (count < flows) {
+        count *= 2;
+    }
+    if (packet_set_alloc(set, count, 64) != 0) return -1;
+
+    for (uint32_t i = 0; i < count; i++) {
+        uint8_t *pkt = set->buf + (size_t)i * 64;
+        uint32_t flow = i % flows;
+        pkt[12] = 0x08;                                  // IPv4
+        uint8_t *ip = pkt + 14;
+        ip[0] = 0x45;
+        ip[3] = 40;                                      // Total length: IP + TCP headers
+        ip[8] = 64;
+        ip[9] = 6;                                       // TCP
+        uint32_t src = htonl(0x0a000000 | (flow >> 16)), dst = htonl(0x0a010001);
+        memcpy(ip + 12, &src, 4);
+        memcpy(ip + 16, &dst, 4);
+        uint8_t *tcp = ip + 20;
+        uint16_t sport = htons((uint16_t)(1024 + (flow & 0xffff))), dport = htons(80);
+        uint32_t seq = htonl(1000);
+        memcpy(tcp, &sport, 2);
+        memcpy(tcp + 2, &dport, 2);
+        memcpy(tcp + 4, &seq, 4);
+        tcp[12] = 0x50;                                  // 20-byte header
+        tcp[13] = 0x10;                                  // ACK
+
+        set->descs[i].data = pkt;
+        set->descs[i].len = 60;
+        set->descs[i].wire_len = 60;
+        flow_parse(pkt, 60, &set->infos[i]);
+    }
+    return 0;
+}
+
+// ---------------------------------------------------------------------------
+// Statistics counters
+
+typedef struct {
+    _Alignas(64) uint64_t packets;
+    uint64_t bytes;
+} local_counters_t;
+
+typedef struct {
+    stats_t stats;
+    _Alignas(64) _Atomic uint64_t packets;
+    _Atomic uint64_t bytes;
+    local_counters_t local[BENCH_MAX_THREADS];
+    bench_fn fn;                     // Body each thread runs in the threaded variants
+    uint32_t threads;
+} counters_ctx_t;
+
+typedef struct {
+    counters_ctx_t *ctx;
+    uint32_t index;
+    uint64_t ops;
+} counters_thread_t;
+
+static _Thread_local uint32_t t_index;
+
+static void bench_stats_update(void *arg, uint64_t ops) {
+    counters_ctx_t *ctx = arg;
+    for (uint64_t i = 0; i < ops; i++) {
+        stats_update(&ctx->stats, 64);
+    }
+}
+
+static void bench_stats_update_batch(void *arg, uint64_t ops) {
+    counters_ctx_t *ctx = arg;
+    for (uint64_t i = 0; i < ops; i += BENCH_BURST) {
+        stats_update_batch(&ctx->stats, BENCH_BURST, BENCH_BURST * 64);
+    }
+}
+
+static void bench_stats_atomic(void *arg, uint64_t ops) {
+    counters_ctx_t *ctx = arg;
+    for (uint64_t i = 0; i < ops; i++) {
+        atomic_fetch_add_explicit(&ctx->packets, 1, memory_order_relaxed);
+        atomic_fetch_add_explicit(&ctx->bytes, 64, memory_order_relaxed);
+    }
+}
+
+// Each thread owns a cache line and the totals are summed when reporting
+static void bench_stats_per_thread(void *arg, uint64_t ops) {
+    counters_ctx_t *ctx = arg;
+    local_counters_t *local = &ctx->local[t_index];
+    for (uint64_t i = 0; i < ops; i++) {
+        // A volatile view stops the compiler from folding the loop into one add
+        ((volatile local_counters_t *)local)->packets++;
+        ((volatile local_counters_t *)local)->bytes += 64;
+    }
+}
+
+static void* counters_thread(void *arg) {
+    counters_thread_t *t = arg;
+    t_index = t->index;
+    t->ctx->fn(t->ctx, t->ops);
+    return NULL;
+}
+
+// All threads hammer the same counters; ops are split between them
+static void bench_threaded(void *arg, uint64_t ops) {
+    counters_ctx_t *ctx = arg;
+    pthread_t threads[BENCH_MAX_THREADS];
+    counters_thread_t args[BENCH_MAX_THREADS];
+
+    for (uint32_t i = 0; i < ctx->threads; i++) {
+        args[i] = (counters_thread_t){ .ctx = ctx, .index = i, .ops = ops / ctx->threads };
+        pthread_create(&threads[i], NULL, counters_thread, &args[i]);
+    }
+    for (uint32_t i = 0; i < ctx->threads; i++) {
+        pthread_join(threads[i], NULL);
+    }
+}
+
+static void run_counters(void) {
+    counters_ctx_t *ctx = aligned_alloc(64, sizeof(counters_ctx_t));
+    if (!ctx) return;
+    memset(ctx, 0, sizeof(*ctx));
+    stats_init(&ctx->stats);
+
+    bench_run("stats/update", bench_stats_update, ctx);
+    bench_run("stats/update_batch", bench_stats_update_batch, ctx);
+    bench_run("stats/atomic", bench_stats_atomic, ctx);
+    bench_run("stats/per_thread", bench_stats_per_thread, ctx);
+
+    if (g_opts.threads > 1) {
+        static const struct { const char *name; bench_fn fn; } variants[] = {
+            { "update", bench_stats_update },
+            { "update_batch", bench_stats_update_batch },
+            { "atomic", bench_stats_atomic },
+            { "per_thread", bench_stats_per_thread },
+        };
+        ctx->threads = g_opts.threads;
+        for (size_t i = 0; i < sizeof(variants) / sizeof(variants[0]); i++) {
+            char name[48];
+            snprintf(name, sizeof(name), "stats/%s_x%u", variants[i].name, g_opts.threads);
+            ctx->fn = variants[i].fn;
+            bench_run(name, bench_threaded, ctx);
+        }
+    }
+
+    g_sink += ctx->stats.packets_received + atomic_load(&ctx->packets) + ctx->local[0].packets;
+    stats_cleanup(&ctx->stats);
+    free(ctx);
+}
+
+// ---------------------------------------------------------------------------
+// AF_XDP RX and Fill rings
+
+typedef struct {
+    uint64_t addr;
+    uint32_t len;
+    uint32_t options;
+} xdp_desc_t;
+
+typedef struct {
+    uint32_t cached_prod;
+    uint32_t cached_cons;
+    uint32_t mask;
+    uint32_t size;
+    uint32_t *producer;
+    uint32_t *consumer;
+    void *ring;
+} xsk_ring_t;
+
+typedef struct {
+    _Alignas(64) uint32_t producer;
+    _Alignas(64) uint32_t consumer;
+} xsk_ptrs_t;
+
+static inline uint32_t xsk_prod_nb_free(xsk_ring_t *r, uint32_t nb) {
+    uint32_t free_entries = r->cached_cons - r->cached_prod;
+    if (free_entries >= nb) return free_entries;
+    r->cached_cons = __atomic_load_n(r->consumer, __ATOMIC_ACQUIRE) + r->size;
+    return r->cached_cons - r->cached_prod;
+}
+
+static inline uint32_t xsk_cons_nb_avail(xsk_ring_t *r, uint32_t nb) {
+    uint32_t entries = r->cached_prod - r->cached_cons;
+    if (entries == 0) {
+        r->cached_prod = __atomic_load_n(r->producer, __ATOMIC_ACQUIRE);
+        entries = r->cached_prod - r->cached_cons;
+    }
+    return entries > nb ? nb : entries;
+}
+
+static inline uint32_t xsk_reserve(xsk_ring_t *r, uint32_t nb, uint32_t *idx) {
+    if (xsk_prod_nb_free(r, nb) < nb) return 0;
+    *idx = r->cached_prod;
+    r->cached_prod += nb;
+    return nb;
+}
+
+static inline void xsk_submit(xsk_ring_t *r, uint32_t nb) {
+    __atomic_store_n(r->producer, *r->producer + nb, __ATOMIC_RELEASE);
+}
+
+static inline uint32_t xsk_peek(xsk_ring_t *r, uint32_t nb, uint32_t *idx) {
+    uint32_t entries = xsk_cons_nb_avail(r, nb);
+    if (entries > 0) {
+        *idx = r->cached_cons;
+        r->cached_cons += entries;
+    }
+    return entries;
+}
+
+static inline void xsk_release(xsk_ring_t *r, uint32_t nb) {
+    __atomic_store_n(r->consumer, *r->consumer + nb, __ATOMIC_RELEASE);
+}
+
+typedef struct {
+    xsk_ptrs_t rx_ptrs;
+    xsk_ptrs_t fq_ptrs;
+    xsk_ring_t rx, fq;               // Application side
+    xsk_ring_t krx, kfq;             // Kernel side of the same rings
+    xdp_desc_t rx_descs[XSK_RX_RING];
+    uint64_t fq_addrs[XSK_FRAMES];
+    uint32_t lens[BENCH_PACKETS];
+    uint32_t next_len;
+    uint32_t f_idx;
+    stats_t stats;
+} xsk_ctx_t;
+
+static void xsk_ring_setup(xsk_ring_t *r, xsk_ptrs_t *ptrs, void *ring, uint32_t size, bool producer) {
+    r->producer = &ptrs->producer;
+    r->consumer = &ptrs->consumer;
+    r->ring = ring;
+    r->size = size;
+    r->mask = size - 1;
+    r->cached_prod = 0;
+    r->cached_cons = producer ? size : 0;
+}
+
+static void xsk_ctx_reset(xsk_ctx_t *x) {
+    memset(&x->rx_ptrs, 0, sizeof(x->rx_ptrs));
+    memset(&x->fq_ptrs, 0, sizeof(x->fq_ptrs));
+    xsk_ring_setup(&x->rx, &x->rx_ptrs, x->rx_descs, XSK_RX_RING, false);
+    xsk_ring_setup(&x->krx, &x->rx_ptrs, x->rx_descs, XSK_RX_RING, true);
+    xsk_ring_setup(&x->fq, &x->fq_ptrs, x->fq_addrs, XSK_FRAMES, true);
+    xsk_ring_setup(&x->kfq, &x->fq_ptrs, x->fq_addrs, XSK_FRAMES, false);
+
+    // Every frame starts on the Fill Ring, as af_xdp_init leaves it
+    uint32_t idx;
+    xsk_reserve(&x->fq, XSK_FRAMES, &idx);
+    for (uint32_t i = 0; i < XSK_FRAMES; i++) {
+        x->fq_addrs[(idx + i) & x->fq.mask] = (uint64_t)i * XSK_FRAME_SIZE;
+    }
+    xsk_submit(&x->fq, XSK_FRAMES);
+}
+
+// The kernel's half: take frames off the Fill Ring and post them as received
+static inline void xsk_kernel_rx(xsk_ctx_t *x, uint32_t n) {
+    uint32_t f = 0, r = 0;
+    n = xsk_peek(&x->kfq, n, &f);
+    if (xsk_reserve(&x->krx, n, &r) != n) {
+        x->kfq.cached_cons -= n;
+        return;
+    }
+    for (uint32_t i = 0; i < n; i++) {
+        xdp_desc_t *desc = &x->rx_descs[(r + i) & x->krx.mask];
+        desc->addr = x->fq_addrs[(f + i) & x->kfq.mask];
+        desc->len = x->lens[x->next_len++ & (BENCH_PACKETS - 1)];
+    }
+    xsk_submit(&x->krx, n);
+    xsk_release(&x->kfq, n);
+}
+
+// Ring traffic alone, frames handed straight back: the floor under both loops
+static void bench_xsk_rings_only(void *arg, uint64_t ops) {
+    xsk_ctx_t *x = arg;
+    for (uint64_t i = 0; i < ops; i += BENCH_BURST) {
+        xsk_kernel_rx(x, BENCH_BURST);
+        uint32_t r = 0, f = 0;
+        uint32_t n = xsk_peek(&x->rx, BENCH_BURST, &r);
+        xsk_reserve(&x->fq, n, &f);
+        for (uint32_t k = 0; k < n; k++) {
+            x->fq_addrs[(f + k) & x->fq.mask] = x->rx_descs[(r + k) & x->rx.mask].addr;
+        }
+        xsk_release(&x->rx, n);
+        xsk_submit(&x->fq, n);
+    }
+}
+
+// The generic loop in af_xdp_start: per-packet stats, then a second pass over
+// the RX descriptors to refill after the RX ring was released
+static void bench_xsk_generic(void *arg, uint64_t ops) {
+    xsk_ctx_t *x = arg;
+    for (uint64_t i = 0; i < ops; i += BENCH_BURST) {
+        xsk_kernel_rx(x, BENCH_BURST);
+
+        uint32_t r_idx = 0;
+        uint32_t rcvd = xsk_peek(&x->rx, BENCH_BURST, &r_idx);
+        for (uint32_t k = 0; k < rcvd; k++) {
+            const xdp_desc_t *desc = &x->rx_descs[(r_idx + k) & x->rx.mask];
+            stats_update(&x->stats, desc->len);
+        }
+        xsk_release(&x->rx, rcvd);
+
+        xsk_reserve(&x->fq, rcvd, &x->f_idx);
+        for (uint32_t k = 0; k < rcvd; k++) {
+            x->fq_addrs[x->f_idx++ & x->fq.mask] = x->rx_descs[(r_idx + k) & x->rx.mask].addr;
+        }
+        xsk_submit(&x->fq, rcvd);
+    }
+}
+
+// The specialized loop: Fill Ring reserved up front, one pass, stats per burst
+static void bench_xsk_specialized(void *arg, uint64_t ops) {
+    xsk_ctx_t *x = arg;
+    for (uint64_t i = 0; i < ops; i += BENCH_BURST) {
+        xsk_kernel_rx(x, BENCH_BURST);
+
+        uint32_t r_idx = 0;
+        uint32_t rcvd = xsk_peek(&x->rx, BENCH_BURST, &r_idx);
+        xsk_reserve(&x->fq, rcvd, &x->f_idx);
+        uint64_t bytes = 0;
+        for (uint32_t k = 0; k < rcvd; k++) {
+            const xdp_desc_t *desc = &x->rx_descs[(r_idx + k) & x->rx.mask];
+            bytes += desc->len;
+            x->fq_addrs[x->f_idx++ & x->fq.mask] = desc->addr;
+        }
+        xsk_release(&x->rx, rcvd);
+        xsk_submit(&x->fq, rcvd);
+        stats_update_batch(&x->stats, rcvd, bytes);
+    }
+}
+
+static void run_xsk(const packet_set_t *udp) {
+    xsk_ctx_t *x = aligned_alloc(64, sizeof(xsk_ctx_t));
+    if (!x) return;
+    memset(x, 0, sizeof(*x));
+    stats_init(&x->stats);
+    for (uint32_t i = 0; i < BENCH_PACKETS; i++) {
+        x->lens[i] = udp->descs[i].len;
+    }
+
+    xsk_ctx_reset(x);
+    bench_run("xsk/rings_only", bench_xsk_rings_only, x);
+    xsk_ctx_reset(x);
+    bench_run("xsk/rx_fill_generic", bench_xsk_generic, x);
+    xsk_ctx_reset(x);
+    bench_run("xsk/rx_fill_specialized", bench_xsk_specialized, x);
+
+    g_sink += x->stats.packets_received;
+    stats_cleanup(&x->stats);
+    free(x);
+}
+
+// ---------------------------------------------------------------------------
+// Header parsing, hashing and flow lookup
+
+typedef struct {
+    const packet_set_t *set;
+    rss_t rss;
+    hh_sketch_t *hh;
+    reasm_t *reasm;
+} packet_ctx_t;
+
+static void bench_flow_parse(void *arg, uint64_t ops) {
+    packet_ctx_t *ctx = arg;
+    pkt_info_t info;
+    uint64_t sum = 0;
+    for (uint64_t i = 0; i < ops; i++) {
+        const pipe_desc_t *d = &ctx->set->descs[i & ctx->set->mask];
+        flow_parse(d->data, d->len, &info);
+        sum += info.payload_len;
+    }
+    g_sink += sum;
+}
+
+static void bench_flow_hash(void *arg, uint64_t ops) {
+    packet_ctx_t *ctx = arg;
+    uint64_t sum = 0;
+    for (uint64_t i = 0; i < ops; i++) {
+        sum += flow_hash(&ctx->set->infos[i & ctx->set->mask].key, 0);
+    }
+    g_sink += sum;
+}
+
+// Per packet, including rss_hash_burst's own tuple parse
+static void bench_rss(void *arg, uint64_t ops) {
+    packet_ctx_t *ctx = arg;
+    uint32_t hashes[BENCH_BURST];
+    uint64_t sum = 0;
+    for (uint64_t i = 0; i < ops; i += BENCH_BURST) {
+        rss_hash_burst(&ctx->rss, &ctx->set->descs[i & ctx->set->mask], BENCH_BURST, hashes);
+        sum += rss_queue(&ctx->rss, hashes[0]);
+    }
+    g_sink += sum;
+}
+
+static void bench_hh_update(void *arg, uint64_t ops) {
+    packet_ctx_t *ctx = arg;
+    for (uint64_t i = 0; i < ops; i++) {
+        uint32_t k = i & ctx->set->mask;
+        hh_sketch_update(ctx->hh, &ctx->set->infos[k], ctx->set->descs[k].len);
+    }
+}
+
+// Bare ACKs of established flows: hash, probe and touch the entry
+static void bench_reasm_lookup(void *arg, uint64_t ops) {
+    packet_ctx_t *ctx = arg;
+    for (uint64_t i = 0; i < ops; i++) {
+        uint32_t k = i & ctx->set->mask;
+        reasm_process(ctx->reasm, &ctx->set->infos[k], ctx->set->descs[k].data);
+    }
+}
+
+static void run_packets(const packet_set_t *udp) {
+    packet_ctx_t ctx;
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.set = udp;
+
+    bench_run("parse/flow_parse_udp", bench_flow_parse, &ctx);
+    bench_run("hash/flow_hash", bench_flow_hash, &ctx);
+
+    rss_init(&ctx.rss, RSS_HASH_TOEPLITZ, 4);
+    bench_run("hash/rss_toeplitz", bench_rss, &ctx);
+    rss_init(&ctx.rss, RSS_HASH_CRC32, 4);
+    char name[48];
+    snprintf(name, sizeof(name), "hash/rss_crc32%s", ctx.rss.use_sse42 ? "" : "_sw");
+    bench_run(name, bench_rss, &ctx);
+
+    ctx.hh = hh_sketch_create(HH_KEY_FLOW, 10, 256);
+    if (ctx.hh) {
+        bench_run("flow/hh_sketch_update", bench_hh_update, &ctx);
+        hh_sketch_destroy(ctx.hh);
+    }
+
+    // A flow table that fits in cache, then one that does not
+    static const uint32_t flow_counts[] = { 1024, 65536 };
+    for (size_t i = 0; i < sizeof(flow_counts) / sizeof(flow_counts[0]); i++) {
+        packet_set_t tcp;
+        if (packets_tcp(&tcp, flow_counts[i]) != 0) continue;
+        ctx.set = &tcp;
+        if (i == 0) {
+            bench_run("parse/flow_parse_tcp", bench_flow_parse, &ctx);
+        }
+
+        // Calibration creates every flow, so the timed runs only look them up
+        ctx.reasm = reasm_create(flow_counts[i], 256, 16, 3600);
+        if (ctx.reasm) {
+            snprintf(name, sizeof(name), "flow/reasm_lookup_%uk", flow_counts[i] / 1024);
+            bench_run(name, bench_reasm_lookup, &ctx);
+            reasm_destroy(ctx.reasm);
+        }
+        packet_set_free(&tcp);
+    }
+    ctx.set = udp;
+}
+
+// ---------------------------------------------------------------------------
+// Baseline comparison
+
+static int write_csv(const char *path) {
+    FILE *f = fopen(path, "w");
+    if (!f) {
+        perror(path);
+        return -1;
+    }
+    fprintf(f, "name,ns_per_op,min_ns_per_op,ops_per_sec\n");
+    for (uint32_t i = 0; i < g_opts.num_results; i++) {
+        const bench_result_t *r = &g_opts.results[i];
+        fprintf(f, "%s,%.3f,%.3f,%.0f\n", r->name, r->ns_per_op, r->min_ns_per_op,
+                r->ns_per_op > 0 ? 1e9 / r->ns_per_op : 0.0);
+    }
+    fclose(f);
+    printf("\nResults written to %s\n", path);
+    return 0;
+}
+
+// Returns the number of benchmarks slower than the baseline by more than --max-slowdown
+static int compare_csv(const char *path) {
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        perror(path);
+        return -1;
+    }
+
+    printf("\n========== Against %s ==========\n", path);
+    char line[256];
+    int regressions = 0;
+    while (fgets(line, sizeof(line), f)) {
+        char name[48];
+        double base;
+        if (sscanf(line, "%47[^,],%lf", name, &base) != 2 || base <= 0) continue;
+        for (uint32_t i = 0; i < g_opts.num_results; i++) {
+            const bench_result_t *r = &g_opts.results[i];
+            if (strcmp(r->name, name) != 0) continue;
+            double delta = (r->ns_per_op - base) * 100.0 / base;
+            bool slower = delta > g_opts.max_slowdown;
+            if (slower) regressions++;
+            printf("%-32s %10.2f -> %10.2f ns/op %+8.2f%% %s\n", name, base, r->ns_per_op, delta,
+                   slower ? "REGRESSION" : "");
+        }
+    }
+    fclose(f);
+    if (regressions) {
+        printf("%d regression(s) beyond %.1f%%\n", regressions, g_opts.max_slowdown);
+    } else {
+        printf("No regressions beyond %.1f%%\n", g_opts.max_slowdown);
+    }
+    return regressions;
+}
+
+// ---------------------------------------------------------------------------
+
+static void usage(const char *prog) {
+    printf("Usage: %s [options]\n", prog);
+    printf("Options:\n");
+    printf("  --filter <text>        Only run benchmarks whose name contains text\n");
+    printf("  --reps <N>             Repetitions per benchmark, median reported (default: 5)\n");
+    printf("  --time <ms>            Target time per repetition (default: 200)\n");
+    printf("  --threads <N>          Also run the counter benchmarks on N threads (default: 2, 1=off)\n");
+    printf("  --cpu <N>              Pin the benchmark thread to CPU N\n");
+    printf("  --csv <file>           Write the results as CSV\n");
+    printf("  --compare <csv>        Compare against an earlier --csv file\n");
+    printf("  --max-slowdown <pct>   Slowdown counted as a regression (default: 10)\n");
+}
+
+int main(int argc, char *argv[]) {
+    g_opts.reps = 5;
+    g_opts.rep_ns = 200 * 1000000ULL;
+    g_opts.threads = 2;
+    g_opts.max_slowdown = 10.0;
+    int cpu = -1;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            g_opts.filter = argv[++i];
+        } else if (strcmp(argv[i], "--reps") == 0 && i + 1 < argc) {
+            g_opts.reps = (uint32_t)atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--time") == 0 && i + 1 < argc) {
+            g_opts.rep_ns = strtoull(argv[++i], NULL, 10) * 1000000ULL;
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            g_opts.threads = (uint32_t)atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--cpu") == 0 && i + 1 < argc) {
+            cpu = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--csv") == 0 && i + 1 < argc) {
+            g_opts.csv_file = argv[++i];
+        } else if (strcmp(argv[i], "--compare") == 0 && i + 1 < argc) {
+            g_opts.compare_file = argv[++i];
+        } else if (strcmp(argv[i], "--max-slowdown") == 0 && i + 1 < argc) {
+            g_opts.max_slowdown = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--help") == 0 || strcmp(argv[i], "-h") == 0) {
+            usage(argv[0]);
+            return 0;
+        } else {
+            fprintf(stderr, "Error: Unknown option %s\n", argv[i]);
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (g_opts.reps == 0 || g_opts.reps > BENCH_MAX_REPS || g_opts.rep_ns == 0) {
+        fprintf(stderr, "Error: --reps must be 1-%d and --time positive\n", BENCH_MAX_REPS);
+        return 1;
+    }
+    if (g_opts.threads == 0 || g_opts.threads > BENCH_MAX_THREADS) {
+        fprintf(stderr, "Error: --threads must be 1-%d\n", BENCH_MAX_THREADS);
+        return 1;
+    }
+    if (cpu >= 0 && placement_pin_thread(pthread_self(), cpu, "Benchmark thread", -1) != 0) {
+        return 1;
+    }
+
+    // Keep the reassembly pools and sketches on regular pages, as --no-hugepages
+    // does: hugepage availability should not move the numbers between runs
+    hugemem_configure(false);
+
+    packet_set_t udp;
+    if (packets_udp(&udp, 1024) != 0) {
+        fprintf(stderr, "Error: Failed to build test packets\n");
+        return 1;
+    }
+
+    printf("Microbenchmarks: %u repetitions of %lu ms, median reported, burst %d, %ld CPU(s) online\n\n",
+           g_opts.reps, g_opts.rep_ns / 1000000, BENCH_BURST, sysconf(_SC_NPROCESSORS_ONLN));
+    fflush(stdout);
+    run_counters();
+    run_xsk(&udp);
+    run_packets(&udp);
+    packet_set_free(&udp);
+
+    if (g_opts.num_results == 0) {
+        fprintf(stderr, "Error: No benchmark matches %s\n", g_opts.filter ? g_opts.filter : "");
+        return 1;
+    }
+    if (g_opts.csv_file && write_csv(g_opts.csv_file) != 0) return 1;
+    if (g_opts.compare_file) {
+        int regressions = compare_csv(g_opts.compare_file);
+        if (regressions != 0) return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,299 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <time.h>
+#include "../../include/common.h"
+#include "../../include/capture.h"
+#include "../../include/hugemem.h"
+
+#define PCAP_MAGIC_NSEC 0xa1b23c4d
+#define PCAP_LINKTYPE_ETHERNET 1
+#define PCAPNG_SHB 0x0A0D0D0A
+#define PCAPNG_IDB 0x00000001
+#define PCAPNG_EPB 0x00000006
+#define PCAPNG_BYTE_ORDER_MAGIC 0x1A2B3C4D
+
+static inline uint8_t* buf_ptr(const capture_t *cap, uint32_t idx) {
+    return cap->mem + (size_t)idx * CAPTURE_BUF_SIZE;
+}
+
+static inline void put32(uint8_t *p, uint32_t v) {
+    memcpy(p, &v, sizeof(v));
+}
+
+static inline void put16(uint8_t *p, uint16_t v) {
+    memcpy(p, &v, sizeof(v));
+}
+
+static uint32_t write_file_header(capture_t *cap, uint8_t *p) {
+    if (!cap->pcapng) {
+        put32(p, PCAP_MAGIC_NSEC);
+        put16(p + 4, 2);                             // Version 2.4
+        put16(p + 6, 4);
+        put32(p + 8, 0);                             // thiszone
+        put32(p + 12, 0);                            // sigfigs
+        put32(p + 16, cap->snaplen);
+        put32(p + 20, PCAP_LINKTYPE_ETHERNET);
+        return 24;
+    }
+
+    // Section header block
+    put32(p, PCAPNG_SHB);
+    put32(p + 4, 28);
+    put32(p + 8, PCAPNG_BYTE_ORDER_MAGIC);
+    put16(p + 12, 1);
+    put16(p + 14, 0);
+    put32(p + 16, 0xFFFFFFFF);                       // Section length unknown
+    put32(p + 20, 0xFFFFFFFF);
+    put32(p + 24, 28);
+
+    // Interface description block with if_tsresol = 9 (nanoseconds)
+    uint8_t *idb = p + 28;
+    put32(idb, PCAPNG_IDB);
+    put32(idb + 4, 32);
+    put16(idb + 8, PCAP_LINKTYPE_ETHERNET);
+    put16(idb + 10, 0);
+    put32(idb + 12, cap->snaplen);
+    put16(idb + 16, 9);                              // if_tsresol
+    put16(idb + 18, 1);
+    put32(idb + 20, 9);
+    put32(idb + 24, 0);                              // opt_endofopt
+    put32(idb + 28, 32);
+    return 28 + 32;
+}
+
+// A failed or short write leaves the file at an unknown offset, and every
+// later record would land misaligned; stop writing altogether instead
+static void write_all(capture_t *cap, const uint8_t *data, uint32_t len) {
+    if (atomic_load_explicit(&cap->failed, memory_order_relaxed)) return;
+
+    while (len > 0) {
+        ssize_t n = write(cap->fd, data, len);
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && errno == EINVAL && cap->direct) {
+            // Filesystem rejects direct I/O at write time; fall back to buffered writes
+            fcntl(cap->fd, F_SETFL, fcntl(cap->fd, F_GETFL) & ~O_DIRECT);
+            cap->direct = false;
+            continue;
+        }
+        if (n <= 0) {
+            cap->write_errors++;
+            fprintf(stderr, "Error: Capture write failed: %s; capture disabled\n",
+                    n < 0 ? strerror(errno) : "no progress");
+            atomic_store_explicit(&cap->failed, true, memory_order_relaxed);
+            return;
+        }
+        data += n;
+        len -= (uint32_t)n;
+        cap->file_bytes += (uint64_t)n;
+    }
+}
+
+static void* writer_thread(void *arg) {
+    capture_t *cap = (capture_t *)arg;
+
+    for (;;) {
+        pthread_mutex_lock(&cap->lock);
+        while (cap->full_count == 0 && !cap->stopping) {
+            pthread_cond_wait(&cap->cond, &cap->lock);
+        }
+        if (cap->full_count == 0) {
+            pthread_mutex_unlock(&cap->lock);
+            break;
+        }
+        uint32_t idx = cap->full_q[cap->full_head];
+        cap->full_head = (cap->full_head + 1) % CAPTURE_NUM_BUFS;
+        cap->full_count--;
+        pthread_mutex_unlock(&cap->lock);
+
+        write_all(cap, buf_ptr(cap, idx), cap->full_len[idx]);
+
+        pthread_mutex_lock(&cap->lock);
+        uint32_t count = atomic_load(&cap->free_count);
+        cap->free_q[(cap->free_head + count) % CAPTURE_NUM_BUFS] = idx;
+        atomic_store(&cap->free_count, count + 1);
+        pthread_mutex_unlock(&cap->lock);
+    }
+    return NULL;
+}
+
+// Hand the current buffer to the writer and start filling a free one.
+// Only the 4 KB-aligned prefix is flushed; the tail moves to the new buffer.
+static bool switch_buffer(capture_t *cap) {
+    if (atomic_load_explicit(&cap->free_count, memory_order_acquire) == 0) return false;
+
+    pthread_mutex_lock(&cap->lock);
+    uint32_t next = cap->free_q[cap->free_head];
+    cap->free_head = (cap->free_head + 1) % CAPTURE_NUM_BUFS;
+    atomic_store(&cap->free_count, atomic_load(&cap->free_count) - 1);
+
+    uint32_t aligned = cap->used & ~(CAPTURE_ALIGN - 1);
+    uint32_t tail = cap->used - aligned;
+    memcpy(buf_ptr(cap, next), buf_ptr(cap, cap->cur) + aligned, tail);
+
+    cap->full_len[cap->cur] = aligned;
+    cap->full_q[(cap->full_head + cap->full_count) % CAPTURE_NUM_BUFS] = cap->cur;
+    cap->full_count++;
+    pthread_cond_signal(&cap->cond);
+    pthread_mutex_unlock(&cap->lock);
+
+    cap->cur = next;
+    cap->used = tail;
+    return true;
+}
+
+capture_t* capture_open(const char *path, bool pcapng, uint32_t snaplen) {
+    capture_t *cap = calloc(1, sizeof(capture_t));
+    if (!cap) return NULL;
+
+    cap->pcapng = pcapng;
+    cap->snaplen = snaplen;
+    cap->fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_DIRECT, 0644);
+    cap->direct = cap->fd >= 0;
+    if (cap->fd < 0 && errno == EINVAL) {
+        cap->fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    }
+    if (cap->fd < 0) {
+        fprintf(stderr, "Error: Failed to open %s: %s\n", path, strerror(errno));
+        free(cap);
+        return NULL;
+    }
+
+    // Page aligned, which covers the O_DIRECT requirement
+    cap->mem = hugemem_alloc((size_t)CAPTURE_NUM_BUFS * CAPTURE_BUF_SIZE, -1, "Capture buffers");
+    if (!cap->mem) {
+        fprintf(stderr, "Error: Failed to allocate capture buffers\n");
+        close(cap->fd);
+        free(cap);
+        return NULL;
+    }
+
+    pthread_mutex_init(&cap->lock, NULL);
+    pthread_cond_init(&cap->cond, NULL);
+    for (uint32_t i = 1; i < CAPTURE_NUM_BUFS; i++) {
+        cap->free_q[i - 1] = i;
+    }
+    atomic_init(&cap->free_count, CAPTURE_NUM_BUFS - 1);
+    atomic_init(&cap->failed, false);
+    cap->cur = 0;
+    cap->used = write_file_header(cap, buf_ptr(cap, 0));
+
+    if (pthread_create(&cap->writer, NULL, writer_thread, cap) != 0) {
+        fprintf(stderr, "Error: Failed to start capture writer thread\n");
+        close(cap->fd);
+        hugemem_free(cap->mem);
+        free(cap);
+        return NULL;
+    }
+
+    cap->start_ns = get_time_ns();
+    printf("Capturing to %s (%s, snaplen %u, %s)\n", path, pcapng ? "pcapng" : "pcap",
+           snaplen, cap->direct ? "O_DIRECT" : "buffered");
+    return cap;
+}
+
+void capture_packet(capture_t *cap, const uint8_t *data, uint32_t len) {
+    uint32_t caplen = len < cap->snaplen ? len : cap->snaplen;
+    uint32_t padded = (caplen + 3) & ~3u;
+    uint32_t rec_len = cap->pcapng ? 32 + padded : 16 + caplen;
+
+    if (atomic_load_explicit(&cap->failed, memory_order_relaxed)) {
+        cap->skipped++;
+        return;
+    }
+
+    if (cap->used + rec_len > CAPTURE_BUF_SIZE && !switch_buffer(cap)) {
+        // Writer is behind: count the drop instead of stalling the receive loop
+        cap->drops++;
+        return;
+    }
+
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    uint8_t *p = buf_ptr(cap, cap->cur) + cap->used;
+
+    if (cap->pcapng) {
+        uint64_t t = (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+        put32(p, PCAPNG_EPB);
+        put32(p + 4, rec_len);
+        put32(p + 8, 0);                             // Interface ID
+        put32(p + 12, (uint32_t)(t >> 32));
+        put32(p + 16, (uint32_t)t);
+        put32(p + 20, caplen);
+        put32(p + 24, len);
+        memcpy(p + 28, data, caplen);
+        memset(p + 28 + caplen, 0, padded - caplen);
+        put32(p + 28 + padded, rec_len);
+    } else {
+        put32(p, (uint32_t)ts.tv_sec);
+        put32(p + 4, (uint32_t)ts.tv_nsec);
+        put32(p + 8, caplen);
+        put32(p + 12, len);
+        memcpy(p + 16, data, caplen);
+    }
+
+    cap->used += rec_len;
+    cap->packets++;
+    cap->bytes += caplen;
+}
+
+void capture_report(const capture_t *cap) {
+    if (!cap) return;
+
+    double secs = (cap->end_ns - cap->start_ns) / 1e9;
+    printf("\n========== Capture ==========\n");
+    printf("Format: %s, snaplen: %u, %s writes\n", cap->pcapng ? "pcapng" : "pcap",
+           cap->snaplen, cap->direct ? "O_DIRECT" : "buffered");
+    printf("Packets captured: %lu (%.2f MB)\n", cap->packets, cap->bytes / (1024.0 * 1024.0));
+    printf("Dropped (writer backpressure): %lu\n", cap->drops);
+    printf("File size: %.2f MB, write rate: %.2f MB/s\n", cap->file_bytes / (1024.0 * 1024.0),
+           secs > 0 ? cap->file_bytes / (1024.0 * 1024.0) / secs : 0.0);
+    if (cap->write_errors) {
+        printf("Write errors: %lu (capture stopped, %lu packets not captured)\n",
+               cap->write_errors, cap->skipped);
+    }
+    printf("=============================\n");
+}
+
+void capture_close(capture_t *cap) {
+    if (!cap || cap->closed) return;
+
+    // Final buffer: pad to the direct I/O block size, trim the file afterwards
+    pthread_mutex_lock(&cap->lock);
+    uint32_t padded = cap->direct ? (cap->used + CAPTURE_ALIGN - 1) & ~(CAPTURE_ALIGN - 1) : cap->used;
+    memset(buf_ptr(cap, cap->cur) + cap->used, 0, padded - cap->used);
+    cap->full_len[cap->cur] = padded;
+    cap->full_q[(cap->full_head + cap->full_count) % CAPTURE_NUM_BUFS] = cap->cur;
+    cap->full_count++;
+    cap->stopping = true;
+    pthread_cond_signal(&cap->cond);
+    pthread_mutex_unlock(&cap->lock);
+
+    pthread_join(cap->writer, NULL);
+    // The padding only reached the file if the final buffer was written
+    if (!atomic_load(&cap->failed) && cap->file_bytes >= padded - cap->used) {
+        cap->file_bytes -= padded - cap->used;
+    }
+    if (ftruncate(cap->fd, (off_t)cap->file_bytes) != 0) {
+        cap->write_errors++;
+    }
+    close(cap->fd);
+    cap->end_ns = get_time_ns();
+    cap->closed = true;
+}
+
+void capture_destroy(capture_t *cap) {
+    if (!cap) return;
+    // Error paths can skip stages_finish; the writer must be gone before its
+    // lock, condition and buffers are released
+    capture_close(cap);
+    pthread_mutex_destroy(&cap->lock);
+    pthread_cond_destroy(&cap->cond);
+    hugemem_free(cap->mem);
+    free(cap);
+}
@@ -0,0 +1,402 @@
+#define _DEFAULT_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <ctype.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <tmmintrin.h>
+#define DPI_HAVE_SHUFTI 1
+#endif
+#include "../../include/dpi.h"
+
+#define DPI_MATCH_FLAG 0x80000000u
+#define DPI_MAX_PATTERN_LEN 1024
+#define DPI_NO_STATE UINT32_MAX
+
+// Decode one pattern line: supports \xHH, \\, \n, \r, \t, \0
+static int decode_pattern(const char *text, uint8_t *out, uint32_t *out_len) {
+    uint32_t n = 0;
+    for (const char *p = text; *p; p++) {
+        if (n >= DPI_MAX_PATTERN_LEN) return -1;
+        if (*p != '\\') {
+            out[n++] = (uint8_t)*p;
+            continue;
+        }
+        p++;
+        switch (*p) {
+            case 'x':
+                if (!isxdigit((unsigned char)p[1]) || !isxdigit((unsigned char)p[2])) return -1;
+                {
+                    char hex[3] = { p[1], p[2], 0 };
+                    out[n++] = (uint8_t)strtoul(hex, NULL, 16);
+                }
+                p += 2;
+                break;
+            case 'n': out[n++] = '\n'; break;
+            case 'r': out[n++] = '\r'; break;
+            case 't': out[n++] = '\t'; break;
+            case '0': out[n++] = 0; break;
+            case '\\': out[n++] = '\\'; break;
+            default: return -1;
+        }
+    }
+    *out_len = n;
+    return 0;
+}
+
+// Build the shufti nibble tables for the start-byte set
+static void build_prefilter(dpi_automaton_t *ac) {
+    int bucket_of[16];
+    int buckets = 0;
+    for (int hi = 0; hi < 16; hi++) {
+        bucket_of[hi] = -1;
+        for (int lo = 0; lo < 16; lo++) {
+            if (ac->start_byte[(hi << 4) | lo]) {
+                // More than 8 distinct high nibbles share buckets; candidates are re-checked
+                bucket_of[hi] = buckets < 8 ? buckets++ : hi % 8;
+                break;
+            }
+        }
+    }
+
+    memset(ac->shufti_lo, 0, sizeof(ac->shufti_lo));
+    memset(ac->shufti_hi, 0, sizeof(ac->shufti_hi));
+    for (int b = 0; b < 256; b++) {
+        if (!ac->start_byte[b]) continue;
+        uint8_t bit = (uint8_t)(1u << bucket_of[b >> 4]);
+        ac->shufti_hi[b >> 4] |= bit;
+        ac->shufti_lo[b & 0x0F] |= bit;
+    }
+
+#ifdef DPI_HAVE_SHUFTI
+    __builtin_cpu_init();
+    ac->use_simd = __builtin_cpu_supports("ssse3");
+#else
+    ac->use_simd = false;
+#endif
+}
+
+static int compile_automaton(dpi_automaton_t *ac, uint8_t **patterns, const uint32_t *lengths) {
+    // Byte classes: every byte used by a pattern gets its own class
+    memset(ac->byte_class, 0, sizeof(ac->byte_class));
+    ac->num_classes = 1;
+    uint64_t max_states = 1;
+    for (uint32_t p = 0; p < ac->num_patterns; p++) {
+        for (uint32_t i = 0; i < lengths[p]; i++) {
+            if (!ac->byte_class[patterns[p][i]]) {
+                ac->byte_class[patterns[p][i]] = (uint16_t)ac->num_classes++;
+            }
+        }
+        max_states += lengths[p];
+    }
+    if (max_states * ac->num_classes >= DPI_MATCH_FLAG) {
+        fprintf(stderr, "Error: Pattern set too large\n");
+        return -1;
+    }
+
+    uint32_t nc = ac->num_classes;
+    uint32_t *trans = calloc(max_states * nc, sizeof(uint32_t));
+    uint32_t *fail = calloc(max_states, sizeof(uint32_t));
+    uint32_t *queue = malloc(max_states * sizeof(uint32_t));
+    ac->out_pattern = malloc(max_states * sizeof(int32_t));
+    ac->out_link = malloc(max_states * sizeof(uint32_t));
+    if (!trans || !fail || !queue || !ac->out_pattern || !ac->out_link) {
+        free(trans);
+        free(fail);
+        free(queue);
+        return -1;
+    }
+    for (uint64_t s = 0; s < max_states; s++) {
+        ac->out_pattern[s] = -1;
+        ac->out_link[s] = DPI_NO_STATE;
+    }
+
+    // Trie (0 = no edge; the root is never a child)
+    ac->num_states = 1;
+    for (uint32_t p = 0; p < ac->num_patterns; p++) {
+        uint32_t s = 0;
+        for (uint32_t i = 0; i < lengths[p]; i++) {
+            uint32_t c = ac->byte_class[patterns[p][i]];
+            if (!trans[s * nc + c]) {
+                trans[s * nc + c] = ac->num_states++;
+            }
+            s = trans[s * nc + c];
+        }
+        if (ac->out_pattern[s] < 0) {
+            ac->out_pattern[s] = (int32_t)p;
+        } else {
+            fprintf(stderr, "Warning: Duplicate pattern '%s' ignored\n", ac->names[p]);
+        }
+    }
+
+    // Breadth-first failure links, turning the trie into a full DFA in place
+    uint32_t head = 0, tail = 0;
+    for (uint32_t c = 0; c < nc; c++) {
+        uint32_t u = trans[c];
+        if (u) {
+            fail[u] = 0;
+            queue[tail++] = u;
+        }
+    }
+    while (head < tail) {
+        uint32_t r = queue[head++];
+        for (uint32_t c = 0; c < nc; c++) {
+            uint32_t u = trans[r * nc + c];
+            if (u) {
+                uint32_t f = trans[fail[r] * nc + c];
+                fail[u] = f;
+                ac->out_link[u] = ac->out_pattern[f] >= 0 ? f : ac->out_link[f];
+                queue[tail++] = u;
+            } else {
+                trans[r * nc + c] = trans[fail[r] * nc + c];
+            }
+        }
+    }
+
+    // Final table holds pre-multiplied state offsets with the output flag folded in
+    ac->delta = malloc((size_t)ac->num_states * nc * sizeof(uint32_t));
+    if (!ac->delta) {
+        free(trans);
+        free(fail);
+        free(queue);
+        return -1;
+    }
+    for (uint32_t s = 0; s < ac->num_states; s++) {
+        for (uint32_t c = 0; c < nc; c++) {
+            uint32_t t = trans[s * nc + c];
+            bool has_output = ac->out_pattern[t] >= 0 || ac->out_link[t] != DPI_NO_STATE;
+            ac->delta[s * nc + c] = t * nc | (has_output ? DPI_MATCH_FLAG : 0);
+        }
+    }
+
+    // Bytes that move the root to another state start a potential match
+    for (int b = 0; b < 256; b++) {
+        ac->start_byte[b] = ac->byte_class[b] && trans[ac->byte_class[b]] != 0;
+    }
+    build_prefilter(ac);
+
+    free(trans);
+    free(fail);
+    free(queue);
+    return 0;
+}
+
+dpi_automaton_t* dpi_automaton_load(const char *path) {
+    FILE *fp = fopen(path, "r");
+    if (!fp) {
+        fprintf(stderr, "Error: Failed to open pattern file %s\n", path);
+        return NULL;
+    }
+
+    dpi_automaton_t *ac = calloc(1, sizeof(dpi_automaton_t));
+    uint8_t **patterns = NULL;
+    uint32_t *lengths = NULL;
+    uint32_t capacity = 0;
+    uint8_t buf[DPI_MAX_PATTERN_LEN];
+    char *line = NULL;
+    size_t line_cap = 0;
+    ssize_t n;
+    int ret = -1;
+    if (!ac) goto out;
+
+    while ((n = getline(&line, &line_cap, fp)) >= 0) {
+        while (n > 0 && (line[n - 1] == '\n' || line[n - 1] == '\r')) line[--n] = 0;
+        if (n == 0 || line[0] == '#') continue;
+
+        uint32_t len;
+        if (decode_pattern(line, buf, &len) != 0 || len == 0) {
+            fprintf(stderr, "Error: Invalid pattern '%s'\n", line);
+            goto out;
+        }
+        if (ac->num_patterns == capacity) {
+            capacity = capacity ? capacity * 2 : 64;
+            uint8_t **np = realloc(patterns, capacity * sizeof(*patterns));
+            if (np) patterns = np;
+            uint32_t *nl = realloc(lengths, capacity * sizeof(*lengths));
+            if (nl) lengths = nl;
+            char **nn = realloc(ac->names, capacity * sizeof(*ac->names));
+            if (nn) ac->names = nn;
+            if (!np || !nl || !nn) goto out;
+        }
+        patterns[ac->num_patterns] = malloc(len);
+        ac->names[ac->num_patterns] = strdup(line);
+        if (!patterns[ac->num_patterns] || !ac->names[ac->num_patterns]) {
+            free(patterns[ac->num_patterns]);
+            free(ac->names[ac->num_patterns]);
+            goto out;
+        }
+        memcpy(patterns[ac->num_patterns], buf, len);
+        lengths[ac->num_patterns] = len;
+        ac->num_patterns++;
+    }
+
+    if (ac->num_patterns == 0) {
+        fprintf(stderr, "Error: No patterns in %s\n", path);
+        goto out;
+    }
+    ret = compile_automaton(ac, patterns, lengths);
+
+out:
+    if (patterns) {
+        for (uint32_t i = 0; i < ac->num_patterns; i++) free(patterns[i]);
+    }
+    free(patterns);
+    free(lengths);
+    free(line);
+    fclose(fp);
+    if (ret != 0) {
+        dpi_automaton_destroy(ac);
+        return NULL;
+    }
+
+    printf("Loaded %u patterns from %s (%u states, %u byte classes, %.1f KB table, %s prefilter)\n",
+           ac->num_patterns, path, ac->num_states, ac->num_classes,
+           (double)ac->num_states * ac->num_classes * sizeof(uint32_t) / 1024.0,
+           ac->use_simd ? "SSSE3" : "scalar");
+    return ac;
+}
+
+void dpi_automaton_destroy(dpi_automaton_t *ac) {
+    if (!ac) return;
+    if (ac->names) {
+        for (uint32_t i = 0; i < ac->num_patterns; i++) free(ac->names[i]);
+        free(ac->names);
+    }
+    free(ac->delta);
+    free(ac->out_pattern);
+    free(ac->out_link);
+    free(ac);
+}
+
+#ifdef DPI_HAVE_SHUFTI
+// Find the next byte that can leave the root state, 16 bytes at a time
+__attribute__((target("ssse3")))
+static uint32_t prefilter_next_simd(const dpi_automaton_t *ac, const uint8_t *data, uint32_t i, uint32_t len) {
+    const __m128i lo_tbl = _mm_loadu_si128((const __m128i *)ac->shufti_lo);
+    const __m128i hi_tbl = _mm_loadu_si128((const __m128i *)ac->shufti_hi);
+    const __m128i nibble = _mm_set1_epi8(0x0F);
+    const __m128i zero = _mm_setzero_si128();
+
+    while (i + 16 <= len) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(data + i));
+        __m128i lo = _mm_shuffle_epi8(lo_tbl, _mm_and_si128(v, nibble));
+        __m128i hi = _mm_shuffle_epi8(hi_tbl, _mm_and_si128(_mm_srli_epi16(v, 4), nibble));
+        uint32_t bits = ~(uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(lo, hi), zero)) & 0xFFFF;
+        while (bits) {
+            uint32_t j = i + (uint32_t)__builtin_ctz(bits);
+            if (ac->start_byte[data[j]]) return j;
+            bits &= bits - 1;
+        }
+        i += 16;
+    }
+    while (i < len && !ac->start_byte[data[i]]) i++;
+    return i;
+}
+#endif
+
+static inline uint32_t prefilter_next(const dpi_automaton_t *ac, const uint8_t *data, uint32_t i, uint32_t len) {
+#ifdef DPI_HAVE_SHUFTI
+    if (ac->use_simd) return prefilter_next_simd(ac, data, i, len);
+#endif
+    while (i < len && !ac->start_byte[data[i]]) i++;
+    return i;
+}
+
+dpi_t* dpi_create(const dpi_automaton_t *ac) {
+    dpi_t *dpi = calloc(1, sizeof(dpi_t));
+    if (!dpi) return NULL;
+
+    dpi->ac = ac;
+    dpi->hits = calloc(ac->num_patterns, sizeof(uint64_t));
+    dpi->packets = calloc(ac->num_patterns, sizeof(uint64_t));
+    dpi->last_seen = calloc(ac->num_patterns, sizeof(uint64_t));
+    if (!dpi->hits || !dpi->packets || !dpi->last_seen) {
+        dpi_destroy(dpi);
+        return NULL;
+    }
+    return dpi;
+}
+
+// Run the automaton over one buffer starting in state s; returns the end state
+static inline uint32_t scan(dpi_t *dpi, uint32_t s, const uint8_t *data, uint32_t len) {
+    const dpi_automaton_t *ac = dpi->ac;
+    const uint32_t *delta = ac->delta;
+    const uint16_t *cls = ac->byte_class;
+    uint64_t seq = ++dpi->packets_scanned;
+    bool matched = false;
+
+    dpi->bytes_scanned += len;
+    for (uint32_t i = 0; i < len; i++) {
+        // In the root state nothing is pending, so jump to the next candidate byte
+        if (s == 0) {
+            i = prefilter_next(ac, data, i, len);
+            if (i >= len) break;
+        }
+
+        uint32_t next = delta[s + cls[data[i]]];
+        if (next & DPI_MATCH_FLAG) {
+            next &= ~DPI_MATCH_FLAG;
+            uint32_t t = next / ac->num_classes;
+            if (ac->out_pattern[t] < 0) t = ac->out_link[t];
+            for (; t != DPI_NO_STATE; t = ac->out_link[t]) {
+                uint32_t p = (uint32_t)ac->out_pattern[t];
+                dpi->hits[p]++;
+                if (dpi->last_seen[p] != seq) {
+                    dpi->last_seen[p] = seq;
+                    dpi->packets[p]++;
+                }
+            }
+            matched = true;
+        }
+        s = next;
+    }
+
+    if (matched) dpi->packets_matched++;
+    return s;
+}
+
+void dpi_scan(dpi_t *dpi, const uint8_t *data, uint32_t len) {
+    scan(dpi, 0, data, len);
+}
+
+// Scan the next chunk of a byte stream: matches spanning chunk boundaries are
+// found because the automaton resumes from *state (0 for a new stream)
+void dpi_scan_stream(dpi_t *dpi, uint32_t *state, const uint8_t *data, uint32_t len) {
+    *state = scan(dpi, *state, data, len);
+}
+
+int dpi_merge(dpi_t *dst, const dpi_t *src) {
+    if (!dst || !src || dst->ac != src->ac) return -1;
+
+    for (uint32_t p = 0; p < dst->ac->num_patterns; p++) {
+        dst->hits[p] += src->hits[p];
+        dst->packets[p] += src->packets[p];
+    }
+    dst->packets_scanned += src->packets_scanned;
+    dst->packets_matched += src->packets_matched;
+    dst->bytes_scanned += src->bytes_scanned;
+    return 0;
+}
+
+void dpi_report(const dpi_t *dpi) {
+    if (!dpi) return;
+
+    printf("\n========== Payload Matching ==========\n");
+    printf("Patterns: %u (%u states)\n", dpi->ac->num_patterns, dpi->ac->num_states);
+    printf("Packets scanned: %lu, matched: %lu\n", dpi->packets_scanned, dpi->packets_matched);
+    printf("Payload bytes scanned: %lu (%.2f MB)\n",
+           dpi->bytes_scanned, dpi->bytes_scanned / (1024.0 * 1024.0));
+    for (uint32_t p = 0; p < dpi->ac->num_patterns; p++) {
+        printf("  %-40s hits: %10lu  packets: %10lu\n", dpi->ac->names[p], dpi->hits[p], dpi->packets[p]);
+    }
+    printf("======================================\n");
+}
+
+void dpi_destroy(dpi_t *dpi) {
+    if (!dpi) return;
+    free(dpi->hits);
+    free(dpi->packets);
+    free(dpi->last_seen);
+    free(dpi);
+}
@@ -0,0 +1,157 @@
+#define _DEFAULT_SOURCE
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <arpa/inet.h>
+#include "../../include/flow.h"
+
+#define ETHERTYPE_IPV4 0x0800
+#define ETHERTYPE_IPV6 0x86DD
+
+#define IPPROTO_NUM_TCP 6
+#define IPPROTO_NUM_UDP 17
+
+static inline uint16_t read_be16(const uint8_t *p) {
+    return (uint16_t)((p[0] << 8) | p[1]);
+}
+
+static inline uint32_t read_be32(const uint8_t *p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+int flow_parse(const uint8_t *data, uint32_t len, pkt_info_t *info) {
+    memset(info, 0, sizeof(*info));
+
+    uint16_t ethertype;
+    uint32_t off = flow_l2_parse(data, len, &ethertype);
+    if (off == 0) return -1;
+
+    info->l3_offset = off;
+    uint32_t l4_off;
+    uint32_t ip_end;
+    bool first_fragment = true;
+
+    if (ethertype == ETHERTYPE_IPV4) {
+        if (len < off + 20) return -1;
+        const uint8_t *ip = data + off;
+        uint32_t ihl = (ip[0] & 0x0F) * 4;
+        if (ihl < 20 || len < off + ihl) return -1;
+
+        info->key.ip_version = 4;
+        info->key.proto = ip[9];
+        memcpy(info->key.src_addr, ip + 12, 4);
+        memcpy(info->key.dst_addr, ip + 16, 4);
+
+        // Non-first fragments carry no L4 header
+        uint16_t frag = read_be16(ip + 6);
+        first_fragment = (frag & 0x1FFF) == 0;
+        info->fragment = (frag & 0x3FFF) != 0;   // MF set or nonzero offset
+        l4_off = off + ihl;
+        ip_end = off + read_be16(ip + 2);
+    } else if (ethertype == ETHERTYPE_IPV6) {
+        if (len < off + 40) return -1;
+        const uint8_t *ip = data + off;
+
+        info->key.ip_version = 6;
+        memcpy(info->key.src_addr, ip + 8, 16);
+        memcpy(info->key.dst_addr, ip + 24, 16);
+        ip_end = off + 40 + read_be16(ip + 4);
+
+        // Skip extension headers (hop-by-hop, routing, fragment, destination options)
+        uint8_t next = ip[6];
+        l4_off = off + 40;
+        while (next == 0 || next == 43 || next == 44 || next == 60) {
+            if (len < l4_off + 8) return -1;
+            if (next == 44) {
+                first_fragment = (read_be16(data + l4_off + 2) & 0xFFF8) == 0;
+                info->fragment = true;
+                next = data[l4_off];
+                l4_off += 8;
+            } else {
+                next = data[l4_off];
+                l4_off += (data[l4_off + 1] + 1) * 8;
+            }
+        }
+        if (l4_off > len) return -1;
+        info->key.proto = next;
+    } else {
+        return -1;
+    }
+
+    if (ip_end > len || ip_end < l4_off) ip_end = len;
+    info->l4_offset = l4_off;
+    info->payload_offset = l4_off;
+
+    if (!first_fragment) {
+        info->payload_len = ip_end - l4_off;
+        return 0;
+    }
+
+    if (info->key.proto == IPPROTO_NUM_TCP) {
+        if (len < l4_off + 20) return -1;
+        const uint8_t *tcp = data + l4_off;
+        uint32_t doff = (tcp[12] >> 4) * 4;
+        if (doff < 20 || l4_off + doff > ip_end) return -1;
+        info->key.src_port = read_be16(tcp);
+        info->key.dst_port = read_be16(tcp + 2);
+        info->tcp_seq = read_be32(tcp + 4);
+        info->tcp_flags = tcp[13];
+        info->payload_offset = l4_off + doff;
+    } else if (info->key.proto == IPPROTO_NUM_UDP) {
+        if (len < l4_off + 8) return -1;
+        const uint8_t *udp = data + l4_off;
+        info->key.src_port = read_be16(udp);
+        info->key.dst_port = read_be16(udp + 2);
+        info->payload_offset = l4_off + 8;
+        if (info->payload_offset > ip_end) return -1;
+    }
+
+    info->payload_len = ip_end - info->payload_offset;
+    return 0;
+}
+
+static inline uint64_t mix64(uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+uint64_t flow_hash(const flow_key_t *key, uint64_t seed) {
+    uint64_t words[sizeof(flow_key_t) / sizeof(uint64_t)];
+    memcpy(words, key, sizeof(words));
+
+    uint64_t h = seed ^ 0x9e3779b97f4a7c15ULL;
+    for (size_t i = 0; i < sizeof(words) / sizeof(words[0]); i++) {
+        h = (h ^ words[i]) * 0x100000001b3ULL;
+        h = (h << 31) | (h >> 33);
+    }
+    return mix64(h);
+}
+
+bool flow_key_equal(const flow_key_t *a, const flow_key_t *b) {
+    return memcmp(a, b, sizeof(flow_key_t)) == 0;
+}
+
+void flow_addr_format(uint8_t ip_version, const uint8_t *addr, char *buf, size_t size) {
+    if (!inet_ntop(ip_version == 6 ? AF_INET6 : AF_INET, addr, buf, size)) {
+        snprintf(buf, size, "?");
+    }
+}
+
+void flow_key_format(const flow_key_t *key, char *buf, size_t size) {
+    char src[INET6_ADDRSTRLEN];
+    char dst[INET6_ADDRSTRLEN];
+    flow_addr_format(key->ip_version, key->src_addr, src, sizeof(src));
+    flow_addr_format(key->ip_version, key->dst_addr, dst, sizeof(dst));
+
+    const char *proto = key->proto == IPPROTO_NUM_TCP ? "tcp" :
+                        key->proto == IPPROTO_NUM_UDP ? "udp" : "ip";
+    if (key->ip_version == 6) {
+        snprintf(buf, size, "[%s]:%u -> [%s]:%u %s", src, key->src_port, dst, key->dst_port, proto);
+    } else {
+        snprintf(buf, size, "%s:%u -> %s:%u %s", src, key->src_port, dst, key->dst_port, proto);
+    }
+}
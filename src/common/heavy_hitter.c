@@ -0,0 +1,306 @@
+#define _DEFAULT_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include <arpa/inet.h>
+#include "../../include/heavy_hitter.h"
+
+#define HH_DEPTH 4
+#define HH_MIN_WIDTH 64
+#define HH_SEED 0x48485f736b657463ULL
+
+// Reduce a parsed flow key to the configured talker key
+static void hh_reduce_key(hh_key_mode_t mode, const flow_key_t *in, flow_key_t *out) {
+    if (mode == HH_KEY_FLOW) {
+        *out = *in;
+        return;
+    }
+    memset(out, 0, sizeof(*out));
+    out->ip_version = in->ip_version;
+    if (mode == HH_KEY_DST) {
+        memcpy(out->dst_addr, in->dst_addr, sizeof(out->dst_addr));
+    } else {
+        memcpy(out->src_addr, in->src_addr, sizeof(out->src_addr));
+    }
+}
+
+static uint64_t hh_estimate(const hh_sketch_t *hh, uint64_t hash) {
+    uint32_t h1 = (uint32_t)hash;
+    uint32_t h2 = (uint32_t)(hash >> 32) | 1;
+    uint64_t est = UINT64_MAX;
+    for (uint32_t d = 0; d < hh->depth; d++) {
+        uint64_t c = hh->counters[(uint64_t)d * hh->width + ((h1 + d * h2) & (hh->width - 1))];
+        if (c < est) est = c;
+    }
+    return est;
+}
+
+// Index helpers: linear probing keyed by hash, value is heap position + 1
+
+static uint32_t index_find(const hh_sketch_t *hh, uint64_t hash, const flow_key_t *key) {
+    uint32_t slot = (uint32_t)hash & hh->index_mask;
+    while (hh->index[slot]) {
+        const hh_entry_t *e = &hh->heap[hh->index[slot] - 1];
+        if (e->hash == hash && flow_key_equal(&e->key, key)) return hh->index[slot] - 1;
+        slot = (slot + 1) & hh->index_mask;
+    }
+    return UINT32_MAX;
+}
+
+static uint32_t index_slot_of(const hh_sketch_t *hh, uint32_t pos) {
+    uint32_t slot = (uint32_t)hh->heap[pos].hash & hh->index_mask;
+    while (hh->index[slot] != pos + 1) {
+        slot = (slot + 1) & hh->index_mask;
+    }
+    return slot;
+}
+
+static void index_insert(hh_sketch_t *hh, uint32_t pos) {
+    uint32_t slot = (uint32_t)hh->heap[pos].hash & hh->index_mask;
+    while (hh->index[slot]) {
+        slot = (slot + 1) & hh->index_mask;
+    }
+    hh->index[slot] = pos + 1;
+}
+
+static void index_remove(hh_sketch_t *hh, uint32_t pos) {
+    uint32_t slot = index_slot_of(hh, pos);
+    uint32_t next = (slot + 1) & hh->index_mask;
+
+    // Backward-shift deletion keeps probe sequences intact without tombstones
+    while (hh->index[next]) {
+        uint32_t ideal = (uint32_t)hh->heap[hh->index[next] - 1].hash & hh->index_mask;
+        if (((next - ideal) & hh->index_mask) >= ((next - slot) & hh->index_mask)) {
+            hh->index[slot] = hh->index[next];
+            slot = next;
+        }
+        next = (next + 1) & hh->index_mask;
+    }
+    hh->index[slot] = 0;
+}
+
+static void heap_swap(hh_sketch_t *hh, uint32_t a, uint32_t b) {
+    uint32_t slot_a = index_slot_of(hh, a);
+    uint32_t slot_b = index_slot_of(hh, b);
+    hh->index[slot_a] = b + 1;
+    hh->index[slot_b] = a + 1;
+
+    hh_entry_t tmp = hh->heap[a];
+    hh->heap[a] = hh->heap[b];
+    hh->heap[b] = tmp;
+}
+
+static void heap_sift_up(hh_sketch_t *hh, uint32_t pos) {
+    while (pos > 0) {
+        uint32_t parent = (pos - 1) / 2;
+        if (hh->heap[parent].estimate <= hh->heap[pos].estimate) break;
+        heap_swap(hh, parent, pos);
+        pos = parent;
+    }
+}
+
+static void heap_sift_down(hh_sketch_t *hh, uint32_t pos) {
+    for (;;) {
+        uint32_t left = 2 * pos + 1;
+        uint32_t right = left + 1;
+        uint32_t smallest = pos;
+        if (left < hh->heap_size && hh->heap[left].estimate < hh->heap[smallest].estimate) smallest = left;
+        if (right < hh->heap_size && hh->heap[right].estimate < hh->heap[smallest].estimate) smallest = right;
+        if (smallest == pos) break;
+        heap_swap(hh, pos, smallest);
+        pos = smallest;
+    }
+}
+
+hh_sketch_t* hh_sketch_create(hh_key_mode_t key_mode, uint32_t k, uint32_t memory_kb) {
+    if (k == 0 || k > HH_MAX_TOPK || memory_kb == 0 || memory_kb > HH_MAX_MEMORY_KB) return NULL;
+
+    // k is capped, so this stays well inside 32 bits
+    uint32_t index_size = 16;
+    while (index_size < 2 * (uint64_t)k) {
+        index_size *= 2;
+    }
+
+    // The budget covers the heap and its index too (hh_report prints the total);
+    // the sketch gets the largest power-of-two width that fits in the rest
+    uint64_t budget = (uint64_t)memory_kb * 1024;
+    uint64_t fixed = (uint64_t)k * sizeof(hh_entry_t) + (uint64_t)index_size * sizeof(uint32_t);
+    uint64_t min_sketch = (uint64_t)HH_MIN_WIDTH * HH_DEPTH * sizeof(uint64_t);
+    if (fixed + min_sketch > budget) {
+        fprintf(stderr, "Error: Heavy hitter memory of %u KB is too small for top-%u (needs %lu KB)\n",
+                memory_kb, k, (fixed + min_sketch + 1023) / 1024);
+        return NULL;
+    }
+    uint64_t width = HH_MIN_WIDTH;
+    while (fixed + width * 2 * HH_DEPTH * sizeof(uint64_t) <= budget) {
+        width *= 2;
+    }
+
+    hh_sketch_t *hh = calloc(1, sizeof(hh_sketch_t));
+    if (!hh) return NULL;
+
+    hh->key_mode = key_mode;
+    hh->depth = HH_DEPTH;
+    hh->width = (uint32_t)width;
+    hh->k = k;
+    hh->index_mask = index_size - 1;
+    hh->counters = calloc((size_t)HH_DEPTH * width, sizeof(uint64_t));
+    hh->heap = calloc(k, sizeof(hh_entry_t));
+    hh->index = calloc(index_size, sizeof(uint32_t));
+    if (!hh->counters || !hh->heap || !hh->index) {
+        fprintf(stderr, "Error: Failed to allocate heavy hitter sketch\n");
+        hh_sketch_destroy(hh);
+        return NULL;
+    }
+    return hh;
+}
+
+void hh_sketch_update(hh_sketch_t *hh, const pkt_info_t *info, uint32_t packet_size) {
+    flow_key_t key;
+    hh_reduce_key(hh->key_mode, &info->key, &key);
+
+    uint64_t hash = flow_hash(&key, HH_SEED);
+    uint32_t h1 = (uint32_t)hash;
+    uint32_t h2 = (uint32_t)(hash >> 32) | 1;
+    uint64_t est = UINT64_MAX;
+    for (uint32_t d = 0; d < hh->depth; d++) {
+        uint64_t *c = &hh->counters[(uint64_t)d * hh->width + ((h1 + d * h2) & (hh->width - 1))];
+        (*c)++;
+        if (*c < est) est = *c;
+    }
+    hh->total_packets++;
+
+    // Already tracked: the estimate only grows, so push it down the min-heap
+    uint32_t pos = index_find(hh, hash, &key);
+    if (pos != UINT32_MAX) {
+        hh->heap[pos].estimate = est;
+        hh->heap[pos].bytes += packet_size;
+        heap_sift_down(hh, pos);
+        return;
+    }
+
+    if (hh->heap_size < hh->k) {
+        pos = hh->heap_size++;
+        hh->heap[pos] = (hh_entry_t){ .key = key, .hash = hash, .estimate = est, .bytes = packet_size };
+        index_insert(hh, pos);
+        heap_sift_up(hh, pos);
+        return;
+    }
+
+    if (est <= hh->heap[0].estimate) return;
+
+    // Evict the lightest candidate
+    index_remove(hh, 0);
+    hh->heap[0] = (hh_entry_t){ .key = key, .hash = hash, .estimate = est, .bytes = packet_size };
+    index_insert(hh, 0);
+    heap_sift_down(hh, 0);
+}
+
+void hh_sketch_skip(hh_sketch_t *hh) {
+    hh->skipped_packets++;
+}
+
+static int entry_cmp_desc(const void *a, const void *b) {
+    const hh_entry_t *ea = a;
+    const hh_entry_t *eb = b;
+    if (ea->estimate != eb->estimate) return ea->estimate < eb->estimate ? 1 : -1;
+    return 0;
+}
+
+int hh_sketch_merge(hh_sketch_t *dst, const hh_sketch_t *src) {
+    if (!dst || !src) return -1;
+    if (dst->depth != src->depth || dst->width != src->width || dst->key_mode != src->key_mode) {
+        fprintf(stderr, "Error: Cannot merge heavy hitter sketches with different shapes\n");
+        return -1;
+    }
+
+    for (uint64_t i = 0; i < (uint64_t)dst->depth * dst->width; i++) {
+        dst->counters[i] += src->counters[i];
+    }
+    dst->total_packets += src->total_packets;
+    dst->skipped_packets += src->skipped_packets;
+
+    // Candidate set is the union of both heaps, re-estimated on the merged counters
+    uint32_t n = dst->heap_size;
+    hh_entry_t *cand = malloc((size_t)(dst->heap_size + src->heap_size + 1) * sizeof(hh_entry_t));
+    if (!cand) return -1;
+    memcpy(cand, dst->heap, (size_t)n * sizeof(hh_entry_t));
+    for (uint32_t i = 0; i < src->heap_size; i++) {
+        uint32_t pos = index_find(dst, src->heap[i].hash, &src->heap[i].key);
+        if (pos != UINT32_MAX) {
+            cand[pos].bytes += src->heap[i].bytes;
+        } else {
+            cand[n++] = src->heap[i];
+        }
+    }
+    for (uint32_t i = 0; i < n; i++) {
+        cand[i].estimate = hh_estimate(dst, cand[i].hash);
+    }
+    qsort(cand, n, sizeof(hh_entry_t), entry_cmp_desc);
+
+    // An ascending array is a valid min-heap
+    dst->heap_size = n < dst->k ? n : dst->k;
+    for (uint32_t i = 0; i < dst->heap_size; i++) {
+        dst->heap[i] = cand[dst->heap_size - 1 - i];
+    }
+    memset(dst->index, 0, (size_t)(dst->index_mask + 1) * sizeof(uint32_t));
+    for (uint32_t i = 0; i < dst->heap_size; i++) {
+        index_insert(dst, i);
+    }
+
+    free(cand);
+    return 0;
+}
+
+void hh_sketch_report(const hh_sketch_t *hh) {
+    if (!hh) return;
+
+    static const char *mode_names[] = { "src", "dst", "flow" };
+    double epsilon = M_E / hh->width;
+    double confidence = 1.0 - exp(-(double)hh->depth);
+    double error = epsilon * hh->total_packets;
+    uint64_t memory = (uint64_t)hh->depth * hh->width * sizeof(uint64_t) +
+                      (uint64_t)hh->k * sizeof(hh_entry_t) +
+                      (uint64_t)(hh->index_mask + 1) * sizeof(uint32_t);
+
+    hh_entry_t *sorted = malloc((size_t)hh->heap_size * sizeof(hh_entry_t) + 1);
+    if (!sorted) return;
+    memcpy(sorted, hh->heap, (size_t)hh->heap_size * sizeof(hh_entry_t));
+    qsort(sorted, hh->heap_size, sizeof(hh_entry_t), entry_cmp_desc);
+
+    printf("\n========== Top Talkers ==========\n");
+    printf("Sketch: %u x %u counters, top-K: %u, key: %s, memory: %.1f KB\n",
+           hh->depth, hh->width, hh->k, mode_names[hh->key_mode], memory / 1024.0);
+    printf("Packets counted: %lu (skipped non-IP: %lu)\n", hh->total_packets, hh->skipped_packets);
+    printf("Error bound: estimate overshoots by at most %.0f packets (eps=%.4f%%) with %.1f%% confidence\n",
+           error, epsilon * 100.0, confidence * 100.0);
+
+    for (uint32_t i = 0; i < hh->heap_size; i++) {
+        const hh_entry_t *e = &sorted[i];
+        char name[128];
+        if (hh->key_mode == HH_KEY_FLOW) {
+            flow_key_format(&e->key, name, sizeof(name));
+        } else {
+            flow_addr_format(e->key.ip_version,
+                             hh->key_mode == HH_KEY_DST ? e->key.dst_addr : e->key.src_addr,
+                             name, sizeof(name));
+        }
+        uint64_t low = e->estimate > error ? (uint64_t)(e->estimate - error) : 0;
+        double share = hh->total_packets ? e->estimate * 100.0 / hh->total_packets : 0.0;
+        printf("%3u. %-48s %12lu pkts [%lu, %lu] %6.2f%% %lu bytes\n",
+               i + 1, name, e->estimate, low, e->estimate, share, e->bytes);
+    }
+    printf("=================================\n");
+
+    free(sorted);
+}
+
+void hh_sketch_destroy(hh_sketch_t *hh) {
+    if (!hh) return;
+    free(hh->counters);
+    free(hh->heap);
+    free(hh->index);
+    free(hh);
+}
@@ -0,0 +1,202 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include "../../include/hugemem.h"
+#include "../../include/placement.h"
+
+#ifndef MAP_HUGE_SHIFT
+#define MAP_HUGE_SHIFT 26
+#endif
+#ifndef MAP_HUGE_2MB
+#define MAP_HUGE_2MB (21 << MAP_HUGE_SHIFT)
+#endif
+#ifndef MAP_HUGE_1GB
+#define MAP_HUGE_1GB (30 << MAP_HUGE_SHIFT)
+#endif
+
+#define SIZE_1G (1UL << 30)
+#define SIZE_2M (2UL << 20)
+#define SIZE_4K 4096UL
+
+static pthread_mutex_t g_lock = PTHREAD_MUTEX_INITIALIZER;
+static hugemem_region_t *g_regions = NULL;
+static bool g_enabled = true;
+static uint64_t g_fallbacks = 0;     // Hugepage mappings refused (pool empty or not reserved)
+static size_t g_peak = 0;
+static size_t g_mapped = 0;
+
+static const char *page_names[] = { "1G hugepages", "2M hugepages", "THP", "4K pages" };
+
+void hugemem_configure(bool enabled) {
+    g_enabled = enabled;
+}
+
+static size_t round_up(size_t len, size_t align) {
+    return (len + align - 1) & ~(align - 1);
+}
+
+static void* map_hugetlb(size_t len, size_t page, int flag) {
+    void *addr = mmap(NULL, round_up(len, page), PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | flag, -1, 0);
+    return addr == MAP_FAILED ? NULL : addr;
+}
+
+void* hugemem_alloc(size_t len, int node, const char *name) {
+    if (len == 0) return NULL;
+
+    hugemem_region_t *region = calloc(1, sizeof(hugemem_region_t));
+    if (!region) return NULL;
+
+    void *addr = NULL;
+    hugemem_page_t page = HUGEMEM_PAGE_4K;
+    size_t mapped = round_up(len, SIZE_4K);
+    size_t map_len = mapped;
+    uint64_t fallbacks = 0;
+
+    if (g_enabled && len >= HUGEMEM_1G_MIN) {
+        addr = map_hugetlb(len, SIZE_1G, MAP_HUGE_1GB);
+        if (addr) {
+            page = HUGEMEM_PAGE_1G;
+            mapped = map_len = round_up(len, SIZE_1G);
+        } else {
+            fallbacks++;
+        }
+    }
+    if (!addr && g_enabled && len >= HUGEMEM_2M_MIN) {
+        addr = map_hugetlb(len, SIZE_2M, MAP_HUGE_2MB);
+        if (addr) {
+            page = HUGEMEM_PAGE_2M;
+            mapped = map_len = round_up(len, SIZE_2M);
+        } else {
+            fallbacks++;
+        }
+    }
+    if (!addr) {
+        // A trailing PROT_NONE page catches overruns and stops the kernel from
+        // merging neighbouring regions into one VMA, which keeps smaps per region
+        map_len = mapped + SIZE_4K;
+        addr = mmap(NULL, map_len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (addr == MAP_FAILED) {
+            fprintf(stderr, "Error: Failed to map %zu bytes for %s: %s\n", len, name, strerror(errno));
+            free(region);
+            return NULL;
+        }
+        mprotect((uint8_t *)addr + mapped, SIZE_4K, PROT_NONE);
+        // The kernel only backs THP-sized stretches, so small regions are not worth advising
+        if (g_enabled && len >= SIZE_2M && madvise(addr, mapped, MADV_HUGEPAGE) == 0) {
+            page = HUGEMEM_PAGE_THP;
+        }
+    }
+
+    // Set the policy before anything touches the pages
+    placement_bind_memory(addr, mapped, node);
+
+    region->addr = addr;
+    region->len = mapped;
+    region->map_len = map_len;
+    region->requested = len;
+    region->page = page;
+    region->name = name;
+
+    pthread_mutex_lock(&g_lock);
+    region->next = g_regions;
+    g_regions = region;
+    g_fallbacks += fallbacks;
+    g_mapped += mapped;
+    if (g_mapped > g_peak) g_peak = g_mapped;
+    pthread_mutex_unlock(&g_lock);
+    return addr;
+}
+
+void hugemem_free(void *addr) {
+    if (!addr) return;
+
+    pthread_mutex_lock(&g_lock);
+    hugemem_region_t **link = &g_regions;
+    while (*link && (*link)->addr != addr) {
+        link = &(*link)->next;
+    }
+    hugemem_region_t *region = *link;
+    if (region) {
+        *link = region->next;
+        g_mapped -= region->len;
+    }
+    pthread_mutex_unlock(&g_lock);
+
+    if (!region) {
+        fprintf(stderr, "Warning: hugemem_free of unknown address %p\n", addr);
+        return;
+    }
+    munmap(region->addr, region->map_len);
+    free(region);
+}
+
+// AnonHugePages of a THP region as reported by the kernel; 0 if unknown
+static size_t thp_backed(const hugemem_region_t *region) {
+    FILE *f = fopen("/proc/self/smaps", "r");
+    if (!f) return 0;
+
+    char line[256];
+    bool in_region = false;
+    size_t kb = 0;
+    while (fgets(line, sizeof(line), f)) {
+        unsigned long start, end;
+        if (sscanf(line, "%lx-%lx ", &start, &end) == 2) {
+            if (in_region) break;
+            in_region = start <= (uintptr_t)region->addr && (uintptr_t)region->addr < end;
+        } else if (in_region && sscanf(line, "AnonHugePages: %zu kB", &kb) == 1) {
+            break;
+        }
+    }
+    fclose(f);
+    return kb * 1024 < region->len ? kb * 1024 : region->len;
+}
+
+void hugemem_report(void) {
+    pthread_mutex_lock(&g_lock);
+    if (!g_regions) {
+        pthread_mutex_unlock(&g_lock);
+        return;
+    }
+
+    printf("\n========== Memory ==========\n");
+    size_t total = 0, huge = 0;
+    // One line per buffer kind; workers have one region each
+    for (hugemem_region_t *r = g_regions; r; r = r->next) {
+        bool seen = false;
+        for (hugemem_region_t *p = g_regions; p != r; p = p->next) {
+            if (strcmp(p->name, r->name) == 0) seen = true;
+        }
+        if (seen) continue;
+
+        size_t len = 0, backed = 0;
+        uint32_t count = 0;
+        int page = r->page;
+        for (hugemem_region_t *q = r; q; q = q->next) {
+            if (strcmp(q->name, r->name) != 0) continue;
+            count++;
+            len += q->len;
+            if (q->page < (hugemem_page_t)page) page = q->page;
+            if (q->page == HUGEMEM_PAGE_1G || q->page == HUGEMEM_PAGE_2M) backed += q->len;
+            else if (q->page == HUGEMEM_PAGE_THP) backed += thp_backed(q);
+        }
+        total += len;
+        huge += backed;
+        printf("%-22s %9.2f MB in %u region(s), %s, %.0f%% on hugepages\n", r->name,
+               len / (1024.0 * 1024.0), count, page_names[page], len ? 100.0 * backed / len : 0.0);
+    }
+    printf("Total: %.2f MB (peak %.2f MB), %.2f MB on hugepages\n", total / (1024.0 * 1024.0),
+           g_peak / (1024.0 * 1024.0), huge / (1024.0 * 1024.0));
+    if (!g_enabled) {
+        printf("Hugepages disabled (--no-hugepages)\n");
+    } else if (g_fallbacks) {
+        printf("Hugepage mappings refused: %lu (reserve pages in /proc/sys/vm/nr_hugepages)\n", g_fallbacks);
+    }
+    printf("============================\n");
+    pthread_mutex_unlock(&g_lock);
+}
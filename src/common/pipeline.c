@@ -0,0 +1,344 @@
+#define _DEFAULT_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <sched.h>
+#include "../../include/pipeline.h"
+#include "../../include/stages.h"
+#include "../../include/placement.h"
+
+#define PIPE_IDLE_SPINS 256          // Empty polls before a worker yields the CPU
+#define PIPE_STALL_SPINS 64          // Full-ring retries before the RX thread yields
+
+static void* worker_main(void *arg) {
+    pipe_worker_t *w = (pipe_worker_t *)arg;
+    pipeline_t *pipe = w->pipe;
+    pipe_desc_t descs[PIPE_BURST];
+    uint32_t idle = 0;
+
+    for (;;) {
+        uint32_t n = spsc_ring_dequeue(w->ring, descs, PIPE_BURST);
+        if (n == 0) {
+            // pipeline_stop only sets stop once every dispatched packet has come back
+            if (atomic_load_explicit(&pipe->stop, memory_order_acquire)) break;
+            if (++idle >= PIPE_IDLE_SPINS) {
+                sched_yield();
+                idle = 0;
+            }
+            continue;
+        }
+        idle = 0;
+
+        uint64_t t0 = get_time_ns();
+        for (uint32_t i = 0; i < n; i++) {
+            if (w->stages) {
+                stages_process(w->stages, descs[i].data, descs[i].len);
+            }
+            w->bytes += descs[i].wire_len;
+        }
+        w->busy_ns += get_time_ns() - t0;
+        w->packets += n;
+        w->batches++;
+
+        // Hand the buffers back; once stopping, the backend's cleanup reclaims them
+        uint32_t done = 0;
+        while (done < n) {
+            done += spsc_ring_enqueue(w->ret, descs + done, n - done);
+            if (done < n) {
+                w->ret_full++;
+                if (atomic_load_explicit(&pipe->stop, memory_order_acquire)) break;
+                sched_yield();
+            }
+        }
+    }
+    return NULL;
+}
+
+pipeline_t* pipeline_create(const config_t *config, struct stages *stages) {
+    if (config->workers == 0 || config->workers > PIPE_MAX_WORKERS) {
+        fprintf(stderr, "Error: Worker count must be 1-%d\n", PIPE_MAX_WORKERS);
+        return NULL;
+    }
+
+    pipeline_t *pipe = calloc(1, sizeof(pipeline_t));
+    if (!pipe) return NULL;
+    pipe->num_workers = config->workers;
+    pipe->ring_size = config->worker_ring ? config->worker_ring : PIPE_DEFAULT_RING;
+    pipe->rx_stages = stages;
+    atomic_init(&pipe->stop, false);
+    rss_init(&pipe->rss, config->rss_hash, pipe->num_workers);
+
+    size_t bytes = (pipe->num_workers * sizeof(pipe_worker_t) + SPSC_CACHE_LINE - 1) &
+                   ~(size_t)(SPSC_CACHE_LINE - 1);
+    pipe->workers = aligned_alloc(SPSC_CACHE_LINE, bytes);
+    if (!pipe->workers) {
+        free(pipe);
+        return NULL;
+    }
+    memset(pipe->workers, 0, bytes);
+
+    // Workers split the reassembly budget instead of each taking all of it.
+    // Capture and the tap stay on the receive thread.
+    config_t worker_config = *config;
+    worker_config.write_file[0] = '\0';
+    worker_config.tap_path[0] = '\0';
+    worker_config.reasm_max_flows = config->reasm_max_flows / pipe->num_workers;
+    worker_config.reasm_mem_mb = config->reasm_mem_mb / pipe->num_workers;
+    if (worker_config.reasm_max_flows == 0) worker_config.reasm_max_flows = 1;
+    if (worker_config.reasm_mem_mb == 0) worker_config.reasm_mem_mb = 1;
+
+    for (uint32_t i = 0; i < pipe->num_workers; i++) {
+        pipe_worker_t *w = &pipe->workers[i];
+        w->pipe = pipe;
+        w->id = i;
+        w->ring = spsc_ring_create(pipe->ring_size);
+        w->ret = spsc_ring_create(pipe->ring_size);
+        if (!w->ring || !w->ret) {
+            fprintf(stderr, "Error: Failed to allocate pipeline rings\n");
+            pipeline_destroy(pipe);
+            return NULL;
+        }
+        if (stages) {
+            w->stages = stages_clone(stages, &worker_config);
+            if (!w->stages) {
+                fprintf(stderr, "Error: Failed to create stages for worker %u\n", i);
+                pipeline_destroy(pipe);
+                return NULL;
+            }
+        }
+    }
+    pipe->ring_size = pipe->workers[0].ring->mask + 1;
+
+    for (uint32_t i = 0; i < pipe->num_workers; i++) {
+        pipe_worker_t *w = &pipe->workers[i];
+        if (pthread_create(&w->thread, NULL, worker_main, w) != 0) {
+            fprintf(stderr, "Error: Failed to start worker %u\n", i);
+            pipeline_destroy(pipe);
+            return NULL;
+        }
+        w->started = true;
+
+        int cpu = placement_worker_cpu(config, i);
+        if (cpu >= 0) {
+            char name[24];
+            snprintf(name, sizeof(name), "Worker %u", i);
+            placement_pin_thread(w->thread, cpu, name, config->numa_node);
+        }
+    }
+
+    printf("Pipeline: %u worker(s), %u-descriptor rings, %s dispatch\n", pipe->num_workers,
+           pipe->ring_size, rss_hash_name(&pipe->rss));
+    return pipe;
+}
+
+void pipeline_attach(pipeline_t *pipe, pipe_release_fn release, void *ctx, volatile bool *running) {
+    pipe->release = release;
+    pipe->release_ctx = ctx;
+    pipe->running = running;
+}
+
+uint32_t pipeline_reclaim(pipeline_t *pipe) {
+    pipe_desc_t descs[PIPE_BURST];
+    uint32_t total = 0;
+
+    for (uint32_t i = 0; i < pipe->num_workers; i++) {
+        uint32_t n;
+        while ((n = spsc_ring_dequeue(pipe->workers[i].ret, descs, PIPE_BURST)) > 0) {
+            if (pipe->release) pipe->release(pipe->release_ctx, descs, n);
+            total += n;
+        }
+    }
+    pipe->reclaimed += total;
+    return total;
+}
+
+// Push a worker's pending batch, waiting while its ring is full. Unless `wait` is
+// set, gives up once the receiver stops and releases what did not fit.
+static void flush_worker(pipeline_t *pipe, pipe_worker_t *w, bool wait) {
+    uint32_t done = spsc_ring_enqueue(w->ring, w->pending, w->npending);
+
+    if (done < w->npending) {
+        uint64_t t0 = get_time_ns();
+        uint32_t spins = 0;
+        w->ring_full++;
+        while (done < w->npending && (wait || !pipe->running || *pipe->running)) {
+            pipeline_reclaim(pipe);
+            if (++spins >= PIPE_STALL_SPINS) {
+                sched_yield();
+                spins = 0;
+            }
+            done += spsc_ring_enqueue(w->ring, w->pending + done, w->npending - done);
+        }
+        pipe->stall_ns += get_time_ns() - t0;
+        if (done < w->npending && pipe->release) {
+            pipe->release(pipe->release_ctx, w->pending + done, w->npending - done);
+        }
+    }
+    w->dispatched += done;
+    w->npending = 0;
+}
+
+// Hash the staged burst and sort it into the workers' pending batches
+static void distribute(pipeline_t *pipe, bool wait) {
+    uint32_t hashes[PIPE_STAGE];
+    uint32_t n = pipe->nstaged;
+
+    if (pipe->num_workers == 1) {
+        memset(hashes, 0, n * sizeof(uint32_t));
+    } else {
+        rss_hash_burst(&pipe->rss, pipe->staged, n, hashes);
+    }
+
+    for (uint32_t i = 0; i < n; i++) {
+        pipe_worker_t *w = &pipe->workers[rss_queue(&pipe->rss, hashes[i])];
+        w->pending[w->npending++] = pipe->staged[i];
+        if (w->npending == PIPE_BURST) {
+            flush_worker(pipe, w, wait);
+        }
+    }
+    pipe->nstaged = 0;
+}
+
+void pipeline_dispatch(pipeline_t *pipe, const uint8_t *data, uint32_t len, uint32_t wire_len,
+                       uint64_t cookie) {
+    // Capture and the tap need packets in arrival order, so they stay on the RX thread
+    if (pipe->rx_stages && pipe->rx_stages->capture) {
+        capture_packet(pipe->rx_stages->capture, data, len);
+    }
+    if (pipe->rx_stages && pipe->rx_stages->tap) {
+        tap_publish(pipe->rx_stages->tap, data, len);
+    }
+
+    pipe->staged[pipe->nstaged++] = (pipe_desc_t){ .data = data, .len = len, .wire_len = wire_len,
+                                                   .cookie = cookie };
+    if (pipe->nstaged == PIPE_STAGE) {
+        distribute(pipe, false);
+    }
+}
+
+// Called at the end of every receive burst: hands partial batches to the workers
+// and recycles the buffers they are done with
+void pipeline_flush(pipeline_t *pipe) {
+    if (pipe->nstaged) {
+        distribute(pipe, false);
+    }
+    for (uint32_t i = 0; i < pipe->num_workers; i++) {
+        if (pipe->workers[i].npending) {
+            flush_worker(pipe, &pipe->workers[i], false);
+        }
+    }
+    pipeline_reclaim(pipe);
+}
+
+// Descriptors handed to workers and not yet returned
+uint64_t pipeline_outstanding(const pipeline_t *pipe) {
+    uint64_t dispatched = 0;
+    for (uint32_t i = 0; i < pipe->num_workers; i++) {
+        dispatched += pipe->workers[i].dispatched;
+    }
+    return dispatched - pipe->reclaimed;
+}
+
+// Deliver what is still pending, let the workers drain their rings and join them
+void pipeline_stop(pipeline_t *pipe) {
+    if (!pipe || atomic_load(&pipe->stop)) return;
+
+    bool started = pipe->workers[0].started;
+    if (started && pipe->nstaged) {
+        distribute(pipe, true);
+    }
+    for (uint32_t i = 0; i < pipe->num_workers && started; i++) {
+        if (pipe->workers[i].npending) {
+            flush_worker(pipe, &pipe->workers[i], true);
+        }
+    }
+    while (started && pipeline_outstanding(pipe) > 0) {
+        if (pipeline_reclaim(pipe) == 0) sched_yield();
+    }
+
+    atomic_store_explicit(&pipe->stop, true, memory_order_release);
+    for (uint32_t i = 0; i < pipe->num_workers; i++) {
+        if (pipe->workers[i].started) {
+            pthread_join(pipe->workers[i].thread, NULL);
+            pipe->workers[i].started = false;
+        }
+    }
+    pipeline_reclaim(pipe);
+}
+
+// Fold the workers' stage results into the main instance for reporting
+int pipeline_merge(pipeline_t *pipe, struct stages *dst) {
+    if (!pipe || !dst) return 0;
+
+    for (uint32_t i = 0; i < pipe->num_workers; i++) {
+        if (pipe->workers[i].stages && stages_merge(dst, pipe->workers[i].stages) != 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+void pipeline_report(const pipeline_t *pipe, const stats_t *stats) {
+    if (!pipe) return;
+
+    double runtime_sec = (stats->end_time_ns - stats->start_time_ns) / 1e9;
+    uint64_t dispatched = 0, ring_full = 0;
+
+    printf("\n========== Pipeline ==========\n");
+    printf("Workers: %u, ring: %u descriptors, dispatch: %s over a %d-entry RETA\n",
+           pipe->num_workers, pipe->ring_size, rss_hash_name(&pipe->rss), RSS_RETA_SIZE);
+    uint64_t max_dispatched = 0;
+    uint32_t busiest = 0;
+    for (uint32_t i = 0; i < pipe->num_workers; i++) {
+        dispatched += pipe->workers[i].dispatched;
+        ring_full += pipe->workers[i].ring_full;
+        if (pipe->workers[i].dispatched > max_dispatched) {
+            max_dispatched = pipe->workers[i].dispatched;
+            busiest = i;
+        }
+    }
+    printf("%-8s: %lu packets dispatched (%.2f PPS), ring-full stalls: %lu (%.1f ms waiting)\n",
+           "RX", dispatched, runtime_sec > 0 ? dispatched / runtime_sec : 0.0, ring_full,
+           pipe->stall_ns / 1e6);
+
+    for (uint32_t i = 0; i < pipe->num_workers; i++) {
+        const pipe_worker_t *w = &pipe->workers[i];
+        double busy = runtime_sec > 0 ? w->busy_ns / 1e9 / runtime_sec * 100 : 0.0;
+        char name[24];
+        snprintf(name, sizeof(name), "Worker %u", i);
+        printf("%-8s: %lu packets (%.2f PPS, %.1f%% of RX), busy %.1f%%, avg batch %.1f, "
+               "ring-full stalls: %lu, return stalls: %lu\n",
+               name, w->packets, runtime_sec > 0 ? w->packets / runtime_sec : 0.0,
+               dispatched ? w->packets * 100.0 / dispatched : 0.0, busy,
+               w->batches ? (double)w->packets / w->batches : 0.0, w->ring_full, w->ret_full);
+    }
+
+    // With flow affinity the busiest worker limits throughput; 1.00 is a perfect split
+    if (dispatched && pipe->num_workers > 1) {
+        double mean = (double)dispatched / pipe->num_workers;
+        printf("Balance : max/avg %.2f (worker %u)%s\n", max_dispatched / mean, busiest,
+               max_dispatched / mean > 1.5 ? ", few flows or heavy hitters limit the spread" : "");
+    }
+
+    // Full rings mean the workers fall behind; otherwise the receive side is the limit
+    if (ring_full) {
+        printf("Worker rings ran full: add workers (each on its own core)\n");
+    } else {
+        printf("Workers keep up with RX: add RX queues for more throughput\n");
+    }
+    printf("==============================\n");
+}
+
+void pipeline_destroy(pipeline_t *pipe) {
+    if (!pipe) return;
+
+    pipeline_stop(pipe);
+    for (uint32_t i = 0; i < pipe->num_workers; i++) {
+        spsc_ring_destroy(pipe->workers[i].ring);
+        spsc_ring_destroy(pipe->workers[i].ret);
+        stages_destroy(pipe->workers[i].stages);
+    }
+    free(pipe->workers);
+    free(pipe);
+}
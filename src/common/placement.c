@@ -0,0 +1,141 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <dirent.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include "../../include/placement.h"
+
+// From <linux/mempolicy.h>, which is not always installed
+#define MPOL_PREFERRED 1
+#define MPOL_MF_MOVE (1 << 1)
+
+// Parse "2", "2,4,6" or "2-5,8"; returns the number of CPUs or -1
+int placement_parse_cpus(const char *spec, uint16_t *cpus, uint32_t max) {
+    uint32_t n = 0;
+    const char *p = spec;
+
+    while (*p) {
+        char *end;
+        long first = strtol(p, &end, 10);
+        long last = first;
+        if (end == p || first < 0) return -1;
+        if (*end == '-') {
+            p = end + 1;
+            last = strtol(p, &end, 10);
+            if (end == p || last < first) return -1;
+        }
+        for (long cpu = first; cpu <= last; cpu++) {
+            if (n == max || cpu > UINT16_MAX) return -1;
+            cpus[n++] = (uint16_t)cpu;
+        }
+        if (*end == ',') end++;
+        else if (*end) return -1;
+        p = end;
+    }
+    return n ? (int)n : -1;
+}
+
+static int read_node_file(const char *path) {
+    FILE *f = fopen(path, "r");
+    if (!f) return -1;
+    int node = -1;
+    if (fscanf(f, "%d", &node) != 1) node = -1;
+    fclose(f);
+    return node;
+}
+
+// NUMA node of the receive device, -1 if unknown (virtual devices, single-node boxes)
+int placement_device_node(const config_t *config) {
+    char path[128];
+
+    if (config->mode == MODE_DPDK) {
+        snprintf(path, sizeof(path), "/sys/bus/pci/devices/%s/numa_node", config->address);
+    } else if (config->mode == MODE_SOCKET || config->mode == MODE_AF_XDP) {
+        snprintf(path, sizeof(path), "/sys/class/net/%s/device/numa_node", config->interface);
+    } else {
+        return -1;
+    }
+    return read_node_file(path);
+}
+
+int placement_cpu_node(int cpu) {
+    char path[64];
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d", cpu);
+
+    DIR *dir = opendir(path);
+    if (!dir) return -1;
+    int node = -1;
+    struct dirent *ent;
+    while ((ent = readdir(dir)) != NULL) {
+        if (strncmp(ent->d_name, "node", 4) == 0 && ent->d_name[4] >= '0' && ent->d_name[4] <= '9') {
+            node = atoi(ent->d_name + 4);
+            break;
+        }
+    }
+    closedir(dir);
+    return node;
+}
+
+// Lowest-numbered CPU of a node, skipping CPU 0 (interrupts and housekeeping) if possible
+int placement_node_first_cpu(int node) {
+    char path[64];
+    snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", node);
+
+    FILE *f = fopen(path, "r");
+    if (!f) return -1;
+    char list[256];
+    int cpu = -1;
+    if (fgets(list, sizeof(list), f)) {
+        list[strcspn(list, "\n")] = '\0';
+        uint16_t cpus[1024];
+        int n = placement_parse_cpus(list, cpus, 1024);
+        if (n > 0) cpu = (cpus[0] == 0 && n > 1) ? cpus[1] : cpus[0];
+    }
+    fclose(f);
+    return cpu;
+}
+
+// The receive thread gets the first CPU of --cpus, workers share the rest
+int placement_worker_cpu(const config_t *config, uint32_t worker) {
+    if (config->num_cpus == 0) return -1;
+    if (config->num_cpus == 1) return config->cpus[0];
+    return config->cpus[1 + worker % (config->num_cpus - 1)];
+}
+
+int placement_pin_thread(pthread_t thread, int cpu, const char *name, int device_node) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    int ret = pthread_setaffinity_np(thread, sizeof(set), &set);
+    if (ret != 0) {
+        fprintf(stderr, "Error: Failed to pin %s to CPU %d: %s\n", name, cpu, strerror(ret));
+        return -1;
+    }
+
+    int node = placement_cpu_node(cpu);
+    if (device_node >= 0 && node >= 0 && node != device_node) {
+        fprintf(stderr, "Warning: %s runs on CPU %d (node %d) but the NIC is on node %d; "
+                "every packet crosses the interconnect\n", name, cpu, node, device_node);
+    } else {
+        printf("%s pinned to CPU %d (node %d)\n", name, cpu, node);
+    }
+    return 0;
+}
+
+// Prefer pages of [addr, addr + len) on `node`, moving any already faulted in
+int placement_bind_memory(void *addr, size_t len, int node) {
+    if (node < 0) return 0;
+    if (node >= (int)(sizeof(unsigned long) * 8)) return -1;
+
+    unsigned long mask = 1UL << node;
+    if (syscall(SYS_mbind, addr, len, MPOL_PREFERRED, &mask, sizeof(mask) * 8, MPOL_MF_MOVE) != 0) {
+        fprintf(stderr, "Warning: mbind to node %d failed: %s\n", node, strerror(errno));
+        return -1;
+    }
+    return 0;
+}
@@ -0,0 +1,171 @@
+#define _DEFAULT_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <endian.h>
+#include "../../include/common.h"
+#include "../../include/probe.h"
+#include "../../include/hugemem.h"
+
+// Log-linear bucket: exact below 16 ns, then 16 sub-buckets per power of two (~6% resolution)
+static inline uint32_t lat_bucket(uint64_t ns) {
+    if (ns < (1u << PROBE_LAT_SUB_BITS)) return (uint32_t)ns;
+    uint32_t msb = 63 - (uint32_t)__builtin_clzll(ns);
+    uint32_t shift = msb - PROBE_LAT_SUB_BITS;
+    return ((msb - PROBE_LAT_SUB_BITS + 1) << PROBE_LAT_SUB_BITS) +
+           (uint32_t)((ns >> shift) & ((1u << PROBE_LAT_SUB_BITS) - 1));
+}
+
+// Midpoint of a bucket
+static uint64_t lat_bucket_value(uint32_t idx) {
+    if (idx < (1u << PROBE_LAT_SUB_BITS)) return idx;
+    uint32_t shift = (idx >> PROBE_LAT_SUB_BITS) - 1;
+    uint64_t low = (uint64_t)((1u << PROBE_LAT_SUB_BITS) + (idx & ((1u << PROBE_LAT_SUB_BITS) - 1))) << shift;
+    return low + ((1ULL << shift) >> 1);
+}
+
+probe_t* probe_create(void) {
+    probe_t *probe = calloc(1, sizeof(probe_t));
+    if (!probe) return NULL;
+
+    probe->flows = hugemem_alloc(PROBE_MAX_FLOWS * sizeof(probe_flow_t), -1, "Probe flows");
+    if (!probe->flows) {
+        fprintf(stderr, "Error: Failed to allocate probe flow table\n");
+        free(probe);
+        return NULL;
+    }
+    probe->lat_min_ns = UINT64_MAX;
+    return probe;
+}
+
+void probe_process(probe_t *probe, const pkt_info_t *info, const uint8_t *data) {
+    if (info->key.proto != 17 || info->payload_len < sizeof(probe_hdr_t)) return;
+
+    probe_hdr_t hdr;
+    memcpy(&hdr, data + info->payload_offset, sizeof(hdr));
+    if (be16toh(hdr.magic) != PROBE_MAGIC) return;
+
+    uint32_t seq = be32toh(hdr.seq);
+    probe_flow_t *f = &probe->flows[be16toh(hdr.flow)];
+    if (!f->seen) {
+        f->seen = true;
+        f->min_seq = seq;
+        f->max_seq = seq;
+    } else if ((int32_t)(seq - f->max_seq) > 0) {
+        f->max_seq = seq;
+    } else {
+        probe->reordered++;
+        if ((int32_t)(seq - f->min_seq) < 0) f->min_seq = seq;
+    }
+    f->received++;
+    probe->packets++;
+
+    // Only meaningful when sender and receiver share CLOCK_MONOTONIC (same host)
+    uint64_t tx_ns = be64toh(hdr.tx_ns);
+    uint64_t now = get_time_ns();
+    if (tx_ns && now >= tx_ns) {
+        uint64_t lat = now - tx_ns;
+        probe->lat_hist[lat_bucket(lat)]++;
+        probe->lat_count++;
+        probe->lat_sum_ns += lat;
+        if (lat < probe->lat_min_ns) probe->lat_min_ns = lat;
+        if (lat > probe->lat_max_ns) probe->lat_max_ns = lat;
+    }
+}
+
+int probe_merge(probe_t *dst, const probe_t *src) {
+    if (!dst || !src) return -1;
+
+    for (uint32_t i = 0; i < PROBE_MAX_FLOWS; i++) {
+        const probe_flow_t *s = &src->flows[i];
+        probe_flow_t *d = &dst->flows[i];
+        if (!s->seen) continue;
+        if (!d->seen) {
+            *d = *s;
+            continue;
+        }
+        if ((int32_t)(s->min_seq - d->min_seq) < 0) d->min_seq = s->min_seq;
+        if ((int32_t)(s->max_seq - d->max_seq) > 0) d->max_seq = s->max_seq;
+        d->received += s->received;
+    }
+
+    dst->packets += src->packets;
+    dst->reordered += src->reordered;
+    dst->lat_count += src->lat_count;
+    dst->lat_sum_ns += src->lat_sum_ns;
+    if (src->lat_min_ns < dst->lat_min_ns) dst->lat_min_ns = src->lat_min_ns;
+    if (src->lat_max_ns > dst->lat_max_ns) dst->lat_max_ns = src->lat_max_ns;
+    for (uint32_t i = 0; i < PROBE_LAT_BUCKETS; i++) {
+        dst->lat_hist[i] += src->lat_hist[i];
+    }
+    return 0;
+}
+
+static uint64_t lat_percentile(const probe_t *probe, double pct) {
+    uint64_t rank = (uint64_t)(probe->lat_count * pct);
+    if (rank >= probe->lat_count) rank = probe->lat_count - 1;
+
+    uint64_t seen = 0;
+    for (uint32_t i = 0; i < PROBE_LAT_BUCKETS; i++) {
+        seen += probe->lat_hist[i];
+        if (seen > rank) {
+            uint64_t v = lat_bucket_value(i);
+            if (v < probe->lat_min_ns) return probe->lat_min_ns;
+            return v > probe->lat_max_ns ? probe->lat_max_ns : v;
+        }
+    }
+    return probe->lat_max_ns;
+}
+
+void probe_summarize(const probe_t *probe, probe_summary_t *summary) {
+    memset(summary, 0, sizeof(*summary));
+    if (!probe) return;
+
+    // Loss is estimated per flow from the sequence span actually observed
+    for (uint32_t i = 0; i < PROBE_MAX_FLOWS; i++) {
+        const probe_flow_t *f = &probe->flows[i];
+        if (!f->seen) continue;
+        uint64_t span = (uint64_t)(f->max_seq - f->min_seq) + 1;
+        summary->flows++;
+        summary->expected += span;
+        if (span > f->received) summary->lost += span - f->received;
+    }
+
+    summary->packets = probe->packets;
+    summary->reordered = probe->reordered;
+    if (probe->lat_count) {
+        summary->lat_avg_ns = (double)probe->lat_sum_ns / probe->lat_count;
+        summary->lat_min_ns = probe->lat_min_ns;
+        summary->lat_p50_ns = lat_percentile(probe, 0.50);
+        summary->lat_p99_ns = lat_percentile(probe, 0.99);
+        summary->lat_p999_ns = lat_percentile(probe, 0.999);
+        summary->lat_max_ns = probe->lat_max_ns;
+    }
+}
+
+void probe_report(const probe_t *probe) {
+    if (!probe) return;
+
+    probe_summary_t s;
+    probe_summarize(probe, &s);
+
+    printf("\n========== Probe ==========\n");
+    printf("Probe packets: %lu (flows: %u)\n", s.packets, s.flows);
+    printf("Expected: %lu, lost: %lu (%.4f%%), reordered: %lu\n", s.expected, s.lost,
+           s.expected ? s.lost * 100.0 / s.expected : 0.0, s.reordered);
+    if (probe->lat_count) {
+        printf("Latency (us): min %.2f, avg %.2f, p50 %.2f, p99 %.2f, p99.9 %.2f, max %.2f\n",
+               s.lat_min_ns / 1e3, s.lat_avg_ns / 1e3, s.lat_p50_ns / 1e3, s.lat_p99_ns / 1e3,
+               s.lat_p999_ns / 1e3, s.lat_max_ns / 1e3);
+    } else {
+        printf("Latency: n/a (sender timestamps not comparable with this host's clock)\n");
+    }
+    printf("===========================\n");
+}
+
+void probe_destroy(probe_t *probe) {
+    if (!probe) return;
+    hugemem_free(probe->flows);
+    free(probe);
+}
@@ -0,0 +1,412 @@
+#define _DEFAULT_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include "../../include/common.h"
+#include "../../include/reassembly.h"
+#include "../../include/hugemem.h"
+
+#define REASM_HASH_SEED 0x7265617373656dULL
+#define REASM_TICK_PACKETS 4096      // Packets between sweeps under load
+#define REASM_SWEEP_INTERVAL_NS 100000000ULL  // Longest gap between sweeps at low rates
+#define REASM_SWEEP_SLOTS 1024       // Table slots checked per sweep
+
+#define SEQ_LT(a, b) ((int32_t)((a) - (b)) < 0)
+#define SEQ_LEQ(a, b) ((int32_t)((a) - (b)) <= 0)
+
+// Per-packet clock: the coarse clock is a vDSO read of the last tick, far
+// cheaper than CLOCK_MONOTONIC and plenty for second-granularity timeouts
+static inline uint64_t coarse_time_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static reasm_segment_t* seg_alloc(reasm_t *reasm) {
+    reasm_segment_t *seg = reasm->free_list;
+    if (!seg) return NULL;
+    reasm->free_list = seg->next;
+    seg->next = NULL;
+    if (++reasm->pool_used > reasm->peak_pool_used) {
+        reasm->peak_pool_used = reasm->pool_used;
+    }
+    return seg;
+}
+
+static void seg_free(reasm_t *reasm, reasm_segment_t *seg) {
+    seg->next = reasm->free_list;
+    reasm->free_list = seg;
+    reasm->pool_used--;
+}
+
+static void deliver(reasm_t *reasm, reasm_flow_t *flow, const uint8_t *data, uint32_t len) {
+    reasm->bytes_reassembled += len;
+    flow->next_seq += len;
+    if (reasm->deliver) {
+        reasm->deliver(reasm->deliver_ctx, &flow->key, &flow->consumer_state, data, len);
+    }
+}
+
+// Deliver buffered segments that have become contiguous
+static void drain(reasm_t *reasm, reasm_flow_t *flow) {
+    while (flow->ooo && SEQ_LEQ(flow->ooo->seq, flow->next_seq)) {
+        reasm_segment_t *seg = flow->ooo;
+        uint32_t end = seg->seq + seg->len;
+        if (SEQ_LT(flow->next_seq, end)) {
+            uint32_t skip = flow->next_seq - seg->seq;
+            deliver(reasm, flow, seg->data + skip, seg->len - skip);
+        }
+        flow->ooo = seg->next;
+        flow->ooo_bytes -= seg->len;
+        seg_free(reasm, seg);
+    }
+}
+
+// Give up on the hole before the first buffered segment
+static void skip_gap(reasm_t *reasm, reasm_flow_t *flow, uint32_t to_seq) {
+    reasm->gaps++;
+    reasm->gap_bytes += to_seq - flow->next_seq;
+    flow->next_seq = to_seq;
+    flow->consumer_state = 0;        // The stream is no longer contiguous
+    drain(reasm, flow);
+}
+
+static void release_flow(reasm_t *reasm, reasm_flow_t *flow) {
+    reasm_segment_t *seg = flow->ooo;
+    while (seg) {
+        reasm_segment_t *next = seg->next;
+        seg_free(reasm, seg);
+        seg = next;
+    }
+    flow->ooo = NULL;
+    flow->ooo_bytes = 0;
+}
+
+// Flow table helpers (linear probing, backward-shift deletion)
+
+static reasm_flow_t* flow_lookup(reasm_t *reasm, const flow_key_t *key, uint64_t hash, bool create) {
+    uint32_t slot = (uint32_t)hash & reasm->flow_mask;
+    while (reasm->flows[slot].in_use) {
+        reasm_flow_t *flow = &reasm->flows[slot];
+        if (flow->hash == hash && flow_key_equal(&flow->key, key)) return flow;
+        slot = (slot + 1) & reasm->flow_mask;
+    }
+    if (!create) return NULL;
+    if (reasm->active_flows >= reasm->max_flows) {
+        reasm->flows_rejected++;
+        return NULL;
+    }
+
+    reasm_flow_t *flow = &reasm->flows[slot];
+    memset(flow, 0, sizeof(*flow));
+    flow->key = *key;
+    flow->hash = hash;
+    flow->in_use = true;
+    reasm->flows_created++;
+    if (++reasm->active_flows > reasm->peak_flows) {
+        reasm->peak_flows = reasm->active_flows;
+    }
+    return flow;
+}
+
+static void flow_remove(reasm_t *reasm, reasm_flow_t *flow) {
+    release_flow(reasm, flow);
+    reasm->active_flows--;
+
+    uint32_t slot = (uint32_t)(flow - reasm->flows);
+    uint32_t next = (slot + 1) & reasm->flow_mask;
+    while (reasm->flows[next].in_use) {
+        uint32_t ideal = (uint32_t)reasm->flows[next].hash & reasm->flow_mask;
+        if (((next - ideal) & reasm->flow_mask) >= ((next - slot) & reasm->flow_mask)) {
+            reasm->flows[slot] = reasm->flows[next];
+            slot = next;
+        }
+        next = (next + 1) & reasm->flow_mask;
+    }
+    reasm->flows[slot].in_use = false;
+    reasm->flows[slot].ooo = NULL;
+}
+
+// Expire idle flows, a slice of the table at a time
+static void sweep(reasm_t *reasm) {
+    for (uint32_t n = 0; n < REASM_SWEEP_SLOTS && n <= reasm->flow_mask; n++) {
+        uint32_t slot = reasm->sweep_cursor;
+        reasm->sweep_cursor = (slot + 1) & reasm->flow_mask;
+
+        reasm_flow_t *flow = &reasm->flows[slot];
+        if (!flow->in_use || reasm->now_ns - flow->last_seen_ns < reasm->timeout_ns) continue;
+
+        // Flush whatever is buffered past the hole before dropping the flow
+        while (flow->ooo) {
+            skip_gap(reasm, flow, flow->ooo->seq);
+        }
+        reasm->flows_expired++;
+        flow_remove(reasm, flow);
+        reasm->sweep_cursor = slot;  // Backward shift may have moved a flow into this slot
+    }
+}
+
+// Count the segments and bytes buffer_segment would add for [seq, seq + len),
+// trimming overlaps with already buffered data exactly as it does
+static uint32_t count_pieces(const reasm_flow_t *flow, uint32_t seq, uint32_t len, uint32_t *new_bytes) {
+    const reasm_segment_t *node = flow->ooo;
+    uint32_t pieces = 0;
+    *new_bytes = 0;
+    while (len > 0) {
+        while (node && SEQ_LEQ(node->seq + node->len, seq)) {
+            node = node->next;
+        }
+        if (node && SEQ_LEQ(node->seq, seq)) {
+            uint32_t overlap = node->seq + node->len - seq;
+            if (overlap > len) overlap = len;
+            seq += overlap;
+            len -= overlap;
+            continue;
+        }
+
+        uint32_t piece = len;
+        if (node && node->seq - seq < piece) piece = node->seq - seq;
+        if (piece > REASM_SEG_DATA) piece = REASM_SEG_DATA;
+        pieces++;
+        *new_bytes += piece;
+        seq += piece;
+        len -= piece;
+    }
+    return pieces;
+}
+
+// Buffer the parts of [seq, seq + len) that fill holes in the out-of-order list.
+// Returns false, buffering nothing, if that would exceed the per-flow or pool limit.
+static bool buffer_segment(reasm_t *reasm, reasm_flow_t *flow, uint32_t seq, const uint8_t *data, uint32_t len) {
+    uint32_t new_bytes;
+    uint32_t pieces = count_pieces(flow, seq, len, &new_bytes);
+    if ((uint64_t)flow->ooo_bytes + new_bytes > reasm->flow_limit ||
+        reasm->pool_size - reasm->pool_used < pieces) {
+        return false;
+    }
+
+    reasm->ooo_segments++;
+    reasm_segment_t *prev = NULL;
+    reasm_segment_t *node = flow->ooo;
+    while (len > 0) {
+        while (node && SEQ_LEQ(node->seq + node->len, seq)) {
+            prev = node;
+            node = node->next;
+        }
+
+        // Already buffered
+        if (node && SEQ_LEQ(node->seq, seq)) {
+            uint32_t overlap = node->seq + node->len - seq;
+            if (overlap > len) overlap = len;
+            reasm->overlap_bytes += overlap;
+            seq += overlap;
+            data += overlap;
+            len -= overlap;
+            continue;
+        }
+
+        uint32_t piece = len;
+        if (node && node->seq - seq < piece) piece = node->seq - seq;
+        if (piece > REASM_SEG_DATA) piece = REASM_SEG_DATA;
+
+        reasm_segment_t *seg = seg_alloc(reasm);
+        if (!seg) return false;  // Not reached: the pool was checked above
+        seg->seq = seq;
+        seg->len = piece;
+        memcpy(seg->data, data, piece);
+        seg->next = node;
+        if (prev) {
+            prev->next = seg;
+        } else {
+            flow->ooo = seg;
+        }
+        flow->ooo_bytes += piece;
+        prev = seg;
+
+        seq += piece;
+        data += piece;
+        len -= piece;
+    }
+    return true;
+}
+
+static void add_data(reasm_t *reasm, reasm_flow_t *flow, uint32_t seq, const uint8_t *data, uint32_t len) {
+    for (;;) {
+        uint32_t end = seq + len;
+        if (SEQ_LEQ(end, flow->next_seq)) {
+            reasm->overlap_bytes += len;
+            return;
+        }
+        if (SEQ_LT(seq, flow->next_seq)) {
+            uint32_t skip = flow->next_seq - seq;
+            reasm->overlap_bytes += skip;
+            seq += skip;
+            data += skip;
+            len -= skip;
+        }
+
+        if (seq == flow->next_seq) {
+            deliver(reasm, flow, data, len);
+            drain(reasm, flow);
+            return;
+        }
+
+        if (buffer_segment(reasm, flow, seq, data, len)) return;
+
+        // Over the per-flow or global limit: skip the oldest hole and retry
+        skip_gap(reasm, flow, flow->ooo && SEQ_LT(flow->ooo->seq, seq) ? flow->ooo->seq : seq);
+    }
+}
+
+reasm_t* reasm_create(uint32_t max_flows, uint32_t flow_limit_kb, uint32_t mem_limit_mb, uint32_t timeout_sec) {
+    if (max_flows == 0 || max_flows > REASM_MAX_FLOWS || flow_limit_kb > REASM_MAX_FLOW_KB ||
+        mem_limit_mb > REASM_MAX_MEM_MB) {
+        fprintf(stderr, "Error: Reassembly limits out of range\n");
+        return NULL;
+    }
+    reasm_t *reasm = calloc(1, sizeof(reasm_t));
+    if (!reasm) return NULL;
+
+    // max_flows is capped, so the table size stays inside 32 bits
+    uint32_t table_size = 16;
+    while (table_size < 2 * (uint64_t)max_flows) {
+        table_size *= 2;
+    }
+
+    reasm->flow_limit = flow_limit_kb * 1024;
+    reasm->timeout_ns = (uint64_t)timeout_sec * 1000000000ULL;
+    reasm->max_flows = max_flows;
+    reasm->flow_mask = table_size - 1;
+    reasm->pool_size = (uint32_t)(((uint64_t)mem_limit_mb << 20) / sizeof(reasm_segment_t));
+    reasm->flows = hugemem_alloc((size_t)table_size * sizeof(reasm_flow_t), -1, "Reassembly flows");
+    reasm->pool = hugemem_alloc((size_t)reasm->pool_size * sizeof(reasm_segment_t), -1,
+                                "Reassembly segments");
+    if (!reasm->flows || !reasm->pool || reasm->pool_size == 0) {
+        fprintf(stderr, "Error: Failed to allocate reassembly memory\n");
+        reasm_destroy(reasm);
+        return NULL;
+    }
+
+    for (uint32_t i = 0; i < reasm->pool_size; i++) {
+        reasm->pool[i].next = i + 1 < reasm->pool_size ? &reasm->pool[i + 1] : NULL;
+    }
+    reasm->free_list = &reasm->pool[0];
+    reasm->now_ns = coarse_time_ns();
+    reasm->last_sweep_ns = reasm->now_ns;
+    return reasm;
+}
+
+void reasm_set_callback(reasm_t *reasm, reasm_deliver_fn fn, void *ctx) {
+    reasm->deliver = fn;
+    reasm->deliver_ctx = ctx;
+}
+
+// Returns true if the packet belongs to a tracked flow, whose payload then
+// reaches the deliver callback (or is counted as overlap or gap)
+bool reasm_process(reasm_t *reasm, const pkt_info_t *info, const uint8_t *data) {
+    if (info->key.proto != 6) return false;
+    if (info->fragment) {
+        // Trailing fragments have no TCP header, so their seq would be bogus
+        reasm->fragments++;
+        return false;
+    }
+
+    // Sweep every few thousand packets under load, and on elapsed time so
+    // that idle flows still expire when traffic is sparse
+    reasm->now_ns = coarse_time_ns();
+    if (++reasm->packets_since_tick >= REASM_TICK_PACKETS ||
+        reasm->now_ns - reasm->last_sweep_ns >= REASM_SWEEP_INTERVAL_NS) {
+        reasm->packets_since_tick = 0;
+        reasm->last_sweep_ns = reasm->now_ns;
+        sweep(reasm);
+    }
+
+    uint64_t hash = flow_hash(&info->key, REASM_HASH_SEED);
+    reasm_flow_t *flow = flow_lookup(reasm, &info->key, hash, true);
+    if (!flow) return false;
+
+    reasm->segments++;
+    flow->last_seen_ns = reasm->now_ns;
+
+    if (info->tcp_flags & FLOW_TCP_RST) {
+        reasm->flows_closed++;
+        flow_remove(reasm, flow);
+        return true;
+    }
+
+    uint32_t seq = info->tcp_seq;
+    if (info->tcp_flags & FLOW_TCP_SYN) {
+        seq++;
+        flow->next_seq = seq;
+        flow->have_seq = true;
+    } else if (!flow->have_seq) {
+        // Picked up mid-stream
+        flow->next_seq = seq;
+        flow->have_seq = true;
+    }
+
+    if (info->payload_len > 0) {
+        add_data(reasm, flow, seq, data + info->payload_offset, info->payload_len);
+    }
+
+    if (info->tcp_flags & FLOW_TCP_FIN) {
+        flow->fin_seen = true;
+        flow->fin_seq = seq + info->payload_len;
+    }
+    if (flow->fin_seen && flow->next_seq == flow->fin_seq) {
+        reasm->flows_closed++;
+        flow_remove(reasm, flow);
+    }
+    return true;
+}
+
+int reasm_merge(reasm_t *dst, const reasm_t *src) {
+    if (!dst || !src) return -1;
+
+    dst->segments += src->segments;
+    dst->ooo_segments += src->ooo_segments;
+    dst->bytes_reassembled += src->bytes_reassembled;
+    dst->overlap_bytes += src->overlap_bytes;
+    dst->gaps += src->gaps;
+    dst->gap_bytes += src->gap_bytes;
+    dst->fragments += src->fragments;
+    dst->flows_created += src->flows_created;
+    dst->flows_closed += src->flows_closed;
+    dst->flows_expired += src->flows_expired;
+    dst->flows_rejected += src->flows_rejected;
+    // Per-thread peaks are summed, giving an upper bound of the combined peak
+    dst->peak_flows += src->peak_flows;
+    dst->peak_pool_used += src->peak_pool_used;
+    return 0;
+}
+
+void reasm_report(const reasm_t *reasm) {
+    if (!reasm) return;
+
+    double seg_mb = sizeof(reasm_segment_t) / (1024.0 * 1024.0);
+    printf("\n========== TCP Reassembly ==========\n");
+    printf("Segments: %lu (out-of-order: %lu)\n", reasm->segments, reasm->ooo_segments);
+    printf("Reassembled bytes: %lu (%.2f MB)\n",
+           reasm->bytes_reassembled, reasm->bytes_reassembled / (1024.0 * 1024.0));
+    printf("Overlapping/retransmitted bytes: %lu\n", reasm->overlap_bytes);
+    printf("Gaps: %lu (%lu bytes skipped)\n", reasm->gaps, reasm->gap_bytes);
+    if (reasm->fragments > 0) {
+        printf("IP fragments skipped: %lu\n", reasm->fragments);
+    }
+    printf("Flows: created %lu, closed %lu, expired %lu, rejected %lu, peak %u (limit %u)\n",
+           reasm->flows_created, reasm->flows_closed, reasm->flows_expired,
+           reasm->flows_rejected, reasm->peak_flows, reasm->max_flows);
+    printf("Segment memory: high-water %.2f MB (%u segments) of %.2f MB, per-flow limit %u KB\n",
+           reasm->peak_pool_used * seg_mb, reasm->peak_pool_used,
+           reasm->pool_size * seg_mb, reasm->flow_limit / 1024);
+    printf("====================================\n");
+}
+
+void reasm_destroy(reasm_t *reasm) {
+    if (!reasm) return;
+    hugemem_free(reasm->flows);
+    hugemem_free(reasm->pool);
+    free(reasm);
+}
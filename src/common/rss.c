@@ -0,0 +1,210 @@
+#define _DEFAULT_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <nmmintrin.h>
+#define RSS_HAVE_CRC32 1
+#endif
+#include "../../include/rss.h"
+#include "../../include/flow.h"
+
+#define CRC32C_POLY 0x82F63B78u
+
+// Symmetric RSS key (0x6d5a repeated): swapping source and destination gives
+// the same hash, so both directions of a connection reach the same queue
+static const uint8_t symmetric_key[RSS_KEY_LEN] = {
+    0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a,
+    0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a,
+    0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a,
+    0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a,
+};
+
+// Bit-by-bit Toeplitz hash as specified for NIC RSS
+static uint32_t toeplitz(const uint8_t *key, const uint8_t *input, uint32_t len) {
+    uint32_t result = 0;
+    uint32_t window = (uint32_t)key[0] << 24 | (uint32_t)key[1] << 16 | (uint32_t)key[2] << 8 | key[3];
+
+    for (uint32_t i = 0; i < len; i++) {
+        for (int b = 7; b >= 0; b--) {
+            if (input[i] & (1u << b)) result ^= window;
+            window <<= 1;
+            if (i + 4 < RSS_KEY_LEN && (key[i + 4] & (1u << b))) window |= 1;
+        }
+    }
+    return result;
+}
+
+void rss_init(rss_t *rss, rss_hash_t type, uint32_t num_queues) {
+    memset(rss, 0, sizeof(*rss));
+    rss->type = type;
+    rss->num_queues = num_queues ? num_queues : 1;
+    for (uint32_t i = 0; i < RSS_RETA_SIZE; i++) {
+        rss->reta[i] = (uint16_t)(i % rss->num_queues);
+    }
+
+    // Toeplitz is linear over GF(2) and the symmetric key repeats every 16 bits,
+    // so a byte's contribution only depends on its value and offset parity: the
+    // tuple can be XOR-folded to 16 bits and hashed with two lookups
+    for (uint32_t v = 0; v < 256; v++) {
+        uint8_t even[2] = { (uint8_t)v, 0 };
+        uint8_t odd[2] = { 0, (uint8_t)v };
+        rss->toeplitz[0][v] = toeplitz(symmetric_key, even, 2);
+        rss->toeplitz[1][v] = toeplitz(symmetric_key, odd, 2);
+    }
+
+    for (uint32_t v = 0; v < 256; v++) {
+        uint32_t crc = v;
+        for (int b = 0; b < 8; b++) crc = (crc >> 1) ^ (CRC32C_POLY & (0u - (crc & 1)));
+        rss->crc_table[v] = crc;
+    }
+#ifdef RSS_HAVE_CRC32
+    rss->use_sse42 = __builtin_cpu_supports("sse4.2");
+#endif
+}
+
+const char* rss_hash_name(const rss_t *rss) {
+    if (rss->type == RSS_HASH_CRC32) {
+        return rss->use_sse42 ? "CRC32C (SSE4.2)" : "CRC32C (table)";
+    }
+    return "symmetric Toeplitz";
+}
+
+// Tuple fields of one packet (addresses point into the packet)
+typedef struct {
+    const uint8_t *src;
+    const uint8_t *dst;
+    uint32_t addr_len;               // 4 or 16, 0 if not IP
+    const uint8_t *ports;            // Source and destination port, NULL if not hashed
+} rss_tuple_t;
+
+static void parse_tuple(const uint8_t *data, uint32_t len, rss_tuple_t *t) {
+    t->addr_len = 0;
+    t->ports = NULL;
+
+    // Same L2 handling as flow_parse, so QinQ links spread across workers too
+    uint16_t ethertype;
+    uint32_t off = flow_l2_parse(data, len, &ethertype);
+    if (off == 0) return;
+
+    uint32_t l4 = 0;
+    uint8_t proto = 0;
+    if (ethertype == 0x0800 && len >= off + 20) {
+        const uint8_t *ip = data + off;
+        t->src = ip + 12;
+        t->dst = ip + 16;
+        t->addr_len = 4;
+        // Fragments are hashed on addresses only so all of a datagram goes to one queue
+        if ((ip[6] & 0x3F) == 0 && ip[7] == 0) {
+            proto = ip[9];
+            l4 = off + (ip[0] & 0x0F) * 4u;
+        }
+    } else if (ethertype == 0x86DD && len >= off + 40) {
+        const uint8_t *ip = data + off;
+        t->src = ip + 8;
+        t->dst = ip + 24;
+        t->addr_len = 16;
+        proto = ip[6];
+        l4 = off + 40;
+    }
+    if ((proto == 6 || proto == 17) && len >= l4 + 4) {
+        t->ports = data + l4;
+    }
+}
+
+static inline uint32_t hash_toeplitz(const rss_t *rss, const rss_tuple_t *t) {
+    uint32_t x = 0, w;
+    for (uint32_t i = 0; i < t->addr_len; i += 4) {
+        memcpy(&w, t->src + i, 4);
+        x ^= w;
+        memcpy(&w, t->dst + i, 4);
+        x ^= w;
+    }
+    if (t->ports) {
+        memcpy(&w, t->ports, 4);
+        x ^= w;
+    }
+    // Fold to one even-offset and one odd-offset byte
+    uint8_t b[4];
+    memcpy(b, &x, 4);
+    return rss->toeplitz[0][b[0] ^ b[2]] ^ rss->toeplitz[1][b[1] ^ b[3]];
+}
+
+// Lower endpoint first so both directions produce the same input
+static uint32_t ordered_tuple(const rss_tuple_t *t, uint8_t *buf) {
+    const uint8_t *a = t->src, *b = t->dst;
+    uint16_t pa = 0, pb = 0;
+    if (t->ports) {
+        memcpy(&pa, t->ports, 2);
+        memcpy(&pb, t->ports + 2, 2);
+    }
+    int cmp = memcmp(a, b, t->addr_len);
+    if (cmp > 0 || (cmp == 0 && pa > pb)) {
+        const uint8_t *tmp = a;
+        a = b;
+        b = tmp;
+        uint16_t p = pa;
+        pa = pb;
+        pb = p;
+    }
+    memcpy(buf, a, t->addr_len);
+    memcpy(buf + t->addr_len, b, t->addr_len);
+    memcpy(buf + 2 * t->addr_len, &pa, 2);
+    memcpy(buf + 2 * t->addr_len + 2, &pb, 2);
+    return 2 * t->addr_len + 4;
+}
+
+#ifdef RSS_HAVE_CRC32
+__attribute__((target("sse4.2")))
+static uint32_t crc32c_hw(const uint8_t *buf, uint32_t len) {
+    uint32_t crc = 0xFFFFFFFFu;
+    for (uint32_t i = 0; i < len; i += 4) {
+        uint32_t w;
+        memcpy(&w, buf + i, 4);
+        crc = _mm_crc32_u32(crc, w);
+    }
+    return ~crc;
+}
+#endif
+
+static uint32_t crc32c_sw(const rss_t *rss, const uint8_t *buf, uint32_t len) {
+    uint32_t crc = 0xFFFFFFFFu;
+    for (uint32_t i = 0; i < len; i++) {
+        crc = rss->crc_table[(crc ^ buf[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+// Hash a burst of at most RSS_MAX_BURST packets: tuples are extracted first,
+// then hashed in a tight loop
+void rss_hash_burst(const rss_t *rss, const pipe_desc_t *descs, uint32_t n, uint32_t *hashes) {
+    rss_tuple_t tuples[RSS_MAX_BURST];
+    if (n > RSS_MAX_BURST) n = RSS_MAX_BURST;
+    for (uint32_t i = 0; i < n; i++) {
+        parse_tuple(descs[i].data, descs[i].len, &tuples[i]);
+    }
+
+    if (rss->type == RSS_HASH_TOEPLITZ) {
+        for (uint32_t i = 0; i < n; i++) {
+            hashes[i] = hash_toeplitz(rss, &tuples[i]);
+        }
+        return;
+    }
+
+    uint8_t buf[36];
+    for (uint32_t i = 0; i < n; i++) {
+        if (tuples[i].addr_len == 0) {
+            hashes[i] = 0;
+            continue;
+        }
+        uint32_t len = ordered_tuple(&tuples[i], buf);
+#ifdef RSS_HAVE_CRC32
+        if (rss->use_sse42) {
+            hashes[i] = crc32c_hw(buf, len);
+            continue;
+        }
+#endif
+        hashes[i] = crc32c_sw(rss, buf, len);
+    }
+}
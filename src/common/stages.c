@@ -0,0 +1,214 @@
+#define _DEFAULT_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "../../include/stages.h"
+#include "../../include/flow.h"
+
+// With reassembly on, TCP payload reaches the matcher as in-order stream bytes,
+// so patterns split across segments are found and retransmissions are not rescanned
+static void stream_to_dpi(void *ctx, const flow_key_t *key, uint32_t *state,
+                          const uint8_t *data, uint32_t len) {
+    (void)key;
+    dpi_scan_stream((dpi_t *)ctx, state, data, len);
+}
+
+static void link_stages(stages_t *stages) {
+    if (stages->reasm && stages->dpi) {
+        reasm_set_callback(stages->reasm, stream_to_dpi, stages->dpi);
+    }
+}
+
+bool stages_enabled(const config_t *config) {
+    return config->hh_topk > 0 || config->dpi_patterns[0] || config->reasm_enabled ||
+           config->write_file[0] || config->probe_enabled || config->tap_path[0];
+}
+
+stages_t* stages_create(const config_t *config) {
+    stages_t *stages = calloc(1, sizeof(stages_t));
+    if (!stages) return NULL;
+
+    if (config->hh_topk > 0) {
+        stages->hh = hh_sketch_create(config->hh_key, config->hh_topk, config->hh_memory_kb);
+        if (!stages->hh) {
+            stages_destroy(stages);
+            return NULL;
+        }
+    }
+
+    if (config->dpi_patterns[0]) {
+        stages->dpi_ac = dpi_automaton_load(config->dpi_patterns);
+        stages->dpi = stages->dpi_ac ? dpi_create(stages->dpi_ac) : NULL;
+        if (!stages->dpi) {
+            stages_destroy(stages);
+            return NULL;
+        }
+    }
+
+    if (config->reasm_enabled) {
+        stages->reasm = reasm_create(config->reasm_max_flows, config->reasm_flow_kb,
+                                     config->reasm_mem_mb, config->reasm_timeout_sec);
+        if (!stages->reasm) {
+            stages_destroy(stages);
+            return NULL;
+        }
+    }
+
+    if (config->write_file[0]) {
+        stages->capture = capture_open(config->write_file, config->write_pcapng, config->snaplen);
+        if (!stages->capture) {
+            stages_destroy(stages);
+            return NULL;
+        }
+    }
+
+    if (config->tap_path[0]) {
+        stages->tap = tap_open(config->tap_path, config->tap_slots);
+        if (!stages->tap) {
+            stages_destroy(stages);
+            return NULL;
+        }
+    }
+
+    if (config->probe_enabled) {
+        stages->probe = probe_create();
+        if (!stages->probe) {
+            stages_destroy(stages);
+            return NULL;
+        }
+    }
+    link_stages(stages);
+    return stages;
+}
+
+// Instance for another thread (a worker or another source): shares the parent's
+// compiled pattern set instead of loading it again. Capture and the tap come
+// from config, so callers that keep them on the parent clear them there.
+stages_t* stages_clone(const stages_t *parent, const config_t *config) {
+    config_t cfg = *config;
+    cfg.dpi_patterns[0] = '\0';
+
+    stages_t *stages = stages_create(&cfg);
+    if (!stages) return NULL;
+
+    if (parent->dpi_ac) {
+        stages->dpi_ac = parent->dpi_ac;
+        stages->dpi_ac_shared = true;
+        stages->dpi = dpi_create(parent->dpi_ac);
+        if (!stages->dpi) {
+            stages_destroy(stages);
+            return NULL;
+        }
+    }
+    link_stages(stages);
+    return stages;
+}
+
+void stages_process(stages_t *stages, const uint8_t *data, uint32_t len) {
+    pkt_info_t info;
+
+    if (stages->capture) {
+        capture_packet(stages->capture, data, len);
+    }
+    if (stages->tap) {
+        tap_publish(stages->tap, data, len);
+    }
+
+    // Headers are parsed once and shared by every stage
+    if (flow_parse(data, len, &info) != 0) {
+        if (stages->hh) hh_sketch_skip(stages->hh);
+        return;
+    }
+
+    if (stages->hh) {
+        hh_sketch_update(stages->hh, &info, len);
+    }
+    // Packets reassembly tracks are matched from the stream callback instead
+    bool streamed = stages->reasm && reasm_process(stages->reasm, &info, data);
+    if (stages->dpi && !streamed) {
+        dpi_scan(stages->dpi, data + info.payload_offset, info.payload_len);
+    }
+    if (stages->probe) {
+        probe_process(stages->probe, &info, data);
+    }
+}
+
+int stages_merge(stages_t *dst, const stages_t *src) {
+    if (!dst || !src) return -1;
+
+    if (dst->hh && src->hh && hh_sketch_merge(dst->hh, src->hh) != 0) {
+        return -1;
+    }
+    if (dst->dpi && src->dpi && dpi_merge(dst->dpi, src->dpi) != 0) {
+        return -1;
+    }
+    if (dst->reasm && src->reasm && reasm_merge(dst->reasm, src->reasm) != 0) {
+        return -1;
+    }
+    if (dst->probe && src->probe && probe_merge(dst->probe, src->probe) != 0) {
+        return -1;
+    }
+    return 0;
+}
+
+// Flush outputs once reception has stopped
+void stages_finish(stages_t *stages) {
+    if (!stages) return;
+
+    if (stages->capture) {
+        capture_close(stages->capture);
+    }
+    if (stages->tap) {
+        tap_close(stages->tap);
+    }
+}
+
+// Per-source outputs only, for runs that report the analysis stages merged
+void stages_report_outputs(const stages_t *stages) {
+    if (!stages) return;
+
+    if (stages->capture) {
+        capture_report(stages->capture);
+    }
+    if (stages->tap) {
+        tap_report(stages->tap);
+    }
+}
+
+void stages_report(const stages_t *stages) {
+    if (!stages) return;
+
+    if (stages->hh) {
+        hh_sketch_report(stages->hh);
+    }
+    if (stages->dpi) {
+        dpi_report(stages->dpi);
+    }
+    if (stages->reasm) {
+        reasm_report(stages->reasm);
+    }
+    if (stages->capture) {
+        capture_report(stages->capture);
+    }
+    if (stages->tap) {
+        tap_report(stages->tap);
+    }
+    if (stages->probe) {
+        probe_report(stages->probe);
+    }
+}
+
+void stages_destroy(stages_t *stages) {
+    if (!stages) return;
+    hh_sketch_destroy(stages->hh);
+    dpi_destroy(stages->dpi);
+    if (!stages->dpi_ac_shared) {
+        dpi_automaton_destroy(stages->dpi_ac);
+    }
+    reasm_destroy(stages->reasm);
+    capture_destroy(stages->capture);
+    tap_destroy(stages->tap);
+    probe_destroy(stages->probe);
+    free(stages);
+}
@@ -5,7 +5,10 @@
 #include <stdint.h>
 #include <unistd.h>
 #include <time.h>
+#include <errno.h>
 #include "../../include/common.h"
+#include "../../include/probe.h"
+#include "../../include/placement.h"
 
 void stats_init(stats_t *stats) {
     if (!stats) return;
@@ -25,6 +28,45 @@ void stats_update(stats_t *stats, uint32_t packet_size) {
     pthread_mutex_unlock(&stats->mutex);
 }
 
+// One lock round trip per burst instead of per packet
+void stats_update_batch(stats_t *stats, uint32_t packets, uint64_t bytes) {
+    if (!stats || packets == 0) return;
+
+    pthread_mutex_lock(&stats->mutex);
+
+    stats->packets_received += packets;
+    stats->bytes_received += bytes;
+
+    pthread_mutex_unlock(&stats->mutex);
+}
+
+void stats_update_forward(stats_t *stats, uint32_t sent, uint32_t dropped) {
+    if (!stats) return;
+
+    pthread_mutex_lock(&stats->mutex);
+
+    stats->packets_forwarded += sent;
+    stats->forward_dropped += dropped;
+
+    pthread_mutex_unlock(&stats->mutex);
+}
+
+// Adds one source's counters to a total spanning all of them
+void stats_accumulate(stats_t *total, const stats_t *stats) {
+    if (!total || !stats) return;
+
+    total->packets_received += stats->packets_received;
+    total->bytes_received += stats->bytes_received;
+    total->packets_forwarded += stats->packets_forwarded;
+    total->forward_dropped += stats->forward_dropped;
+    if (!total->start_time_ns || stats->start_time_ns < total->start_time_ns) {
+        total->start_time_ns = stats->start_time_ns;
+    }
+    if (stats->end_time_ns > total->end_time_ns) {
+        total->end_time_ns = stats->end_time_ns;
+    }
+}
+
 void stats_summarize(stats_t *stats) {
     if (!stats) return;
     
@@ -44,11 +86,152 @@ void stats_summarize(stats_t *stats) {
            stats->bytes_received, stats->bytes_received / (1024.0 * 1024.0));
     printf("Packet rate: %.2f PPS\n", stats->pps);
     printf("Bit rate: %.2f Mbps\n", stats->bps / 1e6);
+    if (stats->rx_loop) {
+        printf("Receive loop: %s\n", stats->rx_loop);
+    }
+    if (stats->cpu_time_ns) {
+        printf("CPU time: %.2f seconds (%.1f%% of one core)\n", stats->cpu_time_ns / 1e9,
+               runtime_ns ? stats->cpu_time_ns * 100.0 / runtime_ns : 0.0);
+    }
+    if (stats->packets_forwarded || stats->forward_dropped) {
+        printf("Packets forwarded: %lu (%.2f PPS), TX drops: %lu\n", stats->packets_forwarded,
+               runtime_sec > 0 ? stats->packets_forwarded / runtime_sec : 0.0, stats->forward_dropped);
+    }
     printf("=============================\n");
     
     pthread_mutex_unlock(&stats->mutex);
 }
 
+// Interface, PCI address or file the receiver reads from
+const char* device_name(const config_t *config) {
+    switch (config->mode) {
+        case MODE_DPDK: return config->address;
+        case MODE_PCAP: return config->pcap_file;
+        default: return config->interface;
+    }
+}
+
+static int parse_mode(const char *name, packet_mode_t *mode) {
+    if (strcmp(name, "socket") == 0) {
+        *mode = MODE_SOCKET;
+    } else if (strcmp(name, "af_xdp") == 0) {
+        *mode = MODE_AF_XDP;
+    } else if (strcmp(name, "dpdk") == 0) {
+        *mode = MODE_DPDK;
+    } else if (strcmp(name, "pcap") == 0) {
+        *mode = MODE_PCAP;
+    } else {
+        return -1;
+    }
+    return 0;
+}
+
+// --source mode:device; the device keeps any further colons (PCI addresses)
+static int parse_source(const char *spec, source_t *src) {
+    const char *colon = strchr(spec, ':');
+    if (!colon || !colon[1]) return -1;
+
+    char mode[16];
+    size_t n = (size_t)(colon - spec);
+    if (n >= sizeof(mode)) return -1;
+    memcpy(mode, spec, n);
+    mode[n] = '\0';
+    if (parse_mode(mode, &src->mode) != 0) return -1;
+
+    // Interfaces and PCI addresses must fit their config fields
+    size_t max = src->mode == MODE_PCAP ? sizeof(src->device) : sizeof(((config_t *)0)->interface);
+    if (strlen(colon + 1) >= max) return -1;
+    strncpy(src->device, colon + 1, sizeof(src->device) - 1);
+    src->device[sizeof(src->device) - 1] = '\0';
+    return 0;
+}
+
+const char* mode_name(packet_mode_t mode) {
+    switch (mode) {
+        case MODE_SOCKET: return "socket";
+        case MODE_AF_XDP: return "af_xdp";
+        case MODE_DPDK: return "dpdk";
+        case MODE_PCAP: return "pcap";
+        default: return "unknown";
+    }
+}
+
+// Counters shared by the run object and each source object
+static void write_json_counters(FILE *f, const stats_t *stats) {
+    double runtime_sec = (stats->end_time_ns - stats->start_time_ns) / 1e9;
+    fprintf(f, "\"runtime_sec\": %.6f, ", runtime_sec);
+    fprintf(f, "\"rx_packets\": %lu, \"rx_bytes\": %lu, \"rx_pps\": %.2f, \"rx_bps\": %.2f, ",
+            stats->packets_received, stats->bytes_received,
+            runtime_sec > 0 ? stats->packets_received / runtime_sec : 0.0,
+            runtime_sec > 0 ? stats->bytes_received * 8.0 / runtime_sec : 0.0);
+    fprintf(f, "\"fwd_packets\": %lu, \"fwd_dropped\": %lu",
+            stats->packets_forwarded, stats->forward_dropped);
+    if (stats->rx_loop) {
+        fprintf(f, ", \"rx_loop\": \"%s\"", stats->rx_loop);
+    }
+}
+
+// Tuning in effect; fields a mode does not use stay 0 and are left out
+static void write_json_tuning(FILE *f, const config_t *config) {
+    if (config->batch_size) fprintf(f, ", \"batch\": %u", config->batch_size);
+    if (config->num_frames) fprintf(f, ", \"frames\": %u", config->num_frames);
+    if (config->ring_size) fprintf(f, ", \"ring_size\": %u", config->ring_size);
+    if (config->num_mbufs) fprintf(f, ", \"mbufs\": %u", config->num_mbufs);
+    if (config->mbuf_cache) fprintf(f, ", \"mbuf_cache\": %u", config->mbuf_cache);
+}
+
+// One flat JSON object per run, so scripts can pick fields without a JSON parser.
+// With several sources the run fields are totals and each source follows in "sources".
+int stats_write_json(const char *path, const stats_t *stats, const config_t *config,
+                     const struct probe *probe, const stats_t *const *source_stats,
+                     const config_t *const *source_configs, uint32_t num_sources) {
+    FILE *f = fopen(path, "w");
+    if (!f) {
+        fprintf(stderr, "Error: Failed to open %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+
+    if (num_sources > 1) {
+        fprintf(f, "{\"mode\": \"multi\", \"interface\": \"");
+        for (uint32_t i = 0; i < num_sources; i++) {
+            fprintf(f, "%s%s", i ? "," : "", device_name(source_configs[i]));
+        }
+        fprintf(f, "\", ");
+    } else {
+        fprintf(f, "{\"mode\": \"%s\", \"interface\": \"%s\", ", mode_name(config->mode),
+                device_name(config));
+    }
+    write_json_counters(f, stats);
+    fprintf(f, ", \"cpu_sec\": %.6f", stats->cpu_time_ns / 1e9);
+    if (num_sources <= 1) {
+        write_json_tuning(f, config);
+    }
+
+    if (probe) {
+        probe_summary_t s;
+        probe_summarize(probe, &s);
+        fprintf(f, ", \"probe_packets\": %lu, \"probe_expected\": %lu, \"probe_lost\": %lu, "
+                   "\"probe_reordered\": %lu, \"probe_flows\": %u, ",
+                s.packets, s.expected, s.lost, s.reordered, s.flows);
+        fprintf(f, "\"lat_min_ns\": %lu, \"lat_avg_ns\": %.1f, \"lat_p50_ns\": %lu, "
+                   "\"lat_p99_ns\": %lu, \"lat_p999_ns\": %lu, \"lat_max_ns\": %lu",
+                s.lat_min_ns, s.lat_avg_ns, s.lat_p50_ns, s.lat_p99_ns, s.lat_p999_ns, s.lat_max_ns);
+    }
+    if (num_sources > 1) {
+        fprintf(f, ", \"sources\": [");
+        for (uint32_t i = 0; i < num_sources; i++) {
+            fprintf(f, "%s{\"mode\": \"%s\", \"interface\": \"%s\", ", i ? ", " : "",
+                    mode_name(source_configs[i]->mode), device_name(source_configs[i]));
+            write_json_counters(f, source_stats[i]);
+            write_json_tuning(f, source_configs[i]);
+            fprintf(f, "}");
+        }
+        fprintf(f, "]");
+    }
+    fprintf(f, "}\n");
+    return fclose(f) == 0 ? 0 : -1;
+}
+
 void stats_cleanup(stats_t *stats) {
     if (!stats) return;
     pthread_mutex_destroy(&stats->mutex);
@@ -60,6 +243,13 @@ uint64_t get_time_ns(void) {
     return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
 }
 
+// CPU time of every thread in the process
+uint64_t get_cpu_time_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
 void print_banner(void) {
     printf("\n");
     printf("╔═════════════════════════════════════════════╗\n");
@@ -79,16 +269,57 @@ int parse_args(int argc, char *argv[], config_t *config) {
     config->timeout_ms = 1000;
     config->verbose = false;
     config->duration_sec = 0;
+    config->pcap_file[0] = '\0';
+    config->replay_speed = 0;
+    config->replay_loops = 1;
+    config->hh_topk = 0;
+    config->hh_memory_kb = 256;
+    config->hh_key = HH_KEY_SRC;
+    config->dpi_patterns[0] = '\0';
+    config->reasm_enabled = false;
+    config->reasm_max_flows = 65536;
+    config->reasm_flow_kb = 256;
+    config->reasm_mem_mb = 64;
+    config->reasm_timeout_sec = 30;
+    config->write_file[0] = '\0';
+    config->write_pcapng = false;
+    config->snaplen = 65535;
+    config->tap_path[0] = '\0';
+    config->tap_slots = 16384;
+    config->probe_enabled = false;
+    config->forward = false;
+    config->out_interface[0] = '\0';
+    config->out_address[0] = '\0';
+    config->json_file[0] = '\0';
+    config->workers = 0;
+    config->worker_ring = 1024;
+    config->rss_hash = RSS_HASH_TOEPLITZ;
+    config->num_cpus = 0;
+    config->numa_node = -1;
+    config->hugepages = true;
+    config->generic_loop = false;
+    config->batch_size = 0;
+    config->num_frames = 0;
+    config->ring_size = 0;
+    config->num_mbufs = 0;
+    config->mbuf_cache = 0;
+    config->num_sources = 0;
     
     for (int i = 1; i < argc; i++) {
         if (strcmp(argv[i], "--mode") == 0 && i + 1 < argc) {
-            if (strcmp(argv[i + 1], "socket") == 0) {
-                config->mode = MODE_SOCKET;
-            } else if (strcmp(argv[i + 1], "af_xdp") == 0) {
-                config->mode = MODE_AF_XDP;
-            } else if (strcmp(argv[i + 1], "dpdk") == 0) {
-                config->mode = MODE_DPDK;
+            parse_mode(argv[i + 1], &config->mode);
+            i++;
+        } else if (strcmp(argv[i], "--source") == 0 && i + 1 < argc) {
+            if (config->num_sources == MAX_SOURCES) {
+                fprintf(stderr, "Error: At most %d sources are supported\n", MAX_SOURCES);
+                return -1;
             }
+            if (parse_source(argv[i + 1], &config->sources[config->num_sources]) != 0) {
+                fprintf(stderr, "Error: Invalid source %s (expected <socket|af_xdp|dpdk|pcap>:<device>)\n",
+                        argv[i + 1]);
+                return -1;
+            }
+            config->num_sources++;
             i++;
         } else if ((strcmp(argv[i], "--interface") == 0 || strcmp(argv[i], "-i") == 0) && i + 1 < argc) {
             strncpy(config->interface, argv[i + 1], sizeof(config->interface) - 1);
@@ -99,21 +330,249 @@ int parse_args(int argc, char *argv[], config_t *config) {
         } else if (strcmp(argv[i], "--duration") == 0 && i + 1 < argc) {
             config->duration_sec = atoi(argv[i + 1]);
             i++;
+        } else if ((strcmp(argv[i], "--file") == 0 || strcmp(argv[i], "-f") == 0) && i + 1 < argc) {
+            strncpy(config->pcap_file, argv[i + 1], sizeof(config->pcap_file) - 1);
+            i++;
+        } else if (strcmp(argv[i], "--replay-speed") == 0 && i + 1 < argc) {
+            config->replay_speed = atof(argv[i + 1]);
+            i++;
+        } else if (strcmp(argv[i], "--loop") == 0 && i + 1 < argc) {
+            config->replay_loops = atoi(argv[i + 1]);
+            i++;
+        } else if (strcmp(argv[i], "--top-talkers") == 0 && i + 1 < argc) {
+            int k = atoi(argv[i + 1]);
+            if (k <= 0 || k > HH_MAX_TOPK) {
+                fprintf(stderr, "Error: --top-talkers must be 1-%d\n", HH_MAX_TOPK);
+                return -1;
+            }
+            config->hh_topk = (uint32_t)k;
+            i++;
+        } else if (strcmp(argv[i], "--hh-memory") == 0 && i + 1 < argc) {
+            int kb = atoi(argv[i + 1]);
+            if (kb <= 0 || (uint32_t)kb > HH_MAX_MEMORY_KB) {
+                fprintf(stderr, "Error: --hh-memory must be 1-%u KB\n", HH_MAX_MEMORY_KB);
+                return -1;
+            }
+            config->hh_memory_kb = (uint32_t)kb;
+            i++;
+        } else if (strcmp(argv[i], "--hh-key") == 0 && i + 1 < argc) {
+            if (strcmp(argv[i + 1], "src") == 0) {
+                config->hh_key = HH_KEY_SRC;
+            } else if (strcmp(argv[i + 1], "dst") == 0) {
+                config->hh_key = HH_KEY_DST;
+            } else if (strcmp(argv[i + 1], "flow") == 0) {
+                config->hh_key = HH_KEY_FLOW;
+            }
+            i++;
+        } else if (strcmp(argv[i], "--patterns") == 0 && i + 1 < argc) {
+            strncpy(config->dpi_patterns, argv[i + 1], sizeof(config->dpi_patterns) - 1);
+            i++;
+        } else if (strcmp(argv[i], "--reassembly") == 0) {
+            config->reasm_enabled = true;
+        } else if (strcmp(argv[i], "--reasm-flows") == 0 && i + 1 < argc) {
+            config->reasm_max_flows = atoi(argv[i + 1]);
+            i++;
+        } else if (strcmp(argv[i], "--reasm-flow-mem") == 0 && i + 1 < argc) {
+            config->reasm_flow_kb = atoi(argv[i + 1]);
+            i++;
+        } else if (strcmp(argv[i], "--reasm-mem") == 0 && i + 1 < argc) {
+            config->reasm_mem_mb = atoi(argv[i + 1]);
+            i++;
+        } else if (strcmp(argv[i], "--reasm-timeout") == 0 && i + 1 < argc) {
+            config->reasm_timeout_sec = atoi(argv[i + 1]);
+            i++;
+        } else if ((strcmp(argv[i], "--write") == 0 || strcmp(argv[i], "-w") == 0) && i + 1 < argc) {
+            strncpy(config->write_file, argv[i + 1], sizeof(config->write_file) - 1);
+            size_t n = strlen(config->write_file);
+            if (n > 7 && strcmp(config->write_file + n - 7, ".pcapng") == 0) {
+                config->write_pcapng = true;
+            }
+            i++;
+        } else if (strcmp(argv[i], "--pcapng") == 0) {
+            config->write_pcapng = true;
+        } else if (strcmp(argv[i], "--snaplen") == 0 && i + 1 < argc) {
+            config->snaplen = atoi(argv[i + 1]);
+            if (config->snaplen == 0 || config->snaplen > 65535) config->snaplen = 65535;
+            i++;
+        } else if (strcmp(argv[i], "--tap") == 0 && i + 1 < argc) {
+            strncpy(config->tap_path, argv[i + 1], sizeof(config->tap_path) - 1);
+            i++;
+        } else if (strcmp(argv[i], "--tap-slots") == 0 && i + 1 < argc) {
+            config->tap_slots = atoi(argv[i + 1]);
+            i++;
+        } else if (strcmp(argv[i], "--forward") == 0) {
+            config->forward = true;
+        } else if (strcmp(argv[i], "--out-interface") == 0 && i + 1 < argc) {
+            strncpy(config->out_interface, argv[i + 1], sizeof(config->out_interface) - 1);
+            config->forward = true;
+            i++;
+        } else if (strcmp(argv[i], "--out-address") == 0 && i + 1 < argc) {
+            strncpy(config->out_address, argv[i + 1], sizeof(config->out_address) - 1);
+            config->forward = true;
+            i++;
+        } else if (strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+            strncpy(config->json_file, argv[i + 1], sizeof(config->json_file) - 1);
+            i++;
+        } else if (strcmp(argv[i], "--workers") == 0 && i + 1 < argc) {
+            config->workers = atoi(argv[i + 1]);
+            i++;
+        } else if (strcmp(argv[i], "--worker-ring") == 0 && i + 1 < argc) {
+            config->worker_ring = atoi(argv[i + 1]);
+            i++;
+        } else if (strcmp(argv[i], "--cpus") == 0 && i + 1 < argc) {
+            int n = placement_parse_cpus(argv[i + 1], config->cpus, MAX_CPUS);
+            if (n < 0) {
+                fprintf(stderr, "Error: Invalid CPU list: %s\n", argv[i + 1]);
+                return -1;
+            }
+            config->num_cpus = (uint32_t)n;
+            i++;
+        } else if (strcmp(argv[i], "--batch") == 0 && i + 1 < argc) {
+            config->batch_size = atoi(argv[i + 1]);
+            i++;
+        } else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            config->num_frames = atoi(argv[i + 1]);
+            i++;
+        } else if (strcmp(argv[i], "--ring-size") == 0 && i + 1 < argc) {
+            config->ring_size = atoi(argv[i + 1]);
+            i++;
+        } else if (strcmp(argv[i], "--mbufs") == 0 && i + 1 < argc) {
+            config->num_mbufs = atoi(argv[i + 1]);
+            i++;
+        } else if (strcmp(argv[i], "--mbuf-cache") == 0 && i + 1 < argc) {
+            config->mbuf_cache = atoi(argv[i + 1]);
+            i++;
+        } else if (strcmp(argv[i], "--generic-loop") == 0) {
+            config->generic_loop = true;
+        } else if (strcmp(argv[i], "--no-hugepages") == 0) {
+            config->hugepages = false;
+        } else if (strcmp(argv[i], "--rss") == 0 && i + 1 < argc) {
+            if (strcmp(argv[i + 1], "toeplitz") == 0) {
+                config->rss_hash = RSS_HASH_TOEPLITZ;
+            } else if (strcmp(argv[i + 1], "crc32") == 0) {
+                config->rss_hash = RSS_HASH_CRC32;
+            }
+            i++;
+        } else if (strcmp(argv[i], "--probe") == 0) {
+            config->probe_enabled = true;
         } else if (strcmp(argv[i], "--verbose") == 0 || strcmp(argv[i], "-v") == 0) {
             config->verbose = true;
         } else if (strcmp(argv[i], "--help") == 0 || strcmp(argv[i], "-h") == 0) {
             printf("Usage: %s [options]\n", argv[0]);
             printf("Options:\n");
-            printf("  --mode <socket|af_xdp|dpdk>  Receive mode (default: socket)\n");
+            printf("  --mode <socket|af_xdp|dpdk|pcap>  Receive mode (default: socket)\n");
             printf("  --interface <name>, -i       Network interface (default: eth0)\n");
             printf("  --address <pci address>, -a  PCI address (default: 0000:03:00.0), used for DPDK mode\n");
+            printf("  --source <mode>:<device>     Receive from several sources at once, e.g. af_xdp:eth0 dpdk:0000:13:00.0\n");
+            printf("                               (repeatable, replaces --mode/--interface/--address/--file;\n");
+            printf("                               --cpus lists the sources' receive CPUs first)\n");
             printf("  --duration <seconds>         Runtime duration (0=infinite, default: 0)\n");
+            printf("  --file <pcap>, -f            Capture file replayed in pcap mode\n");
+            printf("  --replay-speed <factor>      Replay at recorded timing scaled by factor (0=max speed, default: 0)\n");
+            printf("  --loop <N>                   Replay the file N times (0=until stopped, default: 1)\n");
+            printf("  --top-talkers <K>            Report the K heaviest talkers (Count-Min sketch, K <= %d)\n", HH_MAX_TOPK);
+            printf("  --hh-memory <KB>             Memory budget incl. top-K heap (default: 256)\n");
+            printf("  --hh-key <src|dst|flow>      Heavy hitter key (default: src)\n");
+            printf("  --patterns <file>            Count payload matches against a pattern file (one per line)\n");
+            printf("  --reassembly                 Reassemble TCP byte streams\n");
+            printf("  --reasm-flows <N>            Max tracked TCP flows (default: 65536)\n");
+            printf("  --reasm-flow-mem <KB>        Max out-of-order bytes per flow (default: 256)\n");
+            printf("  --reasm-mem <MB>             Segment pool size (default: 64)\n");
+            printf("  --reasm-timeout <seconds>    Idle flow timeout (default: 30)\n");
+            printf("  --write <file>, -w           Record packets to a pcap file (pcapng if the name ends in .pcapng)\n");
+            printf("  --pcapng                     Write pcapng regardless of the file name\n");
+            printf("  --snaplen <bytes>            Truncate recorded packets (default: 65535)\n");
+            printf("  --tap <socket>               Publish packets to a shared-memory ring for tap clients\n");
+            printf("  --tap-slots <N>              Tap ring size in packets (default: 16384)\n");
+            printf("  --forward                    Swap MACs and send every received packet back out\n");
+            printf("  --out-interface <name>       Forward out of another interface (socket, AF_XDP)\n");
+            printf("  --out-address <pci address>  Forward out of another port (DPDK)\n");
+            printf("  --workers <N>                Process packets on N worker threads fed over SPSC rings (default: 0)\n");
+            printf("  --worker-ring <N>            Descriptors per worker ring (default: 1024)\n");
+            printf("  --cpus <list>                Pin the receive thread to the first CPU and workers to the rest, e.g. 2,4-7\n");
+            printf("  --generic-loop               Use the unspecialized receive loop (benchmark baseline)\n");
+            printf("  --batch <N>                  Packets per receive burst (default: 32 socket/DPDK, 64 AF_XDP/pcap)\n");
+            printf("  --frames <N>                 AF_XDP UMEM frames (default: 4096)\n");
+            printf("  --ring-size <N>              AF_XDP RX/Fill ring or DPDK RX descriptors (default: 2048/1024)\n");
+            printf("  --mbufs <N>                  DPDK mempool size (default: 8191)\n");
+            printf("  --mbuf-cache <N>             DPDK per-lcore mempool cache (default: 250)\n");
+            printf("  --no-hugepages               Map buffers with regular pages only\n");
+            printf("  --rss <toeplitz|crc32>       Hash spreading flows over workers (default: toeplitz)\n");
+            printf("  --probe                      Measure loss, reordering and latency of packet_sender traffic\n");
+            printf("  --json <file>                Write the run summary to a JSON file\n");
             printf("  --verbose, -v                Verbose output\n");
             printf("  --help, -h                   Show this help\n");
             return 1;
         }
     }
     
+    if (config->forward && config->mode == MODE_PCAP && config->num_sources == 0) {
+        fprintf(stderr, "Error: Forwarding needs a network interface, not available in pcap mode\n");
+        return -1;
+    }
+    for (uint32_t i = 0; i < config->num_sources; i++) {
+        if (config->forward && config->sources[i].mode == MODE_PCAP) {
+            fprintf(stderr, "Error: Forwarding needs a network interface, not available for %s\n",
+                    config->sources[i].device);
+            return -1;
+        }
+    }
+    if (config->num_sources > 1 && (config->out_interface[0] || config->out_address[0])) {
+        fprintf(stderr, "Error: With several sources, forwarding reflects each one on its own port\n");
+        return -1;
+    }
+    if (config->num_sources > 1 && config->num_cpus > 0 && config->num_cpus < config->num_sources) {
+        fprintf(stderr, "Error: --cpus needs at least one CPU per source\n");
+        return -1;
+    }
+    if (config->reasm_max_flows == 0 || config->reasm_max_flows > REASM_MAX_FLOWS) {
+        fprintf(stderr, "Error: --reasm-flows must be 1-%u\n", REASM_MAX_FLOWS);
+        return -1;
+    }
+    if (config->reasm_flow_kb == 0 || config->reasm_flow_kb > REASM_MAX_FLOW_KB) {
+        fprintf(stderr, "Error: --reasm-flow-mem must be 1-%u KB\n", REASM_MAX_FLOW_KB);
+        return -1;
+    }
+    if (config->reasm_mem_mb == 0 || config->reasm_mem_mb > REASM_MAX_MEM_MB) {
+        fprintf(stderr, "Error: --reasm-mem must be 1-%u MB\n", REASM_MAX_MEM_MB);
+        return -1;
+    }
+    if (config->reasm_timeout_sec == 0 || config->reasm_timeout_sec > 86400) {
+        fprintf(stderr, "Error: --reasm-timeout must be 1-86400 seconds\n");
+        return -1;
+    }
+    if (config->batch_size > RX_MAX_BATCH) {
+        fprintf(stderr, "Error: --batch must be at most %d\n", RX_MAX_BATCH);
+        return -1;
+    }
+    if (config->ring_size > RX_MAX_RING) {
+        fprintf(stderr, "Error: --ring-size must be at most %d\n", RX_MAX_RING);
+        return -1;
+    }
+    if (config->num_frames > RX_MAX_FRAMES) {
+        fprintf(stderr, "Error: --frames must be at most %u\n", RX_MAX_FRAMES);
+        return -1;
+    }
+    if (config->num_mbufs > RX_MAX_MBUFS) {
+        fprintf(stderr, "Error: --mbufs must be at most %u\n", RX_MAX_MBUFS);
+        return -1;
+    }
+    if (config->mbuf_cache > RX_MAX_MBUF_CACHE) {
+        fprintf(stderr, "Error: --mbuf-cache must be at most %d\n", RX_MAX_MBUF_CACHE);
+        return -1;
+    }
+    if (config->worker_ring == 0 || config->worker_ring > WORKER_MAX_RING) {
+        fprintf(stderr, "Error: --worker-ring must be 1-%u\n", WORKER_MAX_RING);
+        return -1;
+    }
+    if (config->tap_slots == 0 || config->tap_slots > TAP_MAX_SLOTS) {
+        fprintf(stderr, "Error: --tap-slots must be 1-%u\n", TAP_MAX_SLOTS);
+        return -1;
+    }
+    if (config->forward && config->workers) {
+        fprintf(stderr, "Error: Forwarding runs on the receive thread and cannot be combined with --workers\n");
+        return -1;
+    }
     return 0;
 }
 
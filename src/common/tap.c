@@ -0,0 +1,276 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <unistd.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "../../include/common.h"
+#include "../../include/tap.h"
+
+#define TAP_HUGE_PAGE (2UL << 20)
+#define TAP_ACCEPT_POLL_MS 200
+
+struct tap {
+    tap_shm_t *shm;
+    tap_desc_t *descs;
+    uint8_t *data;
+    uint32_t mask;
+    uint64_t head;                   // Producer's copy of shm->head
+    int memfd;
+    size_t map_len;
+    bool huge;
+
+    int listen_fd;
+    char path[108];
+    pthread_t acceptor;
+    bool acceptor_started;
+    _Atomic bool stop;
+    uint64_t clients_served;
+
+    uint64_t start_ns;
+    uint64_t end_ns;
+    uint64_t bytes;
+    uint64_t truncated;
+};
+
+// Map the ring from a memfd, on 2 MB hugepages if the kernel has them reserved
+static int map_ring(tap_t *tap, size_t size) {
+    size_t huge_size = (size + TAP_HUGE_PAGE - 1) & ~(TAP_HUGE_PAGE - 1);
+
+    tap->memfd = memfd_create("packet_datapath_tap", MFD_CLOEXEC | MFD_HUGETLB);
+    if (tap->memfd >= 0) {
+        if (ftruncate(tap->memfd, (off_t)huge_size) == 0) {
+            void *addr = mmap(NULL, huge_size, PROT_READ | PROT_WRITE, MAP_SHARED, tap->memfd, 0);
+            if (addr != MAP_FAILED) {
+                tap->shm = addr;
+                tap->map_len = huge_size;
+                tap->huge = true;
+                return 0;
+            }
+        }
+        close(tap->memfd);
+    }
+
+    tap->memfd = memfd_create("packet_datapath_tap", MFD_CLOEXEC);
+    if (tap->memfd < 0) {
+        fprintf(stderr, "Error: memfd_create: %s\n", strerror(errno));
+        return -1;
+    }
+    if (ftruncate(tap->memfd, (off_t)size) != 0) {
+        fprintf(stderr, "Error: Failed to size the tap ring: %s\n", strerror(errno));
+        return -1;
+    }
+    void *addr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, tap->memfd, 0);
+    if (addr == MAP_FAILED) {
+        fprintf(stderr, "Error: Failed to map the tap ring: %s\n", strerror(errno));
+        return -1;
+    }
+    tap->shm = addr;
+    tap->map_len = size;
+    return 0;
+}
+
+// Hand the ring's fd to one client over the unix socket
+static void send_fd(int conn, int fd) {
+    char byte = 'T';
+    struct iovec iov = { .iov_base = &byte, .iov_len = 1 };
+    union {
+        char buf[CMSG_SPACE(sizeof(int))];
+        struct cmsghdr align;
+    } ctrl;
+    memset(&ctrl, 0, sizeof(ctrl));
+
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = ctrl.buf;
+    msg.msg_controllen = sizeof(ctrl.buf);
+
+    struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+    memcpy(CMSG_DATA(cmsg), &fd, sizeof(int));
+
+    if (sendmsg(conn, &msg, MSG_NOSIGNAL) != 1) {
+        fprintf(stderr, "Warning: Failed to pass the tap ring to a client: %s\n", strerror(errno));
+    }
+}
+
+// Accepts clients off the receive path; the ring itself needs no coordination
+static void* acceptor_thread(void *arg) {
+    tap_t *tap = (tap_t *)arg;
+
+    while (!atomic_load(&tap->stop)) {
+        struct pollfd pfd = { .fd = tap->listen_fd, .events = POLLIN };
+        if (poll(&pfd, 1, TAP_ACCEPT_POLL_MS) <= 0) continue;
+
+        int conn = accept4(tap->listen_fd, NULL, NULL, SOCK_CLOEXEC);
+        if (conn < 0) continue;
+        send_fd(conn, tap->memfd);
+        close(conn);
+        tap->clients_served++;
+    }
+    return NULL;
+}
+
+static int listen_unix(tap_t *tap, const char *path) {
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        fprintf(stderr, "Error: Tap socket path too long: %s\n", path);
+        return -1;
+    }
+    strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+
+    tap->listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (tap->listen_fd < 0) {
+        fprintf(stderr, "Error: socket: %s\n", strerror(errno));
+        return -1;
+    }
+    unlink(path);
+    if (bind(tap->listen_fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 ||
+        listen(tap->listen_fd, TAP_MAX_CONSUMERS) != 0) {
+        fprintf(stderr, "Error: Failed to listen on %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+    strncpy(tap->path, path, sizeof(tap->path) - 1);
+    return 0;
+}
+
+tap_t* tap_open(const char *socket_path, uint32_t num_slots) {
+    if (num_slots > TAP_MAX_SLOTS) {
+        fprintf(stderr, "Error: Tap ring of %u slots exceeds %u\n", num_slots, TAP_MAX_SLOTS);
+        return NULL;
+    }
+    uint32_t slots = 64;
+    while (slots < num_slots) {
+        slots *= 2;
+    }
+
+    tap_t *tap = calloc(1, sizeof(tap_t));
+    if (!tap) return NULL;
+    tap->memfd = -1;
+    tap->listen_fd = -1;
+    atomic_init(&tap->stop, false);
+
+    size_t desc_offset = (sizeof(tap_shm_t) + 4095) & ~(size_t)4095;
+    size_t data_offset = desc_offset + (((size_t)slots * sizeof(tap_desc_t) + 4095) & ~(size_t)4095);
+    size_t size = data_offset + (size_t)slots * TAP_SLOT_SIZE;
+    if (map_ring(tap, size) != 0 || listen_unix(tap, socket_path) != 0) {
+        tap_destroy(tap);
+        return NULL;
+    }
+
+    tap_shm_t *shm = tap->shm;
+    shm->version = TAP_VERSION;
+    shm->num_slots = slots;
+    shm->slot_size = TAP_SLOT_SIZE;
+    shm->desc_offset = desc_offset;
+    shm->data_offset = data_offset;
+    shm->total_size = size;
+    tap->descs = (tap_desc_t *)((uint8_t *)shm + desc_offset);
+    tap->data = (uint8_t *)shm + data_offset;
+    tap->mask = slots - 1;
+    // Magic last: clients that see it see a complete header
+    atomic_thread_fence(memory_order_release);
+    shm->magic = TAP_MAGIC;
+
+    if (pthread_create(&tap->acceptor, NULL, acceptor_thread, tap) != 0) {
+        fprintf(stderr, "Error: Failed to start the tap acceptor thread\n");
+        tap_destroy(tap);
+        return NULL;
+    }
+    tap->acceptor_started = true;
+    tap->start_ns = get_time_ns();
+
+    printf("Tap: %u slots x %u bytes (%.2f MB, %s) on %s\n", slots, TAP_SLOT_SIZE,
+           size / (1024.0 * 1024.0), tap->huge ? "2M hugepages" : "regular pages", socket_path);
+    return tap;
+}
+
+void tap_publish(tap_t *tap, const uint8_t *data, uint32_t len) {
+    uint64_t pos = tap->head;
+    tap_desc_t *desc = &tap->descs[pos & tap->mask];
+    uint32_t caplen = len < TAP_SLOT_SIZE ? len : TAP_SLOT_SIZE;
+
+    // Odd sequence first so a reader of the previous lap sees the slot change
+    atomic_store_explicit(&desc->seq, 2 * pos + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    memcpy(tap->data + (size_t)(pos & tap->mask) * TAP_SLOT_SIZE, data, caplen);
+    desc->len = len;
+    desc->caplen = caplen;
+    desc->ts_ns = get_time_ns();
+
+    atomic_store_explicit(&desc->seq, 2 * pos + 2, memory_order_release);
+    tap->head = pos + 1;
+    atomic_store_explicit(&tap->shm->head, pos + 1, memory_order_release);
+
+    tap->bytes += len;
+    if (caplen < len) tap->truncated++;
+}
+
+// Tell clients the stream has ended and stop accepting new ones
+void tap_close(tap_t *tap) {
+    if (!tap || !tap->shm) return;
+
+    atomic_store_explicit(&tap->shm->closed, 1, memory_order_release);
+    if (tap->acceptor_started) {
+        atomic_store(&tap->stop, true);
+        pthread_join(tap->acceptor, NULL);
+        tap->acceptor_started = false;
+    }
+    if (tap->listen_fd >= 0) {
+        close(tap->listen_fd);
+        tap->listen_fd = -1;
+        unlink(tap->path);
+    }
+    tap->end_ns = get_time_ns();
+}
+
+void tap_report(const tap_t *tap) {
+    if (!tap || !tap->shm) return;
+
+    double secs = ((tap->end_ns ? tap->end_ns : get_time_ns()) - tap->start_ns) / 1e9;
+    printf("\n========== Tap ==========\n");
+    printf("Published: %lu packets (%.2f MB, %.2f PPS), truncated to %u bytes: %lu\n",
+           tap->head, tap->bytes / (1024.0 * 1024.0), secs > 0 ? tap->head / secs : 0.0,
+           TAP_SLOT_SIZE, tap->truncated);
+    printf("Ring: %u slots, clients served: %lu\n", tap->shm->num_slots, tap->clients_served);
+    for (uint32_t i = 0; i < TAP_MAX_CONSUMERS; i++) {
+        const tap_consumer_t *c = &tap->shm->consumers[i];
+        uint32_t state = atomic_load_explicit(&c->state, memory_order_acquire);
+        if (state == TAP_CONSUMER_FREE) continue;
+
+        // A detached consumer's lag is frozen at its exit; only report it for attached ones
+        uint64_t pos = state == TAP_CONSUMER_ACTIVE ? atomic_load_explicit(&c->pos, memory_order_relaxed) : tap->head;
+        uint64_t packets = atomic_load_explicit(&c->packets, memory_order_relaxed);
+        uint64_t drops = atomic_load_explicit(&c->drops, memory_order_relaxed);
+        printf("Consumer %u (pid %d, %s): %lu packets, %lu dropped (%.2f%%), lag %lu, max lag %lu\n",
+               i, c->pid, state == TAP_CONSUMER_ACTIVE ? "attached" : "detached", packets, drops,
+               packets + drops ? drops * 100.0 / (packets + drops) : 0.0,
+               tap->head > pos ? tap->head - pos : 0,
+               atomic_load_explicit(&c->max_lag, memory_order_relaxed));
+    }
+    printf("=========================\n");
+}
+
+void tap_destroy(tap_t *tap) {
+    if (!tap) return;
+    tap_close(tap);
+    if (tap->shm) {
+        munmap(tap->shm, tap->map_len);
+    }
+    if (tap->memfd >= 0) close(tap->memfd);
+    if (tap->listen_fd >= 0) close(tap->listen_fd);
+    free(tap);
+}
@@ -0,0 +1,237 @@
+#define _DEFAULT_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <errno.h>
+#include <endian.h>
+#include <time.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <net/if.h>
+#include <arpa/inet.h>
+#include "../../include/common.h"
+#include "../../include/traffic.h"
+
+#define NS_PER_SEC 1000000000ULL
+#define PACER_SPIN_NS 50000              // Busy-wait below this delay instead of sleeping
+#define PACER_DEPTH_NS 1000000           // Catch-up window of the token bucket
+
+// Parse "64", "64,1500" or "64:7,576:4,1500:1" (size[:weight] entries)
+int traffic_parse_sizes(const char *spec, traffic_config_t *cfg) {
+    uint32_t total = 0;
+    const char *p = spec;
+
+    cfg->num_sizes = 0;
+    while (*p) {
+        char *end;
+        unsigned long size = strtoul(p, &end, 10);
+        unsigned long weight = 1;
+        if (end == p) return -1;
+        if (*end == ':') {
+            p = end + 1;
+            weight = strtoul(p, &end, 10);
+            if (end == p || weight == 0) return -1;
+        }
+        if (size < TRAFFIC_MIN_FRAME || size > TRAFFIC_MAX_FRAME) {
+            fprintf(stderr, "Error: Packet size %lu out of range (%d-%d)\n", size,
+                    TRAFFIC_MIN_FRAME, TRAFFIC_MAX_FRAME);
+            return -1;
+        }
+        if (cfg->num_sizes == TRAFFIC_MAX_SIZES) {
+            fprintf(stderr, "Error: At most %d packet sizes can be mixed\n", TRAFFIC_MAX_SIZES);
+            return -1;
+        }
+        total += weight;
+        if (total > TRAFFIC_SCHEDULE_LEN) {
+            fprintf(stderr, "Error: Size mix weights must add up to at most %d\n", TRAFFIC_SCHEDULE_LEN);
+            return -1;
+        }
+        cfg->sizes[cfg->num_sizes] = (uint32_t)size;
+        cfg->weights[cfg->num_sizes] = (uint32_t)weight;
+        cfg->num_sizes++;
+
+        if (*end == ',') end++;
+        else if (*end) return -1;
+        p = end;
+    }
+    return cfg->num_sizes ? 0 : -1;
+}
+
+int traffic_parse_mac(const char *str, uint8_t mac[6]) {
+    unsigned int b[6];
+    if (sscanf(str, "%x:%x:%x:%x:%x:%x", &b[0], &b[1], &b[2], &b[3], &b[4], &b[5]) != 6) {
+        return -1;
+    }
+    for (int i = 0; i < 6; i++) {
+        if (b[i] > 0xFF) return -1;
+        mac[i] = (uint8_t)b[i];
+    }
+    return 0;
+}
+
+int traffic_interface_mac(const char *ifname, uint8_t mac[6]) {
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd < 0) return -1;
+
+    struct ifreq ifr;
+    memset(&ifr, 0, sizeof(ifr));
+    snprintf(ifr.ifr_name, sizeof(ifr.ifr_name), "%s", ifname);
+    int ret = ioctl(fd, SIOCGIFHWADDR, &ifr);
+    close(fd);
+    if (ret < 0) return -1;
+
+    memcpy(mac, ifr.ifr_hwaddr.sa_data, 6);
+    return 0;
+}
+
+static uint32_t sum16(const uint8_t *p, uint32_t len) {
+    uint32_t sum = 0;
+    for (uint32_t i = 0; i + 1 < len; i += 2) {
+        sum += (uint32_t)(p[i] << 8 | p[i + 1]);
+    }
+    return sum;
+}
+
+int traffic_gen_init(traffic_gen_t *gen, const traffic_config_t *cfg) {
+    memset(gen, 0, sizeof(*gen));
+    gen->cfg = *cfg;
+    if (gen->cfg.flows == 0) gen->cfg.flows = 1;
+    if (gen->cfg.flows > PROBE_MAX_FLOWS) gen->cfg.flows = PROBE_MAX_FLOWS;
+
+    gen->flow_seq = calloc(gen->cfg.flows, sizeof(uint32_t));
+    if (!gen->flow_seq) return -1;
+
+    // Interleave sizes by weight (smooth weighted round robin) rather than in runs
+    int32_t current[TRAFFIC_MAX_SIZES] = { 0 };
+    int32_t total = 0;
+    for (uint32_t i = 0; i < cfg->num_sizes; i++) total += (int32_t)cfg->weights[i];
+    gen->sched_len = (uint32_t)total;
+    for (uint32_t n = 0; n < gen->sched_len; n++) {
+        uint32_t best = 0;
+        for (uint32_t i = 0; i < cfg->num_sizes; i++) {
+            current[i] += (int32_t)cfg->weights[i];
+            if (current[i] > current[best]) best = i;
+        }
+        current[best] -= total;
+        gen->schedule[n] = (uint16_t)cfg->sizes[best];
+    }
+
+    // Ethernet + IPv4 + UDP template; per-packet fields are filled in by traffic_gen_build
+    uint8_t *t = gen->template;
+    memcpy(t, cfg->dst_mac, 6);
+    memcpy(t + 6, cfg->src_mac, 6);
+    t[12] = 0x08;
+    t[13] = 0x00;
+
+    uint8_t *ip = t + 14;
+    ip[0] = 0x45;                                    // IPv4, 20-byte header
+    ip[6] = 0x40;                                    // Don't fragment
+    ip[8] = 64;                                      // TTL
+    ip[9] = 17;                                      // UDP
+    memcpy(ip + 12, &cfg->src_ip, 4);
+    memcpy(ip + 16, &cfg->dst_ip, 4);
+    gen->ip_sum_base = sum16(ip, 20);
+
+    uint8_t *udp = ip + 20;
+    uint16_t dport = htons(cfg->dst_port);
+    memcpy(udp + 2, &dport, 2);
+    return 0;
+}
+
+// Length on the wire (without FCS) of the next frame traffic_gen_build will produce
+uint32_t traffic_gen_next_len(const traffic_gen_t *gen) {
+    return gen->schedule[gen->sched_pos] - 4u;
+}
+
+// Build the next frame into buf (at least TRAFFIC_MAX_FRAME bytes); returns its length
+uint32_t traffic_gen_build(traffic_gen_t *gen, uint8_t *buf, uint64_t tx_ns) {
+    uint32_t len = gen->schedule[gen->sched_pos] - 4u;
+    if (++gen->sched_pos == gen->sched_len) gen->sched_pos = 0;
+
+    uint32_t flow = gen->next_flow;
+    if (++gen->next_flow == gen->cfg.flows) gen->next_flow = 0;
+
+    memcpy(buf, gen->template, TRAFFIC_HDR_LEN);
+
+    uint8_t *ip = buf + 14;
+    uint16_t ip_len = (uint16_t)(len - 14);
+    uint32_t sum = gen->ip_sum_base + ip_len;
+    sum = (sum & 0xFFFF) + (sum >> 16);
+    sum = (sum & 0xFFFF) + (sum >> 16);
+    uint16_t csum = htons((uint16_t)~sum);
+    uint16_t be_len = htons(ip_len);
+    memcpy(ip + 2, &be_len, 2);
+    memcpy(ip + 10, &csum, 2);
+
+    // Flows differ by UDP source port; the UDP checksum is left at 0 (optional for IPv4)
+    uint8_t *udp = ip + 20;
+    uint16_t sport = htons((uint16_t)(gen->cfg.src_port + flow));
+    uint16_t udp_len = htons((uint16_t)(len - 34));
+    memcpy(udp, &sport, 2);
+    memcpy(udp + 4, &udp_len, 2);
+
+    probe_hdr_t hdr = {
+        .magic = htobe16(PROBE_MAGIC),
+        .flow = htobe16((uint16_t)flow),
+        .seq = htobe32(gen->flow_seq[flow]++),
+        .tx_ns = htobe64(tx_ns),
+    };
+    memcpy(buf + TRAFFIC_HDR_LEN, &hdr, sizeof(hdr));
+    memset(buf + TRAFFIC_HDR_LEN + sizeof(hdr), 0, len - TRAFFIC_HDR_LEN - sizeof(hdr));
+    return len;
+}
+
+void traffic_gen_cleanup(traffic_gen_t *gen) {
+    free(gen->flow_seq);
+    gen->flow_seq = NULL;
+}
+
+// The bucket holds at least one burst and at least PACER_DEPTH_NS worth of packets,
+// so short stalls in the TX path are made up instead of lowering the average rate
+void pacer_init(pacer_t *pacer, uint64_t rate_pps, uint32_t burst) {
+    uint64_t depth = rate_pps * PACER_DEPTH_NS / NS_PER_SEC;
+    if (depth < burst) depth = burst;
+    if (depth == 0) depth = 1;
+
+    pacer->rate_pps = rate_pps;
+    pacer->max_tokens = depth * NS_PER_SEC;
+    pacer->tokens = NS_PER_SEC;
+    pacer->last_ns = get_time_ns();
+}
+
+// Wait until at least one packet may be sent; returns how many of `want` may go now
+uint32_t pacer_acquire(pacer_t *pacer, uint32_t want) {
+    if (pacer->rate_pps == 0) return want;
+
+    for (;;) {
+        uint64_t now = get_time_ns();
+        uint64_t elapsed = now - pacer->last_ns;
+        pacer->last_ns = now;
+        if (elapsed > NS_PER_SEC) elapsed = NS_PER_SEC;
+
+        pacer->tokens += elapsed * pacer->rate_pps;
+        if (pacer->tokens > pacer->max_tokens) pacer->tokens = pacer->max_tokens;
+
+        uint64_t avail = pacer->tokens / NS_PER_SEC;
+        if (avail) {
+            uint32_t n = avail < want ? (uint32_t)avail : want;
+            pacer->tokens -= (uint64_t)n * NS_PER_SEC;
+            return n;
+        }
+
+        uint64_t wait_ns = (NS_PER_SEC - pacer->tokens) / pacer->rate_pps;
+        if (wait_ns > PACER_SPIN_NS) {
+            struct timespec ts = { 0, (long)(wait_ns - PACER_SPIN_NS) };
+            nanosleep(&ts, NULL);
+        }
+    }
+}
+
+// Return tokens for packets that were granted but could not be queued
+void pacer_refund(pacer_t *pacer, uint32_t n) {
+    if (pacer->rate_pps == 0) return;
+    pacer->tokens += (uint64_t)n * NS_PER_SEC;
+    if (pacer->tokens > pacer->max_tokens) pacer->tokens = pacer->max_tokens;
+}
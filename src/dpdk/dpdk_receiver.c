@@ -16,19 +16,134 @@
 #include <rte_errno.h>
 #include "../../include/common.h"
 #include "../../include/packet_receiver.h"
+#include "../../include/forward.h"
+#include "../../include/placement.h"
+#include "../../include/rx_loop.h"
 
 // DPDK private data structure
 typedef struct {
     uint16_t port_id;
+    uint16_t out_port_id;           // Forwarding TX port (port_id unless a second port is used)
     struct rte_mempool *mbuf_pool;
-    bool eal_initialized;
+    uint16_t burst;                 // mbufs requested per rte_eth_rx_burst
+    bool eal_user;                  // Holds a reference on the EAL
 } dpdk_private_t;
 
-#define RX_RING_SIZE 1024
+// Defaults for --ring-size, --mbufs, --mbuf-cache and --batch
+#define DEFAULT_RX_RING_SIZE 1024
+#define DEFAULT_NUM_MBUFS 8191
+#define DEFAULT_MBUF_CACHE_SIZE 250
+#define DEFAULT_BURST_SIZE 32
 #define TX_RING_SIZE 1024
-#define NUM_MBUFS 8191
-#define MBUF_CACHE_SIZE 250
-#define BURST_SIZE 32
+
+// The EAL and the mempools are process-wide. With several DPDK sources the first
+// one initializes the EAL and ports on the same socket share one pool. Sources are
+// initialized and cleaned up one after another on the main thread, so no locking.
+static uint32_t g_eal_users;
+
+typedef struct {
+    struct rte_mempool *pool;
+    char name[32];
+    int socket;
+    uint32_t users;
+} dpdk_pool_t;
+
+static dpdk_pool_t g_pools[MAX_SOURCES];
+
+static uint32_t dpdk_source_count(const config_t *config) {
+    uint32_t count = 0;
+    for (uint32_t i = 0; i < config->num_sources; i++) {
+        if (config->sources[i].mode == MODE_DPDK) count++;
+    }
+    return count ? count : 1;
+}
+
+// Pool for a socket, created on first use with room for every DPDK source
+static struct rte_mempool* dpdk_pool_get(int socket, uint32_t num_mbufs, uint32_t cache, uint32_t ports) {
+    dpdk_pool_t *slot = NULL;
+    for (uint32_t i = 0; i < MAX_SOURCES; i++) {
+        if (g_pools[i].pool && g_pools[i].socket == socket) {
+            g_pools[i].users++;
+            printf("Sharing mbuf pool %s\n", g_pools[i].name);
+            return g_pools[i].pool;
+        }
+        if (!g_pools[i].pool && !slot) slot = &g_pools[i];
+    }
+    if (!slot) return NULL;
+
+    snprintf(slot->name, sizeof(slot->name), "mbuf_pool_s%d", socket < 0 ? 0 : socket);
+    uint32_t total = num_mbufs * ports;
+    slot->pool = rte_pktmbuf_pool_create(slot->name, total, cache, 0, RTE_MBUF_DEFAULT_BUF_SIZE, socket);
+    if (!slot->pool) return NULL;
+    slot->socket = socket;
+    slot->users = 1;
+    printf("Created mbuf pool: %s (%u mbufs for %u port(s), cache %u)\n", slot->name, total, ports, cache);
+    return slot->pool;
+}
+
+static void dpdk_pool_put(struct rte_mempool *pool) {
+    for (uint32_t i = 0; i < MAX_SOURCES; i++) {
+        if (g_pools[i].pool != pool) continue;
+        if (--g_pools[i].users == 0) {
+            rte_mempool_free(pool);
+            g_pools[i].pool = NULL;
+        }
+        return;
+    }
+}
+
+// Configure one RX and one TX queue on a port and start it
+static int dpdk_port_setup(uint16_t port_id, struct rte_mempool *pool, uint16_t rx_ring_size) {
+    struct rte_eth_conf port_conf = {
+        .rxmode = {
+            .mq_mode = RTE_ETH_MQ_RX_NONE, // Ensure no multi-queue mode
+        },
+    };
+    int ret = rte_eth_dev_configure(port_id, 1, 1, &port_conf); // 1 RX queue, 1 TX queue
+    if (ret < 0) {
+        printf("Cannot configure device: err=%d, port=%u\n", ret, port_id);
+        return -1;
+    }
+    
+    // Setup RX queue
+    ret = rte_eth_rx_queue_setup(
+        port_id,
+        0,
+        rx_ring_size,
+        rte_eth_dev_socket_id(port_id),
+        NULL,
+        pool
+    );
+    
+    if (ret < 0) {
+        fprintf(stderr, "Error: Failed to setup RX queue: %s\n", 
+                rte_strerror(rte_errno));
+        return -1;
+    }
+
+    // Setup TX queue
+    ret = rte_eth_tx_queue_setup(
+        port_id,
+        0,
+        TX_RING_SIZE,
+        rte_eth_dev_socket_id(port_id),
+        NULL
+    );
+
+    if (ret < 0) {
+        fprintf(stderr, "Error: Failed to setup TX queue: %s\n", 
+                rte_strerror(rte_errno));
+        return -1;
+    }
+    
+    // Start port
+    ret = rte_eth_dev_start(port_id);
+    if (ret < 0) {
+        fprintf(stderr, "rte_eth_dev_start:err=%d, port=%u\n", ret, port_id);
+        return -1;
+    }
+    return 0;
+}
 
 // DPDK initialization (requires full DPDK environment)
 static int dpdk_init(packet_receiver_t *receiver, const config_t *config) {
@@ -39,16 +154,23 @@ static int dpdk_init(packet_receiver_t *receiver, const config_t *config) {
         priv = calloc(1, sizeof(dpdk_private_t));
         if (!priv) return -1;
         receiver->private_data = priv;
+        priv->port_id = UINT16_MAX;
+        priv->out_port_id = UINT16_MAX;
     }
     
-    // Initialize EAL if not already done
-    if (!priv->eal_initialized) {
-        // DPDK EAL arguments - minimal setup
-        // Note: In production, these should come from command line
+    // Initialize EAL if no other source has
+    if (g_eal_users == 0) {
+        // DPDK EAL arguments - minimal setup. The main lcore is the first --cpus
+        // entry, else a CPU on the port's node, else core 5
+        int lcore = config->num_cpus ? config->cpus[0] : -1;
+        if (lcore < 0 && config->numa_node >= 0) lcore = placement_node_first_cpu(config->numa_node);
+        if (lcore < 0) lcore = 5;
+        char lcore_arg[8];
+        snprintf(lcore_arg, sizeof(lcore_arg), "%d", lcore);
         const char *eal_args[] = {
             "packet_receiver",
             "-l",
-            "5",  // Use core 5
+            lcore_arg,
             "-n",
             "4",
             NULL
@@ -62,9 +184,10 @@ static int dpdk_init(packet_receiver_t *receiver, const config_t *config) {
                     rte_strerror(rte_errno));
             return -1;
         }
-        priv->eal_initialized = true;
         printf("DPDK EAL initialized successfully\n");
     }
+    g_eal_users++;
+    priv->eal_user = true;
     
     // Check available ports
     uint16_t port_count = rte_eth_dev_count_avail();
@@ -84,78 +207,66 @@ static int dpdk_init(packet_receiver_t *receiver, const config_t *config) {
 
     printf("Found port ID: %u\n", priv->port_id);
 
-    // Configure port
-    struct rte_eth_conf port_conf = {
-        .rxmode = {
-            .mq_mode = RTE_ETH_MQ_RX_NONE, // Ensure no multi-queue mode
-        },
-    };
-    ret = rte_eth_dev_configure(priv->port_id, 1, 1, &port_conf); // 1 RX queue, 1 TX queue
-    if (ret < 0) {
-        printf("Cannot configure device: err=%d, port=%u\n", ret, priv->port_id);
+    uint32_t rx_ring_size = config->ring_size ? config->ring_size : DEFAULT_RX_RING_SIZE;
+    uint32_t num_mbufs = config->num_mbufs ? config->num_mbufs : DEFAULT_NUM_MBUFS;
+    uint32_t mbuf_cache = config->mbuf_cache ? config->mbuf_cache : DEFAULT_MBUF_CACHE_SIZE;
+    priv->burst = (uint16_t)(config->batch_size ? config->batch_size : DEFAULT_BURST_SIZE);
+    if (rx_ring_size > UINT16_MAX) {
+        fprintf(stderr, "Error: RX ring size %u is too large\n", rx_ring_size);
         return -1;
     }
+    // The mempool refuses caches over 2/3 of its size; the RX ring alone must not drain it
+    if (mbuf_cache * 3 > num_mbufs * 2 || num_mbufs <= rx_ring_size) {
+        fprintf(stderr, "Error: %u mbufs cannot back a %u-descriptor RX ring with a %u-mbuf cache\n",
+                num_mbufs, rx_ring_size, mbuf_cache);
+        return -1;
+    }
+    receiver->config.ring_size = rx_ring_size;
+    receiver->config.num_mbufs = num_mbufs;
+    receiver->config.mbuf_cache = mbuf_cache;
+    receiver->config.batch_size = priv->burst;
+
+    // Allocate mbufs on the port's socket, not the lcore's (SOCKET_ID_ANY if unknown).
+    // Further sources run on their own threads, placed by --cpus.
+    int port_socket = rte_eth_dev_socket_id(priv->port_id);
+    if (g_eal_users == 1 && port_socket >= 0 && port_socket != (int)rte_socket_id()) {
+        fprintf(stderr, "Warning: lcore %u is on socket %u but port %u is on socket %d; "
+                "every packet crosses the interconnect\n", rte_lcore_id(), rte_socket_id(),
+                priv->port_id, port_socket);
+    }
     
-    // Create mbuf pool
-    char pool_name[32];
-    snprintf(pool_name, sizeof(pool_name), "mbuf_pool_%u", priv->port_id);
-    
-    priv->mbuf_pool = rte_pktmbuf_pool_create(
-        pool_name,
-        NUM_MBUFS,
-        MBUF_CACHE_SIZE,
-        0,
-        RTE_MBUF_DEFAULT_BUF_SIZE,
-        rte_socket_id()
-    );
-    
+    // Get an mbuf pool (--mbufs per DPDK source)
+    priv->mbuf_pool = dpdk_pool_get(port_socket, num_mbufs, mbuf_cache, dpdk_source_count(config));
     if (priv->mbuf_pool == NULL) {
         fprintf(stderr, "Error: Failed to create mbuf pool: %s\n", 
                 rte_strerror(rte_errno));
         return -1;
     }
-    
-    printf("Created mbuf pool: %s\n", pool_name);
-    
-    // Setup RX queue
-    ret = rte_eth_rx_queue_setup(
-        priv->port_id,
-        0,
-        RX_RING_SIZE,
-        rte_eth_dev_socket_id(priv->port_id),
-        NULL,
-        priv->mbuf_pool
-    );
-    
-    if (ret < 0) {
-        fprintf(stderr, "Error: Failed to setup RX queue: %s\n", 
-                rte_strerror(rte_errno));
-        rte_mempool_free(priv->mbuf_pool);
+    printf("Port %u: RX ring %u, burst %u\n", priv->port_id, rx_ring_size, priv->burst);
+
+    if (dpdk_port_setup(priv->port_id, priv->mbuf_pool, (uint16_t)rx_ring_size) != 0) {
+        dpdk_pool_put(priv->mbuf_pool);
+        priv->mbuf_pool = NULL;
         return -1;
     }
 
-    // Setup TX queue
-    ret = rte_eth_tx_queue_setup(
-        priv->port_id,
-        0,
-        RX_RING_SIZE,
-        rte_eth_dev_socket_id(priv->port_id),
-        NULL
-    );
-
-    if (ret < 0) {
-        fprintf(stderr, "Error: Failed to setup TX queue: %s\n", 
-                rte_strerror(rte_errno));
-        rte_mempool_free(priv->mbuf_pool);
-        return -1;
+    // Forwarding goes out of the RX port unless a second port is given
+    priv->out_port_id = priv->port_id;
+    if (config->forward && config->out_address[0]) {
+        ret = rte_eth_dev_get_port_by_name(config->out_address, &priv->out_port_id);
+        if (ret < 0 || priv->out_port_id == priv->port_id) {
+            fprintf(stderr, "Error: Failed to get forwarding port by name: %s\n", config->out_address);
+            priv->out_port_id = priv->port_id;
+            return -1;
+        }
+        if (dpdk_port_setup(priv->out_port_id, priv->mbuf_pool, (uint16_t)rx_ring_size) != 0) {
+            priv->out_port_id = priv->port_id;
+            return -1;
+        }
     }
-    
-    // Start port
-    ret = rte_eth_dev_start(priv->port_id);
-    if (ret < 0) {
-        fprintf(stderr, "rte_eth_dev_start:err=%d, port=%u\n", ret, priv->port_id);
-        rte_mempool_free(priv->mbuf_pool);
-        return -1;
+    if (config->forward) {
+        printf("Forwarding to port %u (zero-copy, mbufs are transmitted as received)\n",
+               priv->out_port_id);
     }
     
     printf("DPDK mode initialized successfully\n");
@@ -163,22 +274,99 @@ static int dpdk_init(packet_receiver_t *receiver, const config_t *config) {
     return 0;
 }
 
-static int dpdk_start(packet_receiver_t *receiver) {
-    dpdk_private_t *priv = (dpdk_private_t *)receiver->private_data;
-    
-    if (!priv || priv->port_id == UINT16_MAX) {
-        fprintf(stderr, "Error: DPDK receiver not initialized\n");
-        return -1;
+// mbufs come back from the workers and are freed on the lcore that allocated them
+static void dpdk_release(void *ctx, const pipe_desc_t *descs, uint32_t n) {
+    (void)ctx;
+    struct rte_mbuf *mbufs[PIPE_BURST];
+    uint32_t count = 0;
+
+    for (uint32_t i = 0; i < n; i++) {
+        mbufs[count++] = (struct rte_mbuf *)(uintptr_t)descs[i].cookie;
+        if (count == PIPE_BURST) {
+            rte_pktmbuf_free_bulk(mbufs, count);
+            count = 0;
+        }
     }
-    
+    if (count) {
+        rte_pktmbuf_free_bulk(mbufs, count);
+    }
+}
+
+// Pipeline loop: workers get pointers into the mbufs, not copies
+static int dpdk_pipeline(packet_receiver_t *receiver, dpdk_private_t *priv) {
+    pipeline_t *pipe = receiver->pipeline;
+    pipeline_attach(pipe, dpdk_release, priv, &receiver->running);
+
+    while (receiver->running) {
+        struct rte_mbuf *bufs[RX_MAX_BATCH];
+        uint16_t nb_rx = rte_eth_rx_burst(priv->port_id, 0, bufs, priv->burst);
+
+        uint64_t bytes = 0;
+        for (uint16_t i = 0; i < nb_rx; i++) {
+            uint32_t pkt_len = rte_pktmbuf_pkt_len(bufs[i]);
+            bytes += pkt_len;
+            pipeline_dispatch(pipe, rte_pktmbuf_mtod(bufs[i], const uint8_t *),
+                              rte_pktmbuf_data_len(bufs[i]), pkt_len, (uintptr_t)bufs[i]);
+        }
+        stats_update_batch(&receiver->stats, nb_rx, bytes);
+        pipeline_flush(pipe);
+    }
+    return 0;
+}
+
+// Specialized loop body: the feature switches are constants per instance and
+// mbufs are freed in bulk
+RX_ALWAYS_INLINE int dpdk_rx_loop(packet_receiver_t *receiver, dpdk_private_t *priv,
+                                  const bool verbose, const bool stages) {
+    const uint16_t port = priv->port_id;
+    const uint16_t burst = priv->burst;
+
+    while (receiver->running) {
+        struct rte_mbuf *bufs[RX_MAX_BATCH];
+        uint16_t nb_rx = rte_eth_rx_burst(port, 0, bufs, burst);
+        if (nb_rx == 0) continue;
+
+        uint64_t bytes = 0;
+        for (uint16_t i = 0; i < nb_rx; i++) {
+            uint32_t pkt_len = rte_pktmbuf_pkt_len(bufs[i]);
+            bytes += pkt_len;
+            if (stages) {
+                stages_process(receiver->stages, rte_pktmbuf_mtod(bufs[i], const uint8_t *),
+                               rte_pktmbuf_data_len(bufs[i]));
+            }
+            if (verbose) {
+                printf("Packet received: %u bytes (zero-copy)\n", pkt_len);
+            }
+        }
+        rte_pktmbuf_free_bulk(bufs, nb_rx);
+        stats_update_batch(&receiver->stats, nb_rx, bytes);
+    }
+    return 0;
+}
+
+RX_LOOP_INSTANTIATE(dpdk_rx, dpdk_rx_loop, dpdk_private_t);
+
+static int dpdk_receive(packet_receiver_t *receiver, dpdk_private_t *priv) {
     receiver->running = true;
     printf("Starting packet reception (DPDK userspace mode)...\n");
     printf("Receiving packets on port %u\n", priv->port_id);
+    bool forward = receiver->config.forward;
+
+    if (receiver->pipeline) {
+        return dpdk_pipeline(receiver, priv);
+    }
+    // Forwarding transmits the burst and keeps the generic loop
+    if (!receiver->config.generic_loop && !forward) {
+        unsigned variant = rx_loop_variant(receiver);
+        receiver->stats.rx_loop = rx_loop_name(variant);
+        return dpdk_rx_variants[variant](receiver, priv);
+    }
+    receiver->stats.rx_loop = "generic";
     
     // Main receive loop
     while (receiver->running) {
-        struct rte_mbuf *bufs[BURST_SIZE];
-        uint16_t nb_rx = rte_eth_rx_burst(priv->port_id, 0, bufs, BURST_SIZE);
+        struct rte_mbuf *bufs[RX_MAX_BATCH];
+        uint16_t nb_rx = rte_eth_rx_burst(priv->port_id, 0, bufs, priv->burst);
         
         if (nb_rx > 0) {
             for (uint16_t i = 0; i < nb_rx; i++) {
@@ -186,13 +374,30 @@ static int dpdk_start(packet_receiver_t *receiver) {
                 
                 // Update statistics
                 stats_update(&receiver->stats, pkt_len);
+                if (receiver->stages) {
+                    stages_process(receiver->stages, rte_pktmbuf_mtod(bufs[i], const uint8_t *),
+                                   rte_pktmbuf_data_len(bufs[i]));
+                }
                 
                 if (receiver->config.verbose) {
                     printf("Packet received: %u bytes (zero-copy)\n", pkt_len);
                 }
                 
-                // Free mbuf back to pool
-                rte_pktmbuf_free(bufs[i]);
+                if (forward) {
+                    forward_swap_mac(rte_pktmbuf_mtod(bufs[i], uint8_t *));
+                } else {
+                    // Free mbuf back to pool
+                    rte_pktmbuf_free(bufs[i]);
+                }
+            }
+
+            if (forward) {
+                // The received mbufs go out as they are; whatever the TX queue refuses is dropped
+                uint16_t nb_tx = rte_eth_tx_burst(priv->out_port_id, 0, bufs, nb_rx);
+                if (nb_tx < nb_rx) {
+                    rte_pktmbuf_free_bulk(bufs + nb_tx, nb_rx - nb_tx);
+                }
+                stats_update_forward(&receiver->stats, nb_tx, nb_rx - nb_tx);
             }
         }
     }
@@ -200,6 +405,29 @@ static int dpdk_start(packet_receiver_t *receiver) {
     return 0;
 }
 
+static int dpdk_start(packet_receiver_t *receiver) {
+    dpdk_private_t *priv = (dpdk_private_t *)receiver->private_data;
+    
+    if (!priv || priv->port_id == UINT16_MAX) {
+        fprintf(stderr, "Error: DPDK receiver not initialized\n");
+        return -1;
+    }
+    
+    // With several sources, each runs on a thread the EAL did not create;
+    // registering gives it an lcore id, so the mempool cache is used
+    if (rte_lcore_id() != LCORE_ID_ANY) {
+        return dpdk_receive(receiver, priv);
+    }
+    if (rte_thread_register() != 0) {
+        fprintf(stderr, "Warning: Failed to register the receive thread with the EAL: %s\n",
+                rte_strerror(rte_errno));
+        return dpdk_receive(receiver, priv);
+    }
+    int ret = dpdk_receive(receiver, priv);
+    rte_thread_unregister();
+    return ret;
+}
+
 static int dpdk_stop(packet_receiver_t *receiver) {
     if (receiver) {
         receiver->running = false;
@@ -211,6 +439,14 @@ static void dpdk_cleanup(packet_receiver_t *receiver) {
     dpdk_private_t *priv = (dpdk_private_t *)receiver->private_data;
     
     if (priv) {
+        // Stop the forwarding port if it is a separate device
+        if (priv->out_port_id != priv->port_id && priv->out_port_id != UINT16_MAX) {
+            rte_eth_dev_stop(priv->out_port_id);
+            rte_eth_dev_close(priv->out_port_id);
+            printf("DPDK port %u stopped and closed\n", priv->out_port_id);
+            priv->out_port_id = UINT16_MAX;
+        }
+
         // Stop port
         if (priv->port_id != UINT16_MAX) {
             rte_eth_dev_stop(priv->port_id);
@@ -219,16 +455,18 @@ static void dpdk_cleanup(packet_receiver_t *receiver) {
             priv->port_id = UINT16_MAX;
         }
         
-        // Free mbuf pool
+        // Free the mbuf pool once no port uses it
         if (priv->mbuf_pool) {
-            rte_mempool_free(priv->mbuf_pool);
+            dpdk_pool_put(priv->mbuf_pool);
             priv->mbuf_pool = NULL;
         }
         
-        // Cleanup EAL if we initialized it
-        if (priv->eal_initialized) {
-            rte_eal_cleanup();
-            priv->eal_initialized = false;
+        // Cleanup EAL after the last source
+        if (priv->eal_user) {
+            if (--g_eal_users == 0) {
+                rte_eal_cleanup();
+            }
+            priv->eal_user = false;
         }
         
         free(priv);
@@ -1,10 +1,15 @@
-// Stub implementation for DPDK receiver when DPDK is not available
+// Stub implementation for DPDK receiver and sender when DPDK is not available
 #include "../../include/packet_receiver.h"
+#include "../../include/packet_sender.h"
 
 packet_receiver_t* dpdk_receiver_create(void) {
     return NULL;  // DPDK not available
 }
 
+packet_sender_t* dpdk_sender_create(void) {
+    return NULL;  // DPDK not available
+}
+
 
 
 
@@ -0,0 +1,224 @@
+#define _DEFAULT_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <rte_eal.h>
+#include <rte_ethdev.h>
+#include <rte_lcore.h>
+#include <rte_mbuf.h>
+#include <rte_mempool.h>
+#include <rte_errno.h>
+#include "../../include/common.h"
+#include "../../include/packet_sender.h"
+
+// DPDK sender private data
+typedef struct {
+    uint16_t port_id;
+    struct rte_mempool *mbuf_pool;
+    bool eal_initialized;
+} dpdk_sender_private_t;
+
+#define RX_RING_SIZE 1024
+#define TX_RING_SIZE 1024
+#define NUM_MBUFS 8191
+#define MBUF_CACHE_SIZE 250
+#define MAX_BURST 512
+
+static int dpdk_sender_init(packet_sender_t *sender, const sender_config_t *config) {
+    dpdk_sender_private_t *priv = (dpdk_sender_private_t *)sender->private_data;
+    int ret;
+
+    if (!priv) {
+        priv = calloc(1, sizeof(dpdk_sender_private_t));
+        if (!priv) return -1;
+        priv->port_id = UINT16_MAX;
+        sender->private_data = priv;
+    }
+
+    if (!priv->eal_initialized) {
+        // Own file prefix so a DPDK receiver can run on the same host
+        const char *eal_args[] = {
+            "packet_sender",
+            "-l",
+            "6",  // Use core 6
+            "-n",
+            "4",
+            "--file-prefix",
+            "packet_sender",
+            NULL
+        };
+
+        int eal_argc = 7;
+
+        ret = rte_eal_init(eal_argc, (char **)eal_args);
+        if (ret < 0) {
+            fprintf(stderr, "Error: DPDK EAL initialization failed: %s\n",
+                    rte_strerror(rte_errno));
+            return -1;
+        }
+        priv->eal_initialized = true;
+        printf("DPDK EAL initialized successfully\n");
+    }
+
+    ret = rte_eth_dev_get_port_by_name(config->address, &priv->port_id);
+    if (ret < 0) {
+        fprintf(stderr, "Error: Failed to get port by name: %s\n", config->address);
+        priv->port_id = UINT16_MAX;
+        return -1;
+    }
+
+    struct rte_eth_conf port_conf = {
+        .rxmode = {
+            .mq_mode = RTE_ETH_MQ_RX_NONE,
+        },
+    };
+    ret = rte_eth_dev_configure(priv->port_id, 1, 1, &port_conf);
+    if (ret < 0) {
+        fprintf(stderr, "Cannot configure device: err=%d, port=%u\n", ret, priv->port_id);
+        return -1;
+    }
+
+    char pool_name[32];
+    snprintf(pool_name, sizeof(pool_name), "tx_pool_%u", priv->port_id);
+    priv->mbuf_pool = rte_pktmbuf_pool_create(pool_name, NUM_MBUFS, MBUF_CACHE_SIZE, 0,
+                                              RTE_MBUF_DEFAULT_BUF_SIZE,
+                                              rte_eth_dev_socket_id(priv->port_id));
+    if (priv->mbuf_pool == NULL) {
+        fprintf(stderr, "Error: Failed to create mbuf pool: %s\n", rte_strerror(rte_errno));
+        return -1;
+    }
+
+    // An RX queue is still set up because some PMDs refuse to start without one
+    ret = rte_eth_rx_queue_setup(priv->port_id, 0, RX_RING_SIZE,
+                                 rte_eth_dev_socket_id(priv->port_id), NULL, priv->mbuf_pool);
+    if (ret < 0) {
+        fprintf(stderr, "Error: Failed to setup RX queue: %s\n", rte_strerror(rte_errno));
+        return -1;
+    }
+    ret = rte_eth_tx_queue_setup(priv->port_id, 0, TX_RING_SIZE,
+                                 rte_eth_dev_socket_id(priv->port_id), NULL);
+    if (ret < 0) {
+        fprintf(stderr, "Error: Failed to setup TX queue: %s\n", rte_strerror(rte_errno));
+        return -1;
+    }
+
+    ret = rte_eth_dev_start(priv->port_id);
+    if (ret < 0) {
+        fprintf(stderr, "rte_eth_dev_start:err=%d, port=%u\n", ret, priv->port_id);
+        return -1;
+    }
+
+    if (!config->src_mac_set) {
+        struct rte_ether_addr mac;
+        if (rte_eth_macaddr_get(priv->port_id, &mac) == 0) {
+            memcpy(sender->config.traffic.src_mac, mac.addr_bytes, 6);
+        }
+    }
+    if (sender->config.batch > MAX_BURST) {
+        sender->config.batch = MAX_BURST;
+    }
+
+    printf("DPDK sender initialized successfully, port: %u\n", priv->port_id);
+    return 0;
+}
+
+static int dpdk_sender_start(packet_sender_t *sender) {
+    dpdk_sender_private_t *priv = (dpdk_sender_private_t *)sender->private_data;
+
+    if (!priv || priv->port_id == UINT16_MAX) {
+        fprintf(stderr, "Error: DPDK sender not initialized\n");
+        return -1;
+    }
+
+    sender->running = true;
+    printf("Starting packet transmission (rte_eth_tx_burst) on port %u...\n", priv->port_id);
+
+    struct rte_mbuf *bufs[MAX_BURST];
+    uint32_t lens[MAX_BURST];
+
+    while (sender->running) {
+        uint32_t n = sender_next_burst(sender);
+        if (n == 0) break;
+
+        if (rte_pktmbuf_alloc_bulk(priv->mbuf_pool, bufs, n) != 0) {
+            pacer_refund(&sender->pacer, n);
+            sender->stats.tx_retries++;
+            continue;
+        }
+
+        uint64_t now = get_time_ns();
+        for (uint32_t i = 0; i < n; i++) {
+            lens[i] = traffic_gen_build(&sender->gen, rte_pktmbuf_mtod(bufs[i], uint8_t *), now);
+            bufs[i]->data_len = (uint16_t)lens[i];
+            bufs[i]->pkt_len = lens[i];
+        }
+
+        // Retry until the NIC takes the whole burst so sequence numbers stay contiguous
+        uint32_t sent = 0;
+        while (sent < n && sender->running) {
+            sent += rte_eth_tx_burst(priv->port_id, 0, bufs + sent, (uint16_t)(n - sent));
+            if (sent < n) sender->stats.tx_retries++;
+        }
+        if (sent < n) {
+            rte_pktmbuf_free_bulk(bufs + sent, n - sent);
+        }
+
+        for (uint32_t i = 0; i < sent; i++) {
+            sender->stats.bytes_sent += lens[i];
+        }
+        sender->stats.packets_sent += sent;
+
+        if (sender->config.verbose) {
+            printf("Burst sent: %u packets\n", sent);
+        }
+    }
+    return 0;
+}
+
+static int dpdk_sender_stop(packet_sender_t *sender) {
+    if (sender) {
+        sender->running = false;
+    }
+    return 0;
+}
+
+static void dpdk_sender_cleanup(packet_sender_t *sender) {
+    dpdk_sender_private_t *priv = (dpdk_sender_private_t *)sender->private_data;
+
+    if (priv) {
+        if (priv->port_id != UINT16_MAX) {
+            rte_eth_dev_stop(priv->port_id);
+            rte_eth_dev_close(priv->port_id);
+            printf("DPDK port %u stopped and closed\n", priv->port_id);
+            priv->port_id = UINT16_MAX;
+        }
+        if (priv->mbuf_pool) {
+            rte_mempool_free(priv->mbuf_pool);
+            priv->mbuf_pool = NULL;
+        }
+        if (priv->eal_initialized) {
+            rte_eal_cleanup();
+            priv->eal_initialized = false;
+        }
+        free(priv);
+        sender->private_data = NULL;
+    }
+}
+
+// Create DPDK sender
+packet_sender_t* dpdk_sender_create(void) {
+    packet_sender_t *sender = calloc(1, sizeof(packet_sender_t));
+    if (!sender) return NULL;
+
+    sender->mode = MODE_DPDK;
+    sender->ops.init = dpdk_sender_init;
+    sender->ops.start = dpdk_sender_start;
+    sender->ops.stop = dpdk_sender_stop;
+    sender->ops.cleanup = dpdk_sender_cleanup;
+
+    return sender;
+}
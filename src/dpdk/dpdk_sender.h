@@ -0,0 +1,8 @@
+#ifndef DPDK_SENDER_H
+#define DPDK_SENDER_H
+
+#include "../../include/packet_sender.h"
+
+packet_sender_t* dpdk_sender_create(void);
+
+#endif // DPDK_SENDER_H
@@ -1,26 +1,41 @@
-#define _POSIX_C_SOURCE 200809L
+#define _GNU_SOURCE
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdbool.h>
 #include <signal.h>
 #include <unistd.h>
 #include <pthread.h>
 #include "../include/common.h"
 #include "../include/packet_receiver.h"
+#include "../include/placement.h"
+#include "../include/hugemem.h"
 
 // External receiver creation functions
 #include "socket/socket_receiver.h"
 #include "af_xdp/af_xdp_receiver.h"
 #include "dpdk/dpdk_receiver.h"
+#include "pcap/pcap_receiver.h"
 
-static packet_receiver_t *g_receiver = NULL;
+// One receiver per --source, each on its own thread when there are several
+typedef struct {
+    packet_receiver_t *receiver;
+    pthread_t thread;
+    bool started;
+    int ret;
+} source_run_t;
+
+static source_run_t g_sources[MAX_SOURCES];
+static uint32_t g_num_sources = 0;
 
 // Signal handling
 static void signal_handler(int sig) {
     (void)sig;  // Suppress unused parameter warning
-    if (g_receiver) {
+    if (g_num_sources > 0) {
         printf("\nInterrupt signal received, stopping...\n");
-        packet_receiver_stop(g_receiver);
+    }
+    for (uint32_t i = 0; i < g_num_sources; i++) {
+        packet_receiver_stop(g_sources[i].receiver);
     }
 }
 typedef struct {
@@ -36,74 +51,334 @@ static void* terminate_thread(void *arg) {
     return NULL;
 }
 
+// "out.pcap" -> "out-eth0.pcap", so every source writes its own file. Sources
+// reading the same device also get their number ("out-eth0-2.pcap").
+static void source_path(char *dst, size_t size, const char *path, const config_t *config,
+                        uint32_t number) {
+    char tag[64];
+    const char *dev = device_name(config);
+    if (config->mode == MODE_PCAP) {
+        const char *slash = strrchr(dev, '/');
+        if (slash) dev = slash + 1;
+    }
+    snprintf(tag, sizeof(tag), "%s", dev);
+    if (config->mode == MODE_PCAP) {
+        char *dot = strrchr(tag, '.');
+        if (dot && dot != tag) *dot = '\0';
+    }
+    for (char *c = tag; *c; c++) {
+        if (*c == ':' || *c == '/') *c = '-';
+    }
+    if (number) {
+        size_t len = strlen(tag);
+        snprintf(tag + len, sizeof(tag) - len, "-%u", number);
+    }
+
+    const char *slash = strrchr(path, '/');
+    const char *dot = strrchr(path, '.');
+    if (!dot || (slash && dot < slash) || dot == (slash ? slash + 1 : path)) {
+        snprintf(dst, size, "%s-%s", path, tag);
+    } else {
+        snprintf(dst, size, "%.*s-%s%s", (int)(dot - path), path, tag, dot);
+    }
+}
+
+// Configuration of source `index` out of `count`: its device, its slice of
+// --cpus (one receive CPU each, then the worker CPUs in order) and its share
+// of the reassembly budget
+static void source_config(const config_t *base, uint32_t index, uint32_t count, config_t *cfg) {
+    *cfg = *base;
+    if (base->num_sources == 0) return;
+
+    const source_t *src = &base->sources[index];
+    cfg->mode = src->mode;
+    switch (src->mode) {
+        case MODE_DPDK:
+            strncpy(cfg->address, src->device, sizeof(cfg->address) - 1);
+            cfg->address[sizeof(cfg->address) - 1] = '\0';
+            break;
+        case MODE_PCAP:
+            strncpy(cfg->pcap_file, src->device, sizeof(cfg->pcap_file) - 1);
+            cfg->pcap_file[sizeof(cfg->pcap_file) - 1] = '\0';
+            break;
+        default:
+            strncpy(cfg->interface, src->device, sizeof(cfg->interface) - 1);
+            cfg->interface[sizeof(cfg->interface) - 1] = '\0';
+            break;
+    }
+    if (count == 1) return;
+
+    cfg->num_cpus = 0;
+    if (base->num_cpus >= count) {
+        cfg->cpus[cfg->num_cpus++] = base->cpus[index];
+        uint32_t spare = base->num_cpus - count;
+        uint32_t per_source = spare / count;
+        for (uint32_t w = 0; w < per_source; w++) {
+            cfg->cpus[cfg->num_cpus++] = base->cpus[count + index * per_source + w];
+        }
+    }
+
+    cfg->reasm_max_flows = base->reasm_max_flows / count;
+    cfg->reasm_mem_mb = base->reasm_mem_mb / count;
+    if (cfg->reasm_max_flows == 0) cfg->reasm_max_flows = 1;
+    if (cfg->reasm_mem_mb == 0) cfg->reasm_mem_mb = 1;
+
+    uint32_t number = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        if (i != index && strcmp(base->sources[i].device, src->device) == 0) number = index + 1;
+    }
+    if (base->write_file[0]) {
+        source_path(cfg->write_file, sizeof(cfg->write_file), base->write_file, cfg, number);
+    }
+    if (base->tap_path[0]) {
+        source_path(cfg->tap_path, sizeof(cfg->tap_path), base->tap_path, cfg, number);
+    }
+}
+
+static packet_receiver_t* source_create(packet_mode_t mode) {
+    // Create receiver based on mode
+    switch (mode) {
+        case MODE_SOCKET:
+            return socket_receiver_create();
+        case MODE_AF_XDP:
+            return af_xdp_receiver_create();
+        case MODE_DPDK:
+            return dpdk_receiver_create();
+        case MODE_PCAP:
+            return pcap_receiver_create();
+        default:
+            fprintf(stderr, "Error: Unknown receive mode\n");
+            return NULL;
+    }
+}
+
+static void* source_thread(void *arg) {
+    source_run_t *src = (source_run_t *)arg;
+    src->ret = src->receiver->ops.start(src->receiver);
+    src->receiver->stats.end_time_ns = get_time_ns();
+    return NULL;
+}
+
+// Workers are joined first so each backend can release its buffers
+static void cleanup_sources(stages_t *aggregate) {
+    for (uint32_t i = 0; i < g_num_sources; i++) {
+        packet_receiver_t *receiver = g_sources[i].receiver;
+        pipeline_destroy(receiver->pipeline);
+        receiver->pipeline = NULL;
+        stages_destroy(receiver->stages);
+        receiver->stages = NULL;
+        packet_receiver_cleanup(receiver);
+    }
+    g_num_sources = 0;
+    stages_destroy(aggregate);
+}
+
 int main(int argc, char *argv[]) {
     config_t config;
-    packet_receiver_t *receiver = NULL;
+    stages_t *aggregate = NULL;
     
     print_banner();
     
     // Parse command line arguments
-    if (parse_args(argc, argv, &config) != 0) {
-        return 0;  // Exit after showing help
+    int ret = parse_args(argc, argv, &config);
+    if (ret != 0) {
+        return ret < 0 ? 1 : 0;  // Exit after showing help or on invalid options
     }
     
+    hugemem_configure(config.hugepages);
+
     // Register signal handlers
     signal(SIGINT, signal_handler);
     signal(SIGTERM, signal_handler);
-    
-    // Create receiver based on mode
-    switch (config.mode) {
-        case MODE_SOCKET:
-            receiver = socket_receiver_create();
-            break;
-        case MODE_AF_XDP:
-            receiver = af_xdp_receiver_create();
-            break;
-        case MODE_DPDK:
-            receiver = dpdk_receiver_create();
-            break;
-        default:
-            fprintf(stderr, "Error: Unknown receive mode\n");
+
+    uint32_t count = config.num_sources > 1 ? config.num_sources : 1;
+    bool multi = count > 1;
+
+    // The DPDK EAL pins the thread that initializes it; source threads start
+    // from the original mask instead
+    cpu_set_t initial_cpus;
+    bool have_initial_cpus = multi &&
+        pthread_getaffinity_np(pthread_self(), sizeof(initial_cpus), &initial_cpus) == 0;
+
+    for (uint32_t i = 0; i < count; i++) {
+        config_t cfg;
+        source_config(&config, i, count, &cfg);
+
+        packet_receiver_t *receiver = source_create(cfg.mode);
+        if (!receiver) {
+            fprintf(stderr, "Error: Failed to create receiver\n");
+            cleanup_sources(NULL);
             return 1;
+        }
+        g_sources[i].receiver = receiver;
+        g_num_sources = i + 1;
+
+        if (multi) {
+            printf("Source %u: %s %s\n", i + 1, mode_name(cfg.mode), device_name(&cfg));
+        }
+
+        // Place the receive thread before init so buffers are first touched on its node.
+        // DPDK pins its own main lcore from the EAL arguments; with several sources
+        // each thread is pinned when it is started.
+        cfg.numa_node = placement_device_node(&cfg);
+        if (cfg.numa_node >= 0) {
+            printf("Receive device is on NUMA node %d\n", cfg.numa_node);
+        }
+        if (cfg.num_cpus > 0 && cfg.mode != MODE_DPDK && !multi) {
+            if (placement_pin_thread(pthread_self(), cfg.cpus[0], "Receive thread",
+                                     cfg.numa_node) != 0) {
+                cleanup_sources(NULL);
+                return 1;
+            }
+        } else if (cfg.num_cpus == 0 && cfg.numa_node >= 0) {
+            int cpu = placement_node_first_cpu(cfg.numa_node);
+            if (cpu >= 0) printf("Hint: --cpus %d keeps the receive thread on the device's node\n", cpu);
+        }
+        receiver->config = cfg;
+
+        // Initialize receiver
+        if (receiver->ops.init(receiver, &cfg) != 0) {
+            fprintf(stderr, "Error: Receiver initialization failed\n");
+            cleanup_sources(NULL);
+            return 1;
+        }
     }
-    
-    if (!receiver) {
-        fprintf(stderr, "Error: Failed to create receiver\n");
-        return 1;
+    if (have_initial_cpus) {
+        pthread_setaffinity_np(pthread_self(), sizeof(initial_cpus), &initial_cpus);
     }
-    
-    g_receiver = receiver;
-    receiver->config = config;
-    
-    // Initialize receiver
-    if (receiver->ops.init(receiver, &config) != 0) {
-        fprintf(stderr, "Error: Receiver initialization failed\n");
-        packet_receiver_cleanup(receiver);
-        return 1;
+
+    // Create processing stages. With several sources the analysis results are
+    // merged into one aggregate; capture and the tap stay per source.
+    if (stages_enabled(&config)) {
+        if (multi) {
+            config_t agg_config = config;
+            agg_config.write_file[0] = '\0';
+            agg_config.tap_path[0] = '\0';
+            aggregate = stages_create(&agg_config);
+            if (!aggregate) {
+                fprintf(stderr, "Error: Failed to create processing stages\n");
+                cleanup_sources(NULL);
+                return 1;
+            }
+        }
+        for (uint32_t i = 0; i < count; i++) {
+            packet_receiver_t *receiver = g_sources[i].receiver;
+            receiver->stages = aggregate ? stages_clone(aggregate, &receiver->config)
+                                         : stages_create(&receiver->config);
+            if (!receiver->stages) {
+                fprintf(stderr, "Error: Failed to create processing stages\n");
+                cleanup_sources(aggregate);
+                return 1;
+            }
+        }
     }
 
-    // Create terminate thread before starting reception
+    // Hand processing to worker threads; capture stays on the receive thread
+    if (config.workers > 0) {
+        for (uint32_t i = 0; i < count; i++) {
+            packet_receiver_t *receiver = g_sources[i].receiver;
+            receiver->pipeline = pipeline_create(&receiver->config, receiver->stages);
+            if (!receiver->pipeline) {
+                fprintf(stderr, "Error: Failed to create worker pipeline\n");
+                cleanup_sources(aggregate);
+                return 1;
+            }
+        }
+    }
+
+    // Create terminate thread before starting reception (duration 0 runs until interrupted)
     thread_args_t args;
     args.main_tid = pthread_self();
     args.sleep_seconds = config.duration_sec;
-    pthread_t terminate_thread_id;
-    pthread_create(&terminate_thread_id, NULL, terminate_thread, &args);
-    pthread_detach(terminate_thread_id);
+    if (config.duration_sec > 0) {
+        pthread_t terminate_thread_id;
+        pthread_create(&terminate_thread_id, NULL, terminate_thread, &args);
+        pthread_detach(terminate_thread_id);
+    }
     
     // Start reception
-    receiver->stats.start_time_ns = get_time_ns();
-    if (receiver->ops.start(receiver) != 0) {
-        fprintf(stderr, "Error: Receiver start failed\n");
-        packet_receiver_cleanup(receiver);
-        return 1;
+    uint64_t cpu_start = get_cpu_time_ns();
+    if (!multi) {
+        packet_receiver_t *receiver = g_sources[0].receiver;
+        receiver->stats.start_time_ns = get_time_ns();
+        if (receiver->ops.start(receiver) != 0) {
+            fprintf(stderr, "Error: Receiver start failed\n");
+            cleanup_sources(aggregate);
+            return 1;
+        }
+        receiver->stats.end_time_ns = get_time_ns();
+        receiver->stats.cpu_time_ns = get_cpu_time_ns() - cpu_start;
+    } else {
+        for (uint32_t i = 0; i < count; i++) {
+            source_run_t *src = &g_sources[i];
+            src->receiver->stats.start_time_ns = get_time_ns();
+            if (pthread_create(&src->thread, NULL, source_thread, src) != 0) {
+                fprintf(stderr, "Error: Failed to start source %u\n", i + 1);
+                src->ret = -1;
+                continue;
+            }
+            src->started = true;
+            const config_t *cfg = &src->receiver->config;
+            if (cfg->num_cpus > 0) {
+                char name[32];
+                snprintf(name, sizeof(name), "Source %u receive thread", i + 1);
+                placement_pin_thread(src->thread, cfg->cpus[0], name, cfg->numa_node);
+            }
+        }
+        for (uint32_t i = 0; i < count; i++) {
+            if (g_sources[i].started) pthread_join(g_sources[i].thread, NULL);
+        }
     }
-    
+    uint64_t cpu_time_ns = get_cpu_time_ns() - cpu_start;
+
     // Display statistics
-    receiver->stats.end_time_ns = get_time_ns();
-    stats_summarize(&receiver->stats);
+    stats_t total;
+    stats_init(&total);
+    const stats_t *source_stats[MAX_SOURCES];
+    const config_t *source_configs[MAX_SOURCES];
+    for (uint32_t i = 0; i < count; i++) {
+        packet_receiver_t *receiver = g_sources[i].receiver;
+        pipeline_stop(receiver->pipeline);
+        pipeline_merge(receiver->pipeline, receiver->stages);
+        if (multi) {
+            printf("\n---------- Source %u: %s %s ----------\n", i + 1,
+                   mode_name(receiver->config.mode), device_name(&receiver->config));
+            if (g_sources[i].ret != 0) {
+                fprintf(stderr, "Error: Source %u stopped with an error\n", i + 1);
+            }
+        }
+        stats_summarize(&receiver->stats);
+        pipeline_report(receiver->pipeline, &receiver->stats);
+        stages_finish(receiver->stages);
+        if (multi) {
+            stages_report_outputs(receiver->stages);
+            stages_merge(aggregate, receiver->stages);
+            stats_accumulate(&total, &receiver->stats);
+        } else {
+            stages_report(receiver->stages);
+        }
+        source_stats[i] = &receiver->stats;
+        source_configs[i] = &receiver->config;
+    }
+    if (multi) {
+        // Per-source threads share the process, so CPU time is only known in total
+        total.cpu_time_ns = cpu_time_ns;
+        printf("\n---------- All %u sources ----------\n", count);
+        stats_summarize(&total);
+        stages_report(aggregate);
+    }
+    hugemem_report();
+    if (config.json_file[0]) {
+        // The receivers' copies of the config hold the tuning their init settled on
+        const stats_t *stats = multi ? &total : source_stats[0];
+        const stages_t *stages = multi ? aggregate : g_sources[0].receiver->stages;
+        stats_write_json(config.json_file, stats, source_configs[0],
+                         stages ? stages->probe : NULL, source_stats, source_configs, count);
+    }
+    stats_cleanup(&total);
     
-    // Cleanup
-    packet_receiver_cleanup(receiver);
+    // Cleanup (workers are joined, so the backend can release its buffers)
+    cleanup_sources(aggregate);
     
     printf("Program terminated\n");
     return 0;
@@ -115,6 +390,7 @@ packet_receiver_t* packet_receiver_create(packet_mode_t mode) {
         case MODE_SOCKET: return socket_receiver_create();
         case MODE_AF_XDP: return af_xdp_receiver_create();
         case MODE_DPDK: return dpdk_receiver_create();
+        case MODE_PCAP: return pcap_receiver_create();
         default: return NULL;
     }
 }
@@ -0,0 +1,355 @@
+#define _DEFAULT_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "../../include/common.h"
+#include "../../include/packet_receiver.h"
+#include "../../include/rx_loop.h"
+
+#define PCAP_MAGIC_USEC 0xa1b2c3d4
+#define PCAP_MAGIC_NSEC 0xa1b23c4d
+#define PCAPNG_SHB 0x0A0D0D0A
+#define PCAPNG_IDB 0x00000001
+#define PCAPNG_SPB 0x00000003
+#define PCAPNG_EPB 0x00000006
+#define PCAPNG_BYTE_ORDER_MAGIC 0x1A2B3C4D
+#define LINKTYPE_ETHERNET 1
+
+// Busy-wait below this delay instead of sleeping
+#define SPIN_THRESHOLD_NS 50000
+#define WAIT_SLICE_NS 100000000ULL   // Longest single sleep while pacing a replay
+#define DEFAULT_BATCH_SIZE 64        // Records per stats update in the specialized loops (--batch)
+
+typedef struct {
+    const uint8_t *map;              // Whole file, mapped read-only
+    size_t size;
+    bool pcapng;
+    bool swapped;                    // pcap written on an opposite-endian host
+    uint64_t ts_unit_ns;             // Nanoseconds per timestamp tick (pcap)
+    uint64_t pcapng_ts_div;          // pcapng if_tsresol: ticks per second
+} pcap_private_t;
+
+// One record from the file (data points into the mapping)
+typedef struct {
+    const uint8_t *data;
+    uint32_t caplen;
+    uint32_t len;
+    uint64_t ts_ns;
+} pcap_record_t;
+
+static inline uint32_t rd32(const pcap_private_t *priv, const uint8_t *p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return priv->swapped ? __builtin_bswap32(v) : v;
+}
+
+static inline uint16_t rd16(const pcap_private_t *priv, const uint8_t *p) {
+    uint16_t v;
+    memcpy(&v, p, sizeof(v));
+    return priv->swapped ? __builtin_bswap16(v) : v;
+}
+
+static int parse_pcapng_idb(pcap_private_t *priv, const uint8_t *blk, uint32_t blk_len) {
+    if (blk_len < 20) return -1;
+    if (rd16(priv, blk + 8) != LINKTYPE_ETHERNET) {
+        fprintf(stderr, "Warning: pcapng interface link type %u is not Ethernet\n", rd16(priv, blk + 8));
+    }
+
+    // Options: look for if_tsresol (code 9)
+    uint32_t off = 16;
+    while (off + 4 <= blk_len - 4) {
+        uint16_t code = rd16(priv, blk + off);
+        uint16_t len = rd16(priv, blk + off + 2);
+        if (code == 0) break;
+        if (code == 9 && len >= 1) {
+            uint8_t res = blk[off + 4];
+            uint8_t exp = res & 0x7F;
+            // Resolutions past 2^63 or 10^19 ticks/s do not fit the divisor
+            if ((res & 0x80) ? exp >= 64 : exp > 19) {
+                fprintf(stderr, "Warning: pcapng if_tsresol 0x%02x out of range, assuming microseconds\n", res);
+            } else {
+                uint64_t div = 1;
+                if (res & 0x80) {
+                    div = 1ULL << exp;
+                } else {
+                    for (uint8_t i = 0; i < exp; i++) div *= 10;
+                }
+                priv->pcapng_ts_div = div;
+            }
+        }
+        off += 4 + ((len + 3) & ~3u);
+    }
+    return 0;
+}
+
+// Advance to the next packet record; returns false at end of file
+static bool next_record(pcap_private_t *priv, size_t *off, pcap_record_t *rec) {
+    if (!priv->pcapng) {
+        if (*off + 16 > priv->size) return false;
+        const uint8_t *hdr = priv->map + *off;
+        rec->caplen = rd32(priv, hdr + 8);
+        rec->len = rd32(priv, hdr + 12);
+        if (*off + 16 + rec->caplen > priv->size) return false;
+        rec->ts_ns = (uint64_t)rd32(priv, hdr) * 1000000000ULL + (uint64_t)rd32(priv, hdr + 4) * priv->ts_unit_ns;
+        rec->data = hdr + 16;
+        *off += 16 + rec->caplen;
+        return true;
+    }
+
+    while (*off + 12 <= priv->size) {
+        const uint8_t *blk = priv->map + *off;
+        uint32_t type = rd32(priv, blk);
+        uint32_t blk_len = rd32(priv, blk + 4);
+        if (blk_len < 12 || *off + blk_len > priv->size) return false;
+        *off += blk_len;
+
+        if (type == PCAPNG_EPB && blk_len >= 32) {
+            uint64_t ticks = ((uint64_t)rd32(priv, blk + 12) << 32) | rd32(priv, blk + 16);
+            rec->caplen = rd32(priv, blk + 20);
+            rec->len = rd32(priv, blk + 24);
+            // 28 header + 4 trailer bytes; compare without adding to caplen, which could wrap
+            if (rec->caplen > blk_len - 32) return false;
+            rec->data = blk + 28;
+            rec->ts_ns = ticks / priv->pcapng_ts_div * 1000000000ULL +
+                         ticks % priv->pcapng_ts_div * 1000000000ULL / priv->pcapng_ts_div;
+            return true;
+        } else if (type == PCAPNG_SPB && blk_len >= 16) {
+            rec->len = rd32(priv, blk + 8);
+            // Data is whatever fits between the 12 header and 4 trailer bytes
+            rec->caplen = rec->len < blk_len - 16 ? rec->len : blk_len - 16;
+            rec->data = blk + 12;
+            rec->ts_ns = 0;
+            return true;
+        } else if (type == PCAPNG_IDB) {
+            parse_pcapng_idb(priv, blk, blk_len);
+        }
+    }
+    return false;
+}
+
+static int pcap_init(packet_receiver_t *receiver, const config_t *config) {
+    pcap_private_t *priv = (pcap_private_t *)receiver->private_data;
+
+    if (!priv) {
+        priv = calloc(1, sizeof(pcap_private_t));
+        if (!priv) return -1;
+        receiver->private_data = priv;
+    }
+    receiver->config.batch_size = config->batch_size ? config->batch_size : DEFAULT_BATCH_SIZE;
+
+    int fd = open(config->pcap_file, O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "Error: Failed to open %s: %s\n", config->pcap_file, strerror(errno));
+        return -1;
+    }
+    struct stat st;
+    if (fstat(fd, &st) < 0 || st.st_size < 24) {
+        fprintf(stderr, "Error: %s is not a capture file\n", config->pcap_file);
+        close(fd);
+        return -1;
+    }
+
+    // Map and pre-fault the whole file so replay never touches the disk
+    priv->size = (size_t)st.st_size;
+    priv->map = mmap(NULL, priv->size, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd, 0);
+    close(fd);
+    if (priv->map == MAP_FAILED) {
+        fprintf(stderr, "Error: mmap %s: %s\n", config->pcap_file, strerror(errno));
+        priv->map = NULL;
+        return -1;
+    }
+    madvise((void *)priv->map, priv->size, MADV_SEQUENTIAL);
+
+    uint32_t magic;
+    memcpy(&magic, priv->map, sizeof(magic));
+    if (magic == PCAP_MAGIC_USEC || magic == PCAP_MAGIC_NSEC) {
+        priv->ts_unit_ns = magic == PCAP_MAGIC_NSEC ? 1 : 1000;
+    } else if (__builtin_bswap32(magic) == PCAP_MAGIC_USEC || __builtin_bswap32(magic) == PCAP_MAGIC_NSEC) {
+        priv->swapped = true;
+        priv->ts_unit_ns = __builtin_bswap32(magic) == PCAP_MAGIC_NSEC ? 1 : 1000;
+    } else if (magic == PCAPNG_SHB) {
+        uint32_t bom;
+        memcpy(&bom, priv->map + 8, sizeof(bom));
+        if (bom != PCAPNG_BYTE_ORDER_MAGIC && __builtin_bswap32(bom) != PCAPNG_BYTE_ORDER_MAGIC) {
+            fprintf(stderr, "Error: Bad pcapng byte-order magic in %s\n", config->pcap_file);
+            return -1;
+        }
+        priv->pcapng = true;
+        priv->swapped = bom != PCAPNG_BYTE_ORDER_MAGIC;
+        priv->pcapng_ts_div = 1000000;
+    } else {
+        fprintf(stderr, "Error: %s is not a pcap or pcapng file\n", config->pcap_file);
+        return -1;
+    }
+
+    if (!priv->pcapng && rd32(priv, priv->map + 20) != LINKTYPE_ETHERNET) {
+        fprintf(stderr, "Warning: pcap link type %u is not Ethernet\n", rd32(priv, priv->map + 20));
+    }
+
+    printf("pcap replay mode initialized successfully, file: %s (%s, %.2f MB)\n",
+           config->pcap_file, priv->pcapng ? "pcapng" : "pcap", priv->size / (1024.0 * 1024.0));
+    return 0;
+}
+
+// Sleep until close to target_ns, then spin; returns early once *running clears.
+// Long sleeps are cut into slices so a stop request is seen promptly.
+static void wait_until(uint64_t target_ns, volatile bool *running) {
+    while (*running) {
+        uint64_t now = get_time_ns();
+        if (now >= target_ns) return;
+        uint64_t left = target_ns - now;
+        if (left > SPIN_THRESHOLD_NS) {
+            uint64_t sleep_ns = left - SPIN_THRESHOLD_NS;
+            if (sleep_ns > WAIT_SLICE_NS) sleep_ns = WAIT_SLICE_NS;
+            struct timespec ts = { (time_t)(sleep_ns / 1000000000ULL), (long)(sleep_ns % 1000000000ULL) };
+            nanosleep(&ts, NULL);
+        }
+    }
+}
+
+// Specialized loop body for maximum-speed replay without workers: records are
+// counted in bursts of --batch and the feature switches are constants
+RX_ALWAYS_INLINE int pcap_rx_loop(packet_receiver_t *receiver, pcap_private_t *priv,
+                                  const bool verbose, const bool stages) {
+    size_t first = priv->pcapng ? 0 : 24;
+    uint32_t loops = receiver->config.replay_loops;
+    const uint32_t batch = receiver->config.batch_size;
+
+    for (uint32_t loop = 0; receiver->running && (loops == 0 || loop < loops); loop++) {
+        size_t off = first;
+        pcap_record_t rec;
+        bool more = true;
+
+        while (receiver->running && more) {
+            uint32_t packets = 0;
+            uint64_t bytes = 0;
+            while (packets < batch && (more = next_record(priv, &off, &rec))) {
+                packets++;
+                bytes += rec.len;
+                if (stages) {
+                    stages_process(receiver->stages, rec.data, rec.caplen);
+                }
+                if (verbose) {
+                    printf("Packet replayed: %u bytes (captured %u)\n", rec.len, rec.caplen);
+                }
+            }
+            stats_update_batch(&receiver->stats, packets, bytes);
+        }
+    }
+    return 0;
+}
+
+RX_LOOP_INSTANTIATE(pcap_rx, pcap_rx_loop, pcap_private_t);
+
+static int pcap_start(packet_receiver_t *receiver) {
+    pcap_private_t *priv = (pcap_private_t *)receiver->private_data;
+    if (!priv || !priv->map) return -1;
+
+    size_t first = priv->pcapng ? 0 : 24;
+    double speed = receiver->config.replay_speed;
+    uint32_t loops = receiver->config.replay_loops;
+
+    // Records stay in the mapping, so workers have nothing to hand back
+    pipeline_t *pipe = receiver->pipeline;
+    uint32_t batched = 0;
+    if (pipe) {
+        pipeline_attach(pipe, NULL, NULL, &receiver->running);
+    }
+
+    receiver->running = true;
+    printf("Starting pcap replay (%s, %s)...\n",
+           speed > 0 ? "recorded timing" : "maximum speed",
+           loops ? "finite loops" : "looping until stopped");
+
+    // Timed replay and workers keep the generic loop
+    if (!receiver->config.generic_loop && speed <= 0 && !pipe) {
+        unsigned variant = rx_loop_variant(receiver);
+        receiver->stats.rx_loop = rx_loop_name(variant);
+        return pcap_rx_variants[variant](receiver, priv);
+    }
+    receiver->stats.rx_loop = "generic";
+
+    for (uint32_t loop = 0; receiver->running && (loops == 0 || loop < loops); loop++) {
+        size_t off = first;
+        pcap_record_t rec;
+        uint64_t ts_base = 0;
+        uint64_t wall_base = get_time_ns();
+        bool have_base = false;
+
+        while (receiver->running && next_record(priv, &off, &rec)) {
+            if (speed > 0 && rec.ts_ns) {
+                if (!have_base) {
+                    ts_base = rec.ts_ns;
+                    have_base = true;
+                }
+                if (pipe && batched) {
+                    pipeline_flush(pipe);
+                    batched = 0;
+                }
+                // Records stamped before the first one (merged or multi-queue
+                // captures) go out immediately instead of wrapping the offset
+                if (rec.ts_ns > ts_base) {
+                    wait_until(wall_base + (uint64_t)((rec.ts_ns - ts_base) / speed), &receiver->running);
+                }
+            }
+
+            stats_update(&receiver->stats, rec.len);
+            if (pipe) {
+                pipeline_dispatch(pipe, rec.data, rec.caplen, rec.len, 0);
+                if (++batched == PIPE_BURST) {
+                    pipeline_flush(pipe);
+                    batched = 0;
+                }
+            } else if (receiver->stages) {
+                stages_process(receiver->stages, rec.data, rec.caplen);
+            }
+
+            if (receiver->config.verbose) {
+                printf("Packet replayed: %u bytes (captured %u)\n", rec.len, rec.caplen);
+            }
+        }
+    }
+    return 0;
+}
+
+static int pcap_stop(packet_receiver_t *receiver) {
+    if (receiver) {
+        receiver->running = false;
+    }
+    return 0;
+}
+
+static void pcap_cleanup(packet_receiver_t *receiver) {
+    pcap_private_t *priv = (pcap_private_t *)receiver->private_data;
+
+    if (priv) {
+        if (priv->map) {
+            munmap((void *)priv->map, priv->size);
+            priv->map = NULL;
+        }
+        free(priv);
+        receiver->private_data = NULL;
+    }
+}
+
+// Create pcap replay receiver
+packet_receiver_t* pcap_receiver_create(void) {
+    packet_receiver_t *receiver = calloc(1, sizeof(packet_receiver_t));
+    if (!receiver) return NULL;
+
+    receiver->mode = MODE_PCAP;
+    receiver->ops.init = pcap_init;
+    receiver->ops.start = pcap_start;
+    receiver->ops.stop = pcap_stop;
+    receiver->ops.cleanup = pcap_cleanup;
+
+    stats_init(&receiver->stats);
+
+    return receiver;
+}
@@ -0,0 +1,8 @@
+#ifndef PCAP_RECEIVER_H
+#define PCAP_RECEIVER_H
+
+#include "../../include/packet_receiver.h"
+
+packet_receiver_t* pcap_receiver_create(void);
+
+#endif // PCAP_RECEIVER_H
@@ -0,0 +1,307 @@
+#define _DEFAULT_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <errno.h>
+#include <arpa/inet.h>
+#include "../include/common.h"
+#include "../include/packet_sender.h"
+#include "../include/hugemem.h"
+
+// External sender creation functions
+#include "socket/socket_sender.h"
+#include "af_xdp/af_xdp_sender.h"
+#include "dpdk/dpdk_sender.h"
+
+static packet_sender_t *g_sender = NULL;
+
+// Signal handling
+static void signal_handler(int sig) {
+    (void)sig;
+    if (g_sender && g_sender->ops.stop) {
+        printf("\nInterrupt signal received, stopping...\n");
+        g_sender->ops.stop(g_sender);
+    }
+}
+
+typedef struct {
+    pthread_t main_tid;
+    int sleep_seconds;
+} thread_args_t;
+
+static void* terminate_thread(void *arg) {
+    thread_args_t *args = (thread_args_t *)arg;
+    sleep(args->sleep_seconds);
+    printf("Terminate thread, duration: %d seconds\n", args->sleep_seconds);
+    pthread_kill(args->main_tid, SIGINT);
+    return NULL;
+}
+
+// Accepts plain numbers or k/M/G suffixes ("500k", "14.88M"); 0 means unlimited.
+// Returns -1 for anything else, including rates that round to zero.
+static int parse_rate(const char *str, uint64_t *rate) {
+    char *end;
+    double v = strtod(str, &end);
+    if (end == str) return -1;
+    if (*end == 'k' || *end == 'K') { v *= 1e3; end++; }
+    else if (*end == 'm' || *end == 'M') { v *= 1e6; end++; }
+    else if (*end == 'g' || *end == 'G') { v *= 1e9; end++; }
+    if (*end != '\0' || !(v >= 0) || v > (double)PACER_MAX_RATE) return -1;
+    if (v > 0 && v < 1) return -1;
+    *rate = (uint64_t)v;
+    return 0;
+}
+
+static void print_usage(const char *prog) {
+    printf("Usage: %s [options]\n", prog);
+    printf("Options:\n");
+    printf("  --mode <socket|af_xdp|dpdk>  Transmit mode (default: socket)\n");
+    printf("  --interface <name>, -i       Network interface (default: eth0)\n");
+    printf("  --address <pci address>, -a  PCI address (default: 0000:03:00.0), used for DPDK mode\n");
+    printf("  --queue <N>                  TX queue, used for AF_XDP mode (default: 0)\n");
+    printf("  --dst-mac <mac>              Destination MAC (default: ff:ff:ff:ff:ff:ff)\n");
+    printf("  --src-mac <mac>              Source MAC (default: interface address)\n");
+    printf("  --dst-ip <addr>              Destination IPv4 address (default: 10.0.0.2)\n");
+    printf("  --src-ip <addr>              Source IPv4 address (default: 10.0.0.1)\n");
+    printf("  --dst-port <port>            UDP destination port (default: 9)\n");
+    printf("  --src-port <port>            First UDP source port; flow i uses port + i (default: 1024)\n");
+    printf("  --size <mix>                 Frame sizes incl. FCS, e.g. 64 or 64:7,576:4,1500:1 (default: 64)\n");
+    printf("  --flows <N>                  Number of flows (default: 1, max: %d)\n", PROBE_MAX_FLOWS);
+    printf("  --rate <pps>                 Target packet rate up to 1G, k/M/G suffixes allowed (0=max, default: 0)\n");
+    printf("  --count <N>                  Packets to send (0=until stopped, default: 0)\n");
+    printf("  --batch <N>                  Packets per TX burst (default: 64)\n");
+    printf("  --duration <seconds>         Runtime duration (0=infinite, default: 0)\n");
+    printf("  --json <file>                Write the run summary to a JSON file\n");
+    printf("  --verbose, -v                Verbose output\n");
+    printf("  --help, -h                   Show this help\n");
+}
+
+static int parse_sender_args(int argc, char *argv[], sender_config_t *config) {
+    memset(config, 0, sizeof(*config));
+    config->mode = MODE_SOCKET;
+    strncpy(config->interface, "eth0", sizeof(config->interface) - 1);
+    strncpy(config->address, "0000:03:00.0", sizeof(config->address) - 1);
+    memset(config->traffic.dst_mac, 0xFF, 6);
+    inet_pton(AF_INET, "10.0.0.1", &config->traffic.src_ip);
+    inet_pton(AF_INET, "10.0.0.2", &config->traffic.dst_ip);
+    config->traffic.src_port = 1024;
+    config->traffic.dst_port = 9;
+    config->traffic.flows = 1;
+    config->traffic.num_sizes = 1;
+    config->traffic.sizes[0] = 64;
+    config->traffic.weights[0] = 1;
+    config->batch = 64;
+
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        const char *val = i + 1 < argc ? argv[i + 1] : NULL;
+
+        if (strcmp(arg, "--verbose") == 0 || strcmp(arg, "-v") == 0) {
+            config->verbose = true;
+            continue;
+        }
+        if (strcmp(arg, "--help") == 0 || strcmp(arg, "-h") == 0 || !val) {
+            print_usage(argv[0]);
+            return 1;
+        }
+
+        if (strcmp(arg, "--mode") == 0) {
+            if (strcmp(val, "socket") == 0) {
+                config->mode = MODE_SOCKET;
+            } else if (strcmp(val, "af_xdp") == 0) {
+                config->mode = MODE_AF_XDP;
+            } else if (strcmp(val, "dpdk") == 0) {
+                config->mode = MODE_DPDK;
+            } else {
+                fprintf(stderr, "Error: Unknown transmit mode %s\n", val);
+                return -1;
+            }
+        } else if (strcmp(arg, "--interface") == 0 || strcmp(arg, "-i") == 0) {
+            strncpy(config->interface, val, sizeof(config->interface) - 1);
+        } else if (strcmp(arg, "--address") == 0 || strcmp(arg, "-a") == 0) {
+            strncpy(config->address, val, sizeof(config->address) - 1);
+        } else if (strcmp(arg, "--queue") == 0) {
+            config->queue = atoi(val);
+        } else if (strcmp(arg, "--dst-mac") == 0) {
+            if (traffic_parse_mac(val, config->traffic.dst_mac) != 0) {
+                fprintf(stderr, "Error: Invalid MAC address %s\n", val);
+                return -1;
+            }
+        } else if (strcmp(arg, "--src-mac") == 0) {
+            if (traffic_parse_mac(val, config->traffic.src_mac) != 0) {
+                fprintf(stderr, "Error: Invalid MAC address %s\n", val);
+                return -1;
+            }
+            config->src_mac_set = true;
+        } else if (strcmp(arg, "--dst-ip") == 0 || strcmp(arg, "--src-ip") == 0) {
+            uint32_t *ip = arg[2] == 'd' ? &config->traffic.dst_ip : &config->traffic.src_ip;
+            if (inet_pton(AF_INET, val, ip) != 1) {
+                fprintf(stderr, "Error: Invalid IPv4 address %s\n", val);
+                return -1;
+            }
+        } else if (strcmp(arg, "--dst-port") == 0) {
+            config->traffic.dst_port = (uint16_t)atoi(val);
+        } else if (strcmp(arg, "--src-port") == 0) {
+            config->traffic.src_port = (uint16_t)atoi(val);
+        } else if (strcmp(arg, "--size") == 0) {
+            if (traffic_parse_sizes(val, &config->traffic) != 0) {
+                fprintf(stderr, "Error: Invalid size mix %s\n", val);
+                return -1;
+            }
+        } else if (strcmp(arg, "--flows") == 0) {
+            config->traffic.flows = atoi(val);
+            if (config->traffic.flows == 0 || config->traffic.flows > PROBE_MAX_FLOWS) {
+                fprintf(stderr, "Error: Flow count must be between 1 and %d\n", PROBE_MAX_FLOWS);
+                return -1;
+            }
+        } else if (strcmp(arg, "--rate") == 0) {
+            if (parse_rate(val, &config->rate_pps) != 0) {
+                fprintf(stderr, "Error: Invalid rate %s (0 for unlimited, or 1 to %llu pps)\n",
+                        val, PACER_MAX_RATE);
+                return -1;
+            }
+        } else if (strcmp(arg, "--count") == 0) {
+            config->count = strtoull(val, NULL, 10);
+        } else if (strcmp(arg, "--batch") == 0) {
+            config->batch = atoi(val);
+            if (config->batch == 0) config->batch = 1;
+        } else if (strcmp(arg, "--duration") == 0) {
+            config->duration_sec = atoi(val);
+        } else if (strcmp(arg, "--json") == 0) {
+            strncpy(config->json_file, val, sizeof(config->json_file) - 1);
+        } else {
+            print_usage(argv[0]);
+            return 1;
+        }
+        i++;
+    }
+    return 0;
+}
+
+static void sender_summarize(const packet_sender_t *sender) {
+    const sender_stats_t *stats = &sender->stats;
+    const sender_config_t *config = &sender->config;
+    double runtime_sec = (stats->end_time_ns - stats->start_time_ns) / 1e9;
+    double pps = runtime_sec > 0 ? stats->packets_sent / runtime_sec : 0;
+    double bps = runtime_sec > 0 ? stats->bytes_sent * 8.0 / runtime_sec : 0;
+
+    printf("\n========== Sender Statistics ==========\n");
+    printf("Run time: %.2f seconds\n", runtime_sec);
+    printf("Packets sent: %lu\n", stats->packets_sent);
+    printf("Bytes sent: %lu (%.2f MB)\n", stats->bytes_sent, stats->bytes_sent / (1024.0 * 1024.0));
+    if (config->rate_pps) {
+        printf("Packet rate: %.2f PPS (target: %lu PPS)\n", pps, config->rate_pps);
+    } else {
+        printf("Packet rate: %.2f PPS\n", pps);
+    }
+    printf("Bit rate: %.2f Mbps\n", bps / 1e6);
+    printf("Flows: %u, size mix:", config->traffic.flows);
+    for (uint32_t i = 0; i < config->traffic.num_sizes; i++) {
+        printf(" %u:%u", config->traffic.sizes[i], config->traffic.weights[i]);
+    }
+    printf("\nTX retries: %lu\n", stats->tx_retries);
+    printf("=======================================\n");
+}
+
+static int sender_write_json(const packet_sender_t *sender, const char *path) {
+    const sender_stats_t *stats = &sender->stats;
+    FILE *f = fopen(path, "w");
+    if (!f) {
+        fprintf(stderr, "Error: Failed to open %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+
+    double runtime_sec = (stats->end_time_ns - stats->start_time_ns) / 1e9;
+    fprintf(f, "{\"mode\": \"%s\", \"runtime_sec\": %.6f, \"tx_packets\": %lu, \"tx_bytes\": %lu, ",
+            mode_name(sender->config.mode), runtime_sec, stats->packets_sent, stats->bytes_sent);
+    fprintf(f, "\"tx_pps\": %.2f, \"tx_bps\": %.2f, \"target_pps\": %lu, \"tx_retries\": %lu, "
+               "\"flows\": %u, \"batch\": %u}\n",
+            runtime_sec > 0 ? stats->packets_sent / runtime_sec : 0.0,
+            runtime_sec > 0 ? stats->bytes_sent * 8.0 / runtime_sec : 0.0,
+            sender->config.rate_pps, stats->tx_retries, sender->config.traffic.flows, sender->config.batch);
+    return fclose(f) == 0 ? 0 : -1;
+}
+
+int main(int argc, char *argv[]) {
+    sender_config_t config;
+    packet_sender_t *sender = NULL;
+
+    print_banner();
+
+    int ret = parse_sender_args(argc, argv, &config);
+    if (ret != 0) {
+        return ret < 0 ? 1 : 0;
+    }
+
+    signal(SIGINT, signal_handler);
+    signal(SIGTERM, signal_handler);
+
+    switch (config.mode) {
+        case MODE_SOCKET:
+            sender = socket_sender_create();
+            break;
+        case MODE_AF_XDP:
+            sender = af_xdp_sender_create();
+            break;
+        case MODE_DPDK:
+            sender = dpdk_sender_create();
+            break;
+        default:
+            fprintf(stderr, "Error: Unknown transmit mode\n");
+            return 1;
+    }
+
+    if (!sender) {
+        fprintf(stderr, "Error: Failed to create sender (mode not built in?)\n");
+        return 1;
+    }
+
+    g_sender = sender;
+    sender->config = config;
+
+    // Backends may fill in the source MAC and clamp the batch size
+    if (sender->ops.init(sender, &config) != 0) {
+        fprintf(stderr, "Error: Sender initialization failed\n");
+        sender->ops.cleanup(sender);
+        free(sender);
+        return 1;
+    }
+    if (traffic_gen_init(&sender->gen, &sender->config.traffic) != 0) {
+        fprintf(stderr, "Error: Failed to set up the traffic generator\n");
+        sender->ops.cleanup(sender);
+        free(sender);
+        return 1;
+    }
+    pacer_init(&sender->pacer, sender->config.rate_pps, sender->config.batch);
+
+    thread_args_t args;
+    args.main_tid = pthread_self();
+    args.sleep_seconds = config.duration_sec;
+    if (config.duration_sec > 0) {
+        pthread_t terminate_thread_id;
+        pthread_create(&terminate_thread_id, NULL, terminate_thread, &args);
+        pthread_detach(terminate_thread_id);
+    }
+
+    sender->stats.start_time_ns = get_time_ns();
+    if (sender->ops.start(sender) != 0) {
+        fprintf(stderr, "Error: Sender start failed\n");
+    }
+    sender->stats.end_time_ns = get_time_ns();
+    sender_summarize(sender);
+    hugemem_report();
+    if (sender->config.json_file[0]) {
+        sender_write_json(sender, sender->config.json_file);
+    }
+
+    traffic_gen_cleanup(&sender->gen);
+    sender->ops.cleanup(sender);
+    g_sender = NULL;
+    free(sender);
+
+    printf("Program terminated\n");
+    return 0;
+}
@@ -1,4 +1,4 @@
-#define _DEFAULT_SOURCE
+#define _GNU_SOURCE
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -14,11 +14,45 @@
 #include <pthread.h>
 #include "../../include/common.h"
 #include "../../include/packet_receiver.h"
+#include "../../include/forward.h"
+#include "../../include/hugemem.h"
+#include "../../include/rx_loop.h"
+
+#define SLOT_SIZE 2048
+#define DEFAULT_BATCH_SIZE 32        // Datagrams per recvmmsg in the specialized loops (--batch)
 
 typedef struct {
     int socket_fd;
+    int out_fd;          // Forwarding socket (socket_fd unless a second interface is used)
+    uint32_t batch;      // Datagrams per recvmmsg
+
+    // Pipeline mode: packets are received into slots that stay owned by a worker
+    // until it hands them back
+    uint8_t *slots;
+    uint32_t *free_slots;
+    uint32_t num_free;
 } socket_private_t;
 
+// Raw socket used only to transmit on the forwarding interface
+static int open_out_socket(const char *ifname) {
+    int fd = socket(AF_PACKET, SOCK_RAW, 0);
+    if (fd < 0) {
+        fprintf(stderr, "socket: %s\n", strerror(errno));
+        return -1;
+    }
+
+    struct sockaddr_ll sll;
+    memset(&sll, 0, sizeof(sll));
+    sll.sll_family = AF_PACKET;
+    sll.sll_ifindex = (int)if_nametoindex(ifname);
+    if (sll.sll_ifindex == 0 || bind(fd, (struct sockaddr *)&sll, sizeof(sll)) < 0) {
+        fprintf(stderr, "bind %s: %s\n", ifname, strerror(errno));
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
 static int socket_init(packet_receiver_t *receiver, const config_t *config) {
     socket_private_t *priv = (socket_private_t *)receiver->private_data;
     
@@ -26,8 +60,12 @@ static int socket_init(packet_receiver_t *receiver, const config_t *config) {
         priv = calloc(1, sizeof(socket_private_t));
         if (!priv) return -1;
         receiver->private_data = priv;
+        priv->out_fd = -1;
     }
     
+    priv->batch = config->batch_size ? config->batch_size : DEFAULT_BATCH_SIZE;
+    receiver->config.batch_size = priv->batch;
+
     // create raw socket
     priv->socket_fd = socket(AF_PACKET, SOCK_RAW, htons(ETH_P_ALL));
     if (priv->socket_fd < 0) {
@@ -72,10 +110,126 @@ static int socket_init(packet_receiver_t *receiver, const config_t *config) {
         exit(1);
     }
 
-    printf("Socket mode initialized successfully, interface: %s\n", config->interface);
+    priv->out_fd = priv->socket_fd;
+    if (config->forward) {
+        // Don't read back our own transmissions
+        int one = 1;
+        if (setsockopt(priv->socket_fd, SOL_PACKET, PACKET_IGNORE_OUTGOING, &one, sizeof(one)) < 0) {
+            fprintf(stderr, "setsockopt PACKET_IGNORE_OUTGOING: %s\n", strerror(errno));
+            return -1;
+        }
+        if (config->out_interface[0]) {
+            priv->out_fd = open_out_socket(config->out_interface);
+            if (priv->out_fd < 0) return -1;
+        }
+        setsockopt(priv->out_fd, SOL_PACKET, PACKET_QDISC_BYPASS, &one, sizeof(one));
+        printf("Forwarding to %s (the kernel copies in socket mode)\n",
+               config->out_interface[0] ? config->out_interface : config->interface);
+    }
+
+    printf("Socket mode initialized successfully, interface: %s (batch %u)\n", config->interface, priv->batch);
     return 0;
 }
 
+static void socket_release(void *ctx, const pipe_desc_t *descs, uint32_t n) {
+    socket_private_t *priv = (socket_private_t *)ctx;
+    for (uint32_t i = 0; i < n; i++) {
+        priv->free_slots[priv->num_free++] = (uint32_t)descs[i].cookie;
+    }
+}
+
+// Pipeline receive loop: block for the first packet, then drain what is queued
+// without blocking so workers get batches
+static int socket_pipeline(packet_receiver_t *receiver, socket_private_t *priv) {
+    pipeline_t *pipe = receiver->pipeline;
+    uint32_t num_slots = pipe->num_workers * (pipe->ring_size + PIPE_BURST) + PIPE_STAGE;
+
+    priv->slots = hugemem_alloc((size_t)num_slots * SLOT_SIZE, receiver->config.numa_node,
+                                "Socket receive slots");
+    priv->free_slots = malloc(num_slots * sizeof(uint32_t));
+    if (!priv->slots || !priv->free_slots) {
+        fprintf(stderr, "Error: Failed to allocate receive slots\n");
+        return -1;
+    }
+    for (uint32_t i = 0; i < num_slots; i++) {
+        priv->free_slots[i] = num_slots - 1 - i;
+    }
+    priv->num_free = num_slots;
+    pipeline_attach(pipe, socket_release, priv, &receiver->running);
+
+    while (receiver->running) {
+        uint32_t packets = 0;
+        uint64_t bytes = 0;
+        for (uint32_t n = 0; n < PIPE_BURST && receiver->running; n++) {
+            if (priv->num_free == 0) {
+                pipeline_flush(pipe);
+                if (priv->num_free == 0) break;
+            }
+            uint32_t slot = priv->free_slots[priv->num_free - 1];
+            uint8_t *buf = priv->slots + (size_t)slot * SLOT_SIZE;
+
+            ssize_t len = recvfrom(priv->socket_fd, buf, SLOT_SIZE, n ? MSG_DONTWAIT : 0, NULL, NULL);
+            if (len <= 0) break;
+
+            priv->num_free--;
+            packets++;
+            bytes += len;
+            pipeline_dispatch(pipe, buf, len, len, slot);
+        }
+        stats_update_batch(&receiver->stats, packets, bytes);
+        pipeline_flush(pipe);
+    }
+    return 0;
+}
+
+// Specialized loop body: one recvmmsg per burst and one stats update per burst
+RX_ALWAYS_INLINE int socket_rx_loop(packet_receiver_t *receiver, socket_private_t *priv,
+                                    const bool verbose, const bool stages) {
+    const uint32_t batch = priv->batch;
+    // On the heap: the largest --batch needs 1 MB of buffers
+    uint8_t *bufs = malloc((size_t)batch * SLOT_SIZE);
+    struct mmsghdr *msgs = calloc(batch, sizeof(struct mmsghdr));
+    struct iovec *iovs = calloc(batch, sizeof(struct iovec));
+    if (!bufs || !msgs || !iovs) {
+        fprintf(stderr, "Error: Failed to allocate receive buffers\n");
+        free(bufs);
+        free(msgs);
+        free(iovs);
+        return -1;
+    }
+
+    for (uint32_t i = 0; i < batch; i++) {
+        iovs[i].iov_base = bufs + (size_t)i * SLOT_SIZE;
+        iovs[i].iov_len = SLOT_SIZE;
+        msgs[i].msg_hdr.msg_iov = &iovs[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    while (receiver->running) {
+        int n = recvmmsg(priv->socket_fd, msgs, batch, MSG_WAITFORONE, NULL);
+        if (n <= 0) continue;
+
+        uint64_t bytes = 0;
+        for (int i = 0; i < n; i++) {
+            uint32_t len = msgs[i].msg_len;
+            bytes += len;
+            if (stages) {
+                stages_process(receiver->stages, bufs + (size_t)i * SLOT_SIZE, len);
+            }
+            if (verbose) {
+                printf("Raw packet received: %u bytes\n", len);
+            }
+        }
+        stats_update_batch(&receiver->stats, (uint32_t)n, bytes);
+    }
+    free(bufs);
+    free(msgs);
+    free(iovs);
+    return 0;
+}
+
+RX_LOOP_INSTANTIATE(socket_rx, socket_rx_loop, socket_private_t);
+
 static int socket_start(packet_receiver_t *receiver) {
     socket_private_t *priv = (socket_private_t *)receiver->private_data;
     if (!priv || priv->socket_fd < 0) return -1;
@@ -85,12 +239,31 @@ static int socket_start(packet_receiver_t *receiver) {
     
     receiver->running = true;
     printf("Starting packet reception...\n");
+
+    if (receiver->pipeline) {
+        return socket_pipeline(receiver, priv);
+    }
+    // Forwarding sends per packet and keeps the generic loop
+    if (!receiver->config.generic_loop && !receiver->config.forward) {
+        unsigned variant = rx_loop_variant(receiver);
+        receiver->stats.rx_loop = rx_loop_name(variant);
+        return socket_rx_variants[variant](receiver, priv);
+    }
+    receiver->stats.rx_loop = "generic";
     
     while (receiver->running) {
         ssize_t len = recvfrom(priv->socket_fd, buf, sizeof(buf), 0, NULL, NULL);
         
         if (len > 0) {
             stats_update(&receiver->stats, len);
+            if (receiver->stages) {
+                stages_process(receiver->stages, buf, len);
+            }
+            if (receiver->config.forward) {
+                forward_swap_mac(buf);
+                bool sent = send(priv->out_fd, buf, len, 0) == len;
+                stats_update_forward(&receiver->stats, sent, !sent);
+            }
             if (receiver->config.verbose) {
                 printf("Raw packet received: %ld bytes\n", len);
             }
@@ -110,10 +283,15 @@ static void socket_cleanup(packet_receiver_t *receiver) {
     socket_private_t *priv = (socket_private_t *)receiver->private_data;
     
     if (priv) {
+        if (priv->out_fd >= 0 && priv->out_fd != priv->socket_fd) {
+            close(priv->out_fd);
+        }
         if (priv->socket_fd >= 0) {
             close(priv->socket_fd);
             priv->socket_fd = -1;
         }
+        hugemem_free(priv->slots);
+        free(priv->free_slots);
         free(priv);
         receiver->private_data = NULL;
     }
@@ -0,0 +1,166 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <linux/if_packet.h>
+#include <linux/if_ether.h>
+#include <net/if.h>
+#include <arpa/inet.h>
+#include "../../include/common.h"
+#include "../../include/packet_sender.h"
+
+#define SLOT_SIZE 2048
+#define MAX_BATCH 1024
+
+typedef struct {
+    int socket_fd;
+    uint8_t *slots;                  // One frame buffer per batch entry
+    struct mmsghdr *msgs;
+    struct iovec *iovs;
+} socket_sender_private_t;
+
+static int socket_sender_init(packet_sender_t *sender, const sender_config_t *config) {
+    socket_sender_private_t *priv = (socket_sender_private_t *)sender->private_data;
+
+    if (!priv) {
+        priv = calloc(1, sizeof(socket_sender_private_t));
+        if (!priv) return -1;
+        priv->socket_fd = -1;
+        sender->private_data = priv;
+    }
+
+    // Protocol 0: transmit only, nothing is queued for reception on this socket
+    priv->socket_fd = socket(AF_PACKET, SOCK_RAW, 0);
+    if (priv->socket_fd < 0) {
+        fprintf(stderr, "socket: %s\n", strerror(errno));
+        return -1;
+    }
+
+    unsigned int ifindex = if_nametoindex(config->interface);
+    if (ifindex == 0) {
+        fprintf(stderr, "Error: Unknown interface %s\n", config->interface);
+        return -1;
+    }
+
+    struct sockaddr_ll sll;
+    memset(&sll, 0, sizeof(sll));
+    sll.sll_family = AF_PACKET;
+    sll.sll_ifindex = (int)ifindex;
+    if (bind(priv->socket_fd, (struct sockaddr *)&sll, sizeof(sll)) < 0) {
+        fprintf(stderr, "bind: %s\n", strerror(errno));
+        return -1;
+    }
+
+    // Hand frames straight to the driver; not supported everywhere, so failure is fine
+    int one = 1;
+    setsockopt(priv->socket_fd, SOL_PACKET, PACKET_QDISC_BYPASS, &one, sizeof(one));
+
+    if (!config->src_mac_set &&
+        traffic_interface_mac(config->interface, sender->config.traffic.src_mac) != 0) {
+        fprintf(stderr, "Warning: Could not read the MAC address of %s\n", config->interface);
+    }
+
+    uint32_t batch = config->batch > MAX_BATCH ? MAX_BATCH : config->batch;
+    sender->config.batch = batch;
+    priv->slots = malloc((size_t)batch * SLOT_SIZE);
+    priv->msgs = calloc(batch, sizeof(struct mmsghdr));
+    priv->iovs = calloc(batch, sizeof(struct iovec));
+    if (!priv->slots || !priv->msgs || !priv->iovs) {
+        fprintf(stderr, "Error: Failed to allocate TX buffers\n");
+        return -1;
+    }
+    for (uint32_t i = 0; i < batch; i++) {
+        priv->iovs[i].iov_base = priv->slots + (size_t)i * SLOT_SIZE;
+        priv->msgs[i].msg_hdr.msg_iov = &priv->iovs[i];
+        priv->msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    printf("Socket sender initialized successfully, interface: %s\n", config->interface);
+    return 0;
+}
+
+static int socket_sender_start(packet_sender_t *sender) {
+    socket_sender_private_t *priv = (socket_sender_private_t *)sender->private_data;
+    if (!priv || priv->socket_fd < 0) return -1;
+
+    sender->running = true;
+    printf("Starting packet transmission (sendmmsg)...\n");
+
+    while (sender->running) {
+        uint32_t n = sender_next_burst(sender);
+        if (n == 0) break;
+
+        uint64_t now = get_time_ns();
+        for (uint32_t i = 0; i < n; i++) {
+            priv->iovs[i].iov_len = traffic_gen_build(&sender->gen, priv->iovs[i].iov_base, now);
+        }
+
+        // Every built frame must go out, or its sequence number would read as loss
+        uint32_t sent = 0;
+        while (sent < n && sender->running) {
+            int ret = sendmmsg(priv->socket_fd, priv->msgs + sent, n - sent, 0);
+            if (ret < 0) {
+                if (errno == ENOBUFS || errno == EAGAIN || errno == EINTR) {
+                    sender->stats.tx_retries++;
+                    continue;
+                }
+                fprintf(stderr, "sendmmsg: %s\n", strerror(errno));
+                sender->running = false;
+                break;
+            }
+            for (int i = 0; i < ret; i++) {
+                sender->stats.bytes_sent += priv->iovs[sent + i].iov_len;
+            }
+            sent += (uint32_t)ret;
+            if (sent < n) sender->stats.tx_retries++;
+        }
+        sender->stats.packets_sent += sent;
+
+        if (sender->config.verbose) {
+            printf("Burst sent: %u packets\n", sent);
+        }
+    }
+    return 0;
+}
+
+static int socket_sender_stop(packet_sender_t *sender) {
+    if (sender) {
+        sender->running = false;
+    }
+    return 0;
+}
+
+static void socket_sender_cleanup(packet_sender_t *sender) {
+    socket_sender_private_t *priv = (socket_sender_private_t *)sender->private_data;
+
+    if (priv) {
+        if (priv->socket_fd >= 0) {
+            close(priv->socket_fd);
+            priv->socket_fd = -1;
+        }
+        free(priv->slots);
+        free(priv->msgs);
+        free(priv->iovs);
+        free(priv);
+        sender->private_data = NULL;
+    }
+}
+
+// Create Socket sender
+packet_sender_t* socket_sender_create(void) {
+    packet_sender_t *sender = calloc(1, sizeof(packet_sender_t));
+    if (!sender) return NULL;
+
+    sender->mode = MODE_SOCKET;
+    sender->ops.init = socket_sender_init;
+    sender->ops.start = socket_sender_start;
+    sender->ops.stop = socket_sender_stop;
+    sender->ops.cleanup = socket_sender_cleanup;
+
+    return sender;
+}
@@ -0,0 +1,8 @@
+#ifndef SOCKET_SENDER_H
+#define SOCKET_SENDER_H
+
+#include "../../include/packet_sender.h"
+
+packet_sender_t* socket_sender_create(void);
+
+#endif // SOCKET_SENDER_H
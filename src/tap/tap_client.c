@@ -0,0 +1,214 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include "../../include/tap.h"
+
+// Client side of the packet tap: receive the ring's fd from packet_receiver,
+// map it and read packets in place. Only depends on libc.
+
+struct tap_client {
+    tap_shm_t *shm;
+    size_t map_len;
+    const tap_desc_t *descs;
+    const uint8_t *data;
+    uint64_t mask;
+    uint64_t num_slots;
+    tap_consumer_t *me;
+    uint64_t pos;
+    uint64_t cur_seq;                // Sequence of the packet handed out by tap_client_next
+    uint64_t packets;
+    uint64_t drops;
+    uint64_t max_lag;
+};
+
+static int recv_fd(int sock) {
+    char byte;
+    struct iovec iov = { .iov_base = &byte, .iov_len = 1 };
+    union {
+        char buf[CMSG_SPACE(sizeof(int))];
+        struct cmsghdr align;
+    } ctrl;
+
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = ctrl.buf;
+    msg.msg_controllen = sizeof(ctrl.buf);
+
+    if (recvmsg(sock, &msg, MSG_CMSG_CLOEXEC) != 1) return -1;
+    struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+    if (!cmsg || cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS) return -1;
+
+    int fd;
+    memcpy(&fd, CMSG_DATA(cmsg), sizeof(int));
+    return fd;
+}
+
+// Take a free slot, or one left behind by a consumer that no longer exists
+static tap_consumer_t* claim_consumer(tap_shm_t *shm) {
+    for (int pass = 0; pass < 2; pass++) {
+        for (uint32_t i = 0; i < TAP_MAX_CONSUMERS; i++) {
+            tap_consumer_t *c = &shm->consumers[i];
+            uint32_t state = atomic_load(&c->state);
+            if (pass == 0 && state != TAP_CONSUMER_FREE) continue;
+            if (pass == 1 && state == TAP_CONSUMER_ACTIVE && (kill(c->pid, 0) == 0 || errno != ESRCH)) continue;
+            if (atomic_compare_exchange_strong(&c->state, &state, TAP_CONSUMER_ACTIVE)) return c;
+        }
+    }
+    return NULL;
+}
+
+tap_client_t* tap_client_open(const char *socket_path) {
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (strlen(socket_path) >= sizeof(addr.sun_path)) {
+        errno = ENAMETOOLONG;
+        return NULL;
+    }
+    strncpy(addr.sun_path, socket_path, sizeof(addr.sun_path) - 1);
+
+    int sock = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (sock < 0) return NULL;
+    if (connect(sock, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        close(sock);
+        return NULL;
+    }
+    int fd = recv_fd(sock);
+    close(sock);
+    if (fd < 0) {
+        errno = EPROTO;
+        return NULL;
+    }
+
+    struct stat st;
+    void *map = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && st.st_size > (off_t)sizeof(tap_shm_t)) {
+        map = mmap(NULL, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (map == MAP_FAILED) return NULL;
+
+    tap_shm_t *shm = map;
+    if (shm->magic != TAP_MAGIC || shm->version != TAP_VERSION) {
+        munmap(map, (size_t)st.st_size);
+        errno = EPROTO;
+        return NULL;
+    }
+    atomic_thread_fence(memory_order_acquire);
+
+    tap_client_t *client = calloc(1, sizeof(tap_client_t));
+    tap_consumer_t *me = client ? claim_consumer(shm) : NULL;
+    if (!me) {
+        free(client);
+        munmap(map, (size_t)st.st_size);
+        errno = EBUSY;
+        return NULL;
+    }
+
+    client->shm = shm;
+    client->map_len = (size_t)st.st_size;
+    client->descs = (const tap_desc_t *)((uint8_t *)shm + shm->desc_offset);
+    client->data = (const uint8_t *)shm + shm->data_offset;
+    client->num_slots = shm->num_slots;
+    client->mask = shm->num_slots - 1;
+    client->me = me;
+    // Start with the next packet; history is not replayed
+    client->pos = atomic_load_explicit(&shm->head, memory_order_acquire);
+
+    me->pid = getpid();
+    atomic_store_explicit(&me->pos, client->pos, memory_order_relaxed);
+    atomic_store_explicit(&me->packets, 0, memory_order_relaxed);
+    atomic_store_explicit(&me->drops, 0, memory_order_relaxed);
+    atomic_store_explicit(&me->max_lag, 0, memory_order_relaxed);
+    return client;
+}
+
+// 1: packet in *pkt (call tap_client_done after using it), 0: nothing new yet,
+// -1: the receiver has stopped and everything published has been read
+int tap_client_next(tap_client_t *client, tap_packet_t *pkt) {
+    for (;;) {
+        uint64_t pos = client->pos;
+        const tap_desc_t *desc = &client->descs[pos & client->mask];
+        uint64_t seq = atomic_load_explicit(&desc->seq, memory_order_acquire);
+
+        if (seq == 2 * pos + 2) {
+            pkt->data = client->data + (size_t)(pos & client->mask) * TAP_SLOT_SIZE;
+            pkt->len = desc->len;
+            pkt->caplen = desc->caplen;
+            pkt->ts_ns = desc->ts_ns;
+            client->cur_seq = seq;
+            return 1;
+        }
+        if (seq < 2 * pos + 2) {
+            // Not published yet
+            if (atomic_load_explicit(&client->shm->closed, memory_order_acquire) &&
+                atomic_load_explicit(&client->shm->head, memory_order_acquire) <= pos) {
+                return -1;
+            }
+            return 0;
+        }
+
+        // Lapped: skip to the middle of the ring so the next read has headroom
+        uint64_t head = atomic_load_explicit(&client->shm->head, memory_order_acquire);
+        uint64_t resume = head > client->num_slots / 2 ? head - client->num_slots / 2 : 0;
+        if (resume <= pos) resume = pos + 1;
+        client->drops += resume - pos;
+        client->pos = resume;
+        atomic_store_explicit(&client->me->drops, client->drops, memory_order_relaxed);
+    }
+}
+
+// Confirms the packet was not overwritten while it was being used; false means
+// its contents may be torn (counted as a drop)
+bool tap_client_done(tap_client_t *client) {
+    const tap_desc_t *desc = &client->descs[client->pos & client->mask];
+    atomic_thread_fence(memory_order_acquire);
+    bool intact = atomic_load_explicit(&desc->seq, memory_order_relaxed) == client->cur_seq;
+
+    if (intact) {
+        client->packets++;
+        atomic_store_explicit(&client->me->packets, client->packets, memory_order_relaxed);
+    } else {
+        client->drops++;
+        atomic_store_explicit(&client->me->drops, client->drops, memory_order_relaxed);
+    }
+    client->pos++;
+    atomic_store_explicit(&client->me->pos, client->pos, memory_order_relaxed);
+
+    // The producer's head is written every packet; sample it rather than bounce its cache line
+    if (client->pos & 63) return intact;
+    uint64_t lag = tap_client_lag(client);
+    if (lag > client->max_lag) {
+        client->max_lag = lag;
+        atomic_store_explicit(&client->me->max_lag, lag, memory_order_relaxed);
+    }
+    return intact;
+}
+
+// Packets published but not read yet
+uint64_t tap_client_lag(const tap_client_t *client) {
+    uint64_t head = atomic_load_explicit(&client->shm->head, memory_order_relaxed);
+    return head > client->pos ? head - client->pos : 0;
+}
+
+const tap_consumer_t* tap_client_counters(const tap_client_t *client) {
+    return client->me;
+}
+
+void tap_client_close(tap_client_t *client) {
+    if (!client) return;
+    atomic_store_explicit(&client->me->state, TAP_CONSUMER_DETACHED, memory_order_release);
+    munmap(client->shm, client->map_len);
+    free(client);
+}
@@ -0,0 +1,117 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <signal.h>
+#include <time.h>
+#include "../../include/tap.h"
+
+// Example tap consumer: counts what packet_receiver --tap publishes and prints
+// its own rate, lag and drops once a second.
+
+static volatile sig_atomic_t g_stop = 0;
+
+static void signal_handler(int sig) {
+    (void)sig;
+    g_stop = 1;
+}
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void usage(const char *prog) {
+    printf("Usage: %s <socket path> [options]\n", prog);
+    printf("Options:\n");
+    printf("  --duration <seconds>  Stop after this long (0=until the receiver stops, default: 0)\n");
+    printf("  --dump <N>            Hex-dump the first 64 bytes of the first N packets\n");
+    printf("  --work <ns>           Busy time per packet, to simulate a slow analyzer\n");
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 2 || strcmp(argv[1], "--help") == 0 || strcmp(argv[1], "-h") == 0) {
+        usage(argv[0]);
+        return argc < 2 ? 1 : 0;
+    }
+
+    uint32_t duration = 0, dump = 0;
+    uint64_t work_ns = 0;
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "--duration") == 0 && i + 1 < argc) {
+            duration = (uint32_t)atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--dump") == 0 && i + 1 < argc) {
+            dump = (uint32_t)atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--work") == 0 && i + 1 < argc) {
+            work_ns = strtoull(argv[++i], NULL, 10);
+        } else {
+            fprintf(stderr, "Error: Unknown option %s\n", argv[i]);
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    signal(SIGINT, signal_handler);
+    signal(SIGTERM, signal_handler);
+
+    tap_client_t *client = tap_client_open(argv[1]);
+    if (!client) {
+        fprintf(stderr, "Error: Failed to attach to %s: %s\n", argv[1], strerror(errno));
+        return 1;
+    }
+    printf("Attached to %s\n", argv[1]);
+
+    uint64_t start = now_ns(), last = start, bytes = 0, last_packets = 0, idle = 0;
+    const tap_consumer_t *counters = tap_client_counters(client);
+    tap_packet_t pkt;
+
+    while (!g_stop) {
+        int ret = tap_client_next(client, &pkt);
+        if (ret < 0) break;
+        if (ret == 0) {
+            // Spin briefly, then back off so an idle reader does not burn a core
+            if (++idle > 1024) {
+                struct timespec ts = { 0, 50000 };
+                nanosleep(&ts, NULL);
+            }
+        } else {
+            idle = 0;
+            bytes += pkt.len;
+            if (dump) {
+                dump--;
+                printf("%u bytes (captured %u):", pkt.len, pkt.caplen);
+                for (uint32_t i = 0; i < pkt.caplen && i < 64; i++) printf(" %02x", pkt.data[i]);
+                printf("\n");
+            }
+            if (work_ns) {
+                uint64_t until = now_ns() + work_ns;
+                while (now_ns() < until) {}
+            }
+            tap_client_done(client);
+        }
+
+        if (ret == 0 || (atomic_load(&counters->packets) & 1023) == 0) {
+            uint64_t now = now_ns();
+            if (now - last >= 1000000000ULL) {
+                uint64_t packets = atomic_load(&counters->packets);
+                printf("%.2f PPS, lag %lu, drops %lu\n", (packets - last_packets) * 1e9 / (now - last),
+                       tap_client_lag(client), atomic_load(&counters->drops));
+                last = now;
+                last_packets = packets;
+            }
+            if (duration && now - start >= (uint64_t)duration * 1000000000ULL) break;
+        }
+    }
+
+    double secs = (now_ns() - start) / 1e9;
+    uint64_t packets = atomic_load(&counters->packets);
+    uint64_t drops = atomic_load(&counters->drops);
+    printf("\nRead %lu packets (%.2f MB) in %.2f s, dropped %lu (%.2f%%), max lag %lu\n",
+           packets, bytes / (1024.0 * 1024.0), secs, drops,
+           packets + drops ? drops * 100.0 / (packets + drops) : 0.0, atomic_load(&counters->max_lag));
+    tap_client_close(client);
+    return 0;
+}